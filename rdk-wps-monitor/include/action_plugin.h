@@ -0,0 +1,129 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file action_plugin.h
+ * @brief In-process action plugins run by the action worker
+ *
+ * An action is written as "<plugin>:<argument>". Built-in plugins:
+ *
+ *   append:<file>         append a line describing the press to a file
+ *   rbus-set:<name>=<v>   set a string parameter over the rbus session
+ *   sysfs:<file>=<v>      write a value to a sysfs attribute
+ *   spawn:<path> <args>   run a program through posix_spawn, no shell;
+ *                         killed if it runs longer than 5 s
+ *
+ * More plugins can be loaded from shared objects exporting an
+ * action_plugin_t named ACTION_PLUGIN_SYMBOL.
+ */
+
+#ifndef ACTION_PLUGIN_H
+#define ACTION_PLUGIN_H
+
+#include "action_queue.h"
+
+/**
+ * @brief Version of action_plugin_t; plugins built for another are refused
+ */
+#define ACTION_PLUGIN_API_VERSION 1
+
+/**
+ * @brief Name of the action_plugin_t exported by a plugin module
+ */
+#define ACTION_PLUGIN_SYMBOL "action_plugin"
+
+/**
+ * @brief Maximum number of registered plugins
+ */
+#define ACTION_PLUGIN_MAX 16
+
+/**
+ * @brief An action plugin
+ */
+typedef struct {
+    unsigned int api_version;   /* ACTION_PLUGIN_API_VERSION */
+    const char *name;
+
+    /**
+     * Parse the argument once when the action is created.
+     * Returns the instance passed to run(), or NULL on failure.
+     */
+    void *(*create)(const char *arg);
+
+    /**
+     * Run the action on the action worker thread.
+     * Returns 0 on success, -1 on failure.
+     */
+    int (*run)(void *instance, const action_request_t *request);
+
+    /**
+     * Release an instance returned by create(); may be NULL.
+     */
+    void (*destroy)(void *instance);
+} action_plugin_t;
+
+/**
+ * @brief Register the built-in plugins
+ *
+ * @return 0 on success, -1 on failure
+ */
+int action_plugin_init(void);
+
+/**
+ * @brief Unregister every plugin and unload plugin modules
+ *
+ * Actions created from plugins must be destroyed first.
+ */
+void action_plugin_cleanup(void);
+
+/**
+ * @brief Register a plugin
+ *
+ * @param plugin Plugin description, which must outlive the registration
+ * @return 0 on success, -1 on failure
+ */
+int action_plugin_register(const action_plugin_t *plugin);
+
+/**
+ * @brief Load a plugin module and register the plugin it exports
+ *
+ * @param path Path to the shared object
+ * @return 0 on success, -1 on failure
+ */
+int action_plugin_load(const char *path);
+
+/**
+ * @brief Create an action from a "<plugin>:<argument>" specification
+ *
+ * @param spec Action specification
+ * @param cooldown_ms Cooldown passed to action_create()
+ * @return The new action, or NULL on failure
+ */
+action_t *action_plugin_create_action(const char *spec, unsigned int cooldown_ms);
+
+/**
+ * @brief Destroy an action created by action_plugin_create_action()
+ *
+ * The action queue must be stopped first.
+ *
+ * @param action Action to destroy
+ */
+void action_plugin_destroy_action(action_t *action);
+
+#endif /* ACTION_PLUGIN_H */
@@ -0,0 +1,180 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file action_queue.h
+ * @brief Bounded queue dispatching button actions to a worker thread
+ */
+
+#ifndef ACTION_QUEUE_H
+#define ACTION_QUEUE_H
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/time.h>
+
+/**
+ * @brief Default number of requests the queue can hold
+ */
+#define ACTION_QUEUE_DEFAULT_CAPACITY 16
+
+/**
+ * @brief Opaque action handle
+ */
+typedef struct action action_t;
+
+/**
+ * @brief A queued request to run an action
+ */
+typedef struct {
+    action_t *action;
+    char device[64];
+    int button_code;
+    struct timeval timestamp;   /* Kernel timestamp of the triggering event */
+    struct timespec queued;     /* CLOCK_MONOTONIC time of submission */
+} action_request_t;
+
+/**
+ * @brief Handler executed on the worker thread for an action
+ *
+ * @param request The request being executed
+ * @param ctx Context pointer given to action_create()
+ * @return 0 on success, -1 on failure
+ */
+typedef int (*action_handler)(const action_request_t *request, void *ctx);
+
+/**
+ * @brief Action queue counters
+ */
+typedef struct {
+    unsigned int capacity;
+    unsigned int depth;
+    unsigned int max_depth;
+    unsigned long submitted;
+    unsigned long executed;
+    unsigned long dropped;      /* Rejected because the queue was full */
+    unsigned long coalesced;    /* Merged into a pending or cooling-down action */
+} action_queue_stats_t;
+
+/**
+ * @brief How long the handler of an action ran
+ */
+typedef struct {
+    unsigned long runs;
+    uint64_t last_ns;
+    uint64_t max_ns;
+    uint64_t total_ns;
+} action_timing_t;
+
+/**
+ * @brief Create an action
+ *
+ * @param name Action name used in logs
+ * @param handler Handler executed on the worker thread
+ * @param ctx Context pointer passed to the handler
+ * @param cooldown_ms Time after a successful run during which new requests are coalesced
+ * @return The new action, or NULL on failure
+ */
+action_t *action_create(const char *name, action_handler handler, void *ctx,
+                        unsigned int cooldown_ms);
+
+/**
+ * @brief Destroy an action
+ *
+ * The action must no longer be queued, i.e. the worker must be stopped.
+ *
+ * @param action Action to destroy
+ */
+void action_destroy(action_t *action);
+
+/**
+ * @brief Get the name of an action
+ *
+ * @param action The action
+ * @return The action name
+ */
+const char *action_get_name(const action_t *action);
+
+/**
+ * @brief Get the context pointer given to action_create()
+ *
+ * @param action The action
+ * @return The context pointer
+ */
+void *action_get_ctx(const action_t *action);
+
+/**
+ * @brief Check whether an action is queued or running
+ *
+ * Once an action can no longer be submitted and this returns 0, the
+ * worker holds no reference to it and it may be destroyed.
+ *
+ * @param action The action
+ * @return 1 if queued or running, 0 otherwise
+ */
+int action_is_pending(const action_t *action);
+
+/**
+ * @brief Get the run time counters of an action
+ *
+ * @param action The action
+ * @param timing Structure receiving the counters
+ */
+void action_get_timing(const action_t *action, action_timing_t *timing);
+
+/**
+ * @brief Initialize the action queue
+ *
+ * @param capacity Maximum number of pending requests
+ * @return 0 on success, -1 on failure
+ */
+int action_queue_init(unsigned int capacity);
+
+/**
+ * @brief Start the worker thread draining the queue
+ *
+ * @return 0 on success, -1 on failure
+ */
+int action_queue_start(void);
+
+/**
+ * @brief Stop the worker thread and discard pending requests
+ */
+void action_queue_stop(void);
+
+/**
+ * @brief Submit an action request without blocking
+ *
+ * @param action Action to run
+ * @param device Path to the input device that triggered the action
+ * @param button_code Button code that triggered the action
+ * @param timestamp Kernel timestamp of the triggering event
+ * @return 0 if queued or coalesced, -1 if dropped
+ */
+int action_queue_submit(action_t *action, const char *device, int button_code,
+                        const struct timeval *timestamp);
+
+/**
+ * @brief Get a snapshot of the queue counters
+ *
+ * @param stats Structure receiving the counters
+ */
+void action_queue_get_stats(action_queue_stats_t *stats);
+
+#endif /* ACTION_QUEUE_H */
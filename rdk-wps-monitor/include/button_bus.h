@@ -0,0 +1,176 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file button_bus.h
+ * @brief Publish/subscribe bus for key events
+ *
+ * Every key event that reaches the button callback, and every gesture
+ * recognised from them, is also published to each subscriber's own
+ * single-producer single-consumer ring. Subscribers
+ * are served either by a thread of their own or from a slot on the event
+ * loop, so a slow subscriber only fills its own ring; when it is full,
+ * further events for that subscriber are dropped and counted.
+ *
+ * Publishing, subscribing and unsubscribing happen on the event loop
+ * thread, which is the only producer.
+ */
+
+#ifndef BUTTON_BUS_H
+#define BUTTON_BUS_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+/**
+ * @brief Maximum number of subscribers
+ */
+#define BUTTON_BUS_MAX_SUBSCRIBERS 8
+
+/**
+ * @brief Default ring size of a subscriber (power of two)
+ */
+#define BUTTON_BUS_DEFAULT_CAPACITY 256
+
+/**
+ * @brief Kind of a published event
+ */
+typedef enum {
+    BUTTON_EVENT_KEY,           /* value: 1 for press, 0 for release, 2 for repeat */
+    BUTTON_EVENT_GESTURE        /* value: gesture_t */
+} button_event_type_t;
+
+/**
+ * @brief A published event
+ */
+typedef struct {
+    button_event_type_t type;
+    char device[64];
+    int code;
+    int value;
+    struct timeval timestamp;   /* Kernel timestamp */
+    uint64_t published_ns;      /* CLOCK_MONOTONIC time of publication */
+} button_event_t;
+
+/**
+ * @brief Where a subscriber's handler runs
+ */
+typedef enum {
+    BUTTON_BUS_THREAD,          /* A delivery thread of its own */
+    BUTTON_BUS_LOOP             /* The event loop thread, after the current event */
+} button_bus_delivery_t;
+
+typedef struct button_bus_subscriber button_bus_subscriber_t;
+
+/**
+ * @brief Handler called once per event, in publication order
+ *
+ * @param event The event
+ * @param ctx Context pointer given to button_bus_subscribe()
+ */
+typedef void (*button_bus_handler)(const button_event_t *event, void *ctx);
+
+/**
+ * @brief Counters of one subscriber
+ */
+typedef struct {
+    const char *name;
+    button_bus_delivery_t delivery;
+    unsigned int capacity;
+    unsigned int depth;         /* Events published but not yet delivered */
+    unsigned int max_depth;
+    unsigned long delivered;
+    unsigned long dropped;      /* Ring full */
+    uint64_t last_lag_ns;       /* Publication to handler start */
+    uint64_t max_lag_ns;
+} button_bus_stats_t;
+
+/**
+ * @brief Add a subscriber
+ *
+ * BUTTON_BUS_LOOP subscribers need event_loop_init() first.
+ *
+ * @param name Name shown in statistics
+ * @param delivery Where the handler runs
+ * @param capacity Ring size, rounded up to a power of two, 0 for the default
+ * @param handler Handler for each event
+ * @param ctx Context pointer passed to the handler
+ * @return The subscriber, or NULL on failure
+ */
+button_bus_subscriber_t *button_bus_subscribe(const char *name, button_bus_delivery_t delivery,
+                                              unsigned int capacity, button_bus_handler handler,
+                                              void *ctx);
+
+/**
+ * @brief Remove a subscriber
+ *
+ * Events still queued for a thread subscriber are delivered first. Must
+ * not be called from the subscriber's own handler.
+ *
+ * @param sub Subscriber
+ */
+void button_bus_unsubscribe(button_bus_subscriber_t *sub);
+
+/**
+ * @brief Stop or resume delivery to a BUTTON_BUS_LOOP subscriber
+ *
+ * While paused, events queue up in the ring and are dropped once it is
+ * full. May be called from the subscriber's handler.
+ *
+ * @param sub Subscriber
+ * @param paused Non-zero to pause
+ */
+void button_bus_pause(button_bus_subscriber_t *sub, int paused);
+
+/**
+ * @brief Publish a key event to every subscriber
+ *
+ * @param device Device the event came from
+ * @param code Key code
+ * @param value 1 for press, 0 for release, 2 for repeat
+ * @param timestamp Kernel timestamp
+ */
+void button_bus_publish(const char *device, int code, int value, const struct timeval *timestamp);
+
+/**
+ * @brief Publish a recognised gesture to every subscriber
+ *
+ * @param device Device the button belongs to
+ * @param code Key code
+ * @param gesture gesture_t that was recognised
+ * @param timestamp Timestamp of the press that started the gesture
+ */
+void button_bus_publish_gesture(const char *device, int code, int gesture,
+                                const struct timeval *timestamp);
+
+/**
+ * @brief Visitor for button_bus_foreach()
+ */
+typedef void (*button_bus_visitor)(const button_bus_stats_t *stats, void *ctx);
+
+/**
+ * @brief Call a visitor with the counters of every subscriber
+ *
+ * @param visitor Function called once per subscriber
+ * @param ctx Context pointer passed to the visitor
+ * @return Number of subscribers
+ */
+int button_bus_foreach(button_bus_visitor visitor, void *ctx);
+
+#endif /* BUTTON_BUS_H */
@@ -25,10 +25,42 @@
 #ifndef BUTTON_CALLBACK_H
 #define BUTTON_CALLBACK_H
 
+#include <sys/time.h>
+
+/**
+ * @brief Maximum number of actions run by the custom WPS callback
+ */
+#define BUTTON_CALLBACK_MAX_CUSTOM_ACTIONS 8
+
 /**
  * @brief Callback function type definition for button events
+ *
+ * The timestamp is the kernel time of the input frame the event belongs to.
+ */
+typedef void (*button_callback)(const char *device, int button_code, int value,
+                                const struct timeval *timestamp);
+
+/**
+ * @brief Create the actions dispatched by the button callbacks
+ * 
+ * @return 0 on success, -1 on failure
+ */
+int button_callback_init(void);
+
+/**
+ * @brief Add an action run by the custom WPS callback on every press
+ *
+ * @param spec Action specification, see action_plugin.h
+ * @return 0 on success, -1 on failure
+ */
+int button_callback_add_custom_action(const char *spec);
+
+/**
+ * @brief Destroy the actions created by button_callback_init()
+ * 
+ * The action queue must be stopped first.
  */
-typedef void (*button_callback)(const char *device, int button_code, int value);
+void button_callback_cleanup(void);
 
 /**
  * @brief Default button callback implementation
@@ -36,8 +68,10 @@ typedef void (*button_callback)(const char *device, int button_code, int value);
  * @param device Path to the input device
  * @param button_code Button code that triggered the event
  * @param value Button value (1=pressed, 0=released, 2=repeated)
+ * @param timestamp Kernel timestamp of the event
  */
-void default_button_callback(const char *device, int button_code, int value);
+void default_button_callback(const char *device, int button_code, int value,
+                             const struct timeval *timestamp);
 
 /**
  * @brief Custom WPS button callback implementation
@@ -45,8 +79,10 @@ void default_button_callback(const char *device, int button_code, int value);
  * @param device Path to the input device
  * @param button_code Button code that triggered the event
  * @param value Button value (1=pressed, 0=released, 2=repeated)
+ * @param timestamp Kernel timestamp of the event
  */
-void custom_wps_button_callback(const char *device, int button_code, int value);
+void custom_wps_button_callback(const char *device, int button_code, int value,
+                                const struct timeval *timestamp);
 
 /**
  * @brief Register a callback function for button events
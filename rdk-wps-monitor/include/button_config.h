@@ -0,0 +1,134 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file button_config.h
+ * @brief Button to action table loaded from a config file and hot reloaded
+ *
+ * Each non-empty line that does not start with '#' binds a gesture to an
+ * action:
+ *
+ *   <key> <gesture> [device=<pattern>] [cooldown=<ms>] <action>
+ *
+ * key      KEY_WPS_BUTTON, BTN_0, ..., a number, or * for every key
+ *          without rules of its own
+ * gesture  short, long or double
+ * device   fnmatch() pattern on the device path, default any device
+ * cooldown see action_create(), default 0
+ * action   action specification, see action_plugin.h (rest of the line)
+ *
+ * The file is compiled into a table indexed by key code and published
+ * with a single pointer store; editing it swaps the table in without a
+ * restart. A file that fails to parse leaves the current table in place.
+ */
+
+#ifndef BUTTON_CONFIG_H
+#define BUTTON_CONFIG_H
+
+#include <stdio.h>
+#include <sys/time.h>
+#include "gesture.h"
+
+/**
+ * @brief Default config file
+ */
+#define BUTTON_CONFIG_FILE "/etc/netlink-button-monitor.conf"
+
+/**
+ * @brief Load the table and watch the config file for changes
+ *
+ * A missing file selects the built-in table (short press triggers WPS,
+ * double tap toggles the WPS LED, long press of KEY_RESTART factory
+ * reset). Must be
+ * called after event_loop_init() and after all action plugins are
+ * registered.
+ *
+ * @param path Config file, or NULL for BUTTON_CONFIG_FILE
+ * @return 0 on success, -1 if the file exists but is invalid
+ */
+int button_config_init(const char *path);
+
+/**
+ * @brief Stop watching the config file and free every table
+ *
+ * The action queue must be stopped first.
+ */
+void button_config_cleanup(void);
+
+/**
+ * @brief Reload the config file now
+ *
+ * If the file is invalid, or has been removed since start-up, the
+ * current table stays.
+ *
+ * @return 0 if a new table was published, -1 otherwise
+ */
+int button_config_reload(void);
+
+/**
+ * @brief Get the gestures bound to a button
+ *
+ * Must be called on the event loop thread.
+ *
+ * @param device Device the button belongs to
+ * @param button_code Button code
+ * @return Mask of GESTURE_BIT()s
+ */
+unsigned int button_config_gestures(const char *device, int button_code);
+
+/**
+ * @brief Submit the actions bound to a gesture
+ *
+ * Must be called on the event loop thread.
+ *
+ * @param device Device the button belongs to
+ * @param button_code Button code
+ * @param gesture Recognised gesture
+ * @param timestamp Timestamp of the press that started the gesture
+ */
+void button_config_dispatch(const char *device, int button_code, gesture_t gesture,
+                            const struct timeval *timestamp);
+
+/**
+ * @brief Write the published table in config file syntax
+ *
+ * Must be called on the event loop thread.
+ *
+ * @param f Stream to write to
+ */
+void button_config_dump(FILE *f);
+
+/**
+ * @brief Get the generation of the published table
+ *
+ * Starts at 1 and grows by one for every table published.
+ *
+ * @return Table generation, 0 before button_config_init()
+ */
+unsigned int button_config_generation(void);
+
+/**
+ * @brief Look up a key as it is written in the config file
+ *
+ * @param name Key name such as KEY_WPS_BUTTON, or a key code
+ * @return Key code, or -1 if the name is unknown or "*"
+ */
+int button_config_key_code(const char *name);
+
+#endif /* BUTTON_CONFIG_H */
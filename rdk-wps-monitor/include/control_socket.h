@@ -0,0 +1,63 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file control_socket.h
+ * @brief UNIX domain control socket served by the event loop
+ *
+ * Clients send one command per line and get the output followed by a
+ * line "OK" or "ERROR <reason>". Send "help" for the command list.
+ * Sockets never block: a client that does not read its output stops
+ * being read until the output has drained.
+ */
+
+#ifndef CONTROL_SOCKET_H
+#define CONTROL_SOCKET_H
+
+/**
+ * @brief Default control socket path
+ */
+#define CONTROL_SOCKET_PATH "/var/run/netlink-button-monitor.sock"
+
+/**
+ * @brief Maximum number of connected clients
+ */
+#define CONTROL_MAX_CLIENTS 4
+
+/**
+ * @brief Maximum length of a command line
+ */
+#define CONTROL_LINE_MAX 256
+
+/**
+ * @brief Create the socket and register it with the event loop
+ *
+ * The socket is only accessible to the daemon's user.
+ *
+ * @param path Socket path, or NULL for CONTROL_SOCKET_PATH
+ * @return 0 on success, -1 on failure
+ */
+int control_socket_init(const char *path);
+
+/**
+ * @brief Disconnect all clients and remove the socket
+ */
+void control_socket_cleanup(void);
+
+#endif /* CONTROL_SOCKET_H */
@@ -25,20 +25,68 @@
 #ifndef DEVICE_MONITOR_H
 #define DEVICE_MONITOR_H
 
-#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <linux/input.h>
 
 /**
- * @brief Maximum number of input devices to monitor
+ * @brief Directory holding the evdev device nodes
  */
-#define MAX_INPUT_DEVICES 32
+#define INPUT_DEVICE_DIR "/dev/input"
 
 /**
- * @brief Thread data structure for device monitors
+ * @brief Initial number of buckets in the device registry (power of two)
  */
-typedef struct {
+#define DEVICE_REGISTRY_INITIAL_BUCKETS 16
+
+/**
+ * @brief Maximum number of key codes that select devices for monitoring
+ */
+#define MAX_WATCHED_KEYS 16
+
+/**
+ * @brief Number of input events fetched per read() call
+ */
+#define INPUT_READ_BATCH 64
+
+/**
+ * @brief Maximum number of key events buffered in one SYN_REPORT frame
+ */
+#define INPUT_FRAME_MAX 64
+
+/**
+ * @brief Number of longs needed to hold one bit per key code
+ */
+#define KEY_STATE_LONGS ((KEY_CNT + 8 * sizeof(unsigned long) - 1) / (8 * sizeof(unsigned long)))
+
+/**
+ * @brief Per-device state for monitored input devices
+ * 
+ * Devices are registered by dev_t and by path. A device that is removed
+ * and added again gets a new record with a higher generation.
+ */
+typedef struct input_device {
+    dev_t devt;
+    unsigned long generation;
     char *device_path;
-    int thread_active;
-} device_thread_data_t;
+    int fd;
+    int dropping;                                 /* Discarding until SYN_REPORT after SYN_DROPPED */
+    int via_ring;                                 /* Read through uring_reader, not the event loop */
+    unsigned long key_events;                     /* Delivered to callbacks; event loop thread only */
+    int frame_len;
+    struct input_event frame[INPUT_FRAME_MAX];    /* Key events of the frame being assembled */
+    unsigned long key_state[KEY_STATE_LONGS];     /* Last key state delivered to callbacks */
+    struct input_device *next_devt;               /* Registry chains */
+    struct input_device *next_path;
+} input_device_t;
+
+/**
+ * @brief Visitor for device_monitor_foreach()
+ * 
+ * @param dev The monitored device; only valid during the call
+ * @param ctx Caller context
+ */
+typedef void (*device_visitor)(const input_device_t *dev, void *ctx);
 
 /**
  * @brief Initialize device monitoring subsystem
@@ -47,6 +95,36 @@ typedef struct {
  */
 int device_monitor_init(void);
 
+/**
+ * @brief Set the directory holding the evdev nodes
+ * 
+ * Besides evdev character devices, the directory may hold FIFOs named
+ * eventN that carry struct input_event records, e.g. for replay.
+ * 
+ * @param dir Directory, or NULL for INPUT_DEVICE_DIR; must stay valid
+ */
+void device_monitor_set_input_dir(const char *dir);
+
+/**
+ * @brief Get the directory holding the evdev nodes
+ * 
+ * @return The directory
+ */
+const char *device_monitor_get_input_dir(void);
+
+/**
+ * @brief Set the key codes a device must be able to emit to be monitored
+ * 
+ * Defaults to KEY_WPS_BUTTON, BTN_0 and KEY_RESTART. Capabilities are
+ * pre-screened through sysfs before a node is opened and confirmed with
+ * EVIOCGBIT; nodes whose capabilities cannot be read are monitored.
+ * 
+ * @param codes Key codes, or NULL to monitor every input device
+ * @param count Number of key codes
+ * @return 0 on success, -1 if count exceeds MAX_WATCHED_KEYS
+ */
+int device_monitor_set_watched_keys(const int *codes, int count);
+
 /**
  * @brief Clean up device monitoring subsystem
  */
@@ -55,8 +133,10 @@ void device_monitor_cleanup(void);
 /**
  * @brief Add a new input device to monitor
  * 
+ * Events are timestamped with CLOCK_MONOTONIC (EVIOCSCLOCKID).
+ * 
  * @param device_path Path to the input device
- * @return 0 on success, -1 on failure
+ * @return 1 if monitoring started, 0 if already monitored or skipped, -1 on failure
  */
 int add_input_device(const char *device_path);
 
@@ -67,18 +147,66 @@ int add_input_device(const char *device_path);
  */
 void remove_input_device(const char *device_path);
 
+/**
+ * @brief Remove a device from monitoring by device number
+ * 
+ * @param devt Device number of the evdev node
+ */
+void remove_input_device_devt(dev_t devt);
+
+/**
+ * @brief Check whether a device is monitored
+ * 
+ * Takes the registry lock, like every other registry access.
+ * 
+ * @param devt Device number of the evdev node
+ * @return 1 if monitored, 0 if not
+ */
+int device_monitor_contains(dev_t devt);
+
+/**
+ * @brief Call a visitor for every monitored device
+ * 
+ * Registry updates wait until the walk completes.
+ * 
+ * @param visitor Function called for each device
+ * @param ctx Passed to the visitor
+ * @return Number of devices visited
+ */
+int device_monitor_foreach(device_visitor visitor, void *ctx);
+
 /**
  * @brief Scan and add existing input devices
  */
 void scan_existing_devices(void);
 
 /**
- * @brief Thread function to monitor a specific input device
+ * @brief Bring the registry in line with the input directory
+ *
+ * Drops devices whose node is gone or now belongs to another device, then
+ * scans for devices that are not monitored yet. Used after hotplug events
+ * were lost.
+ */
+void device_monitor_resync(void);
+
+/**
+ * @brief Event loop handler for a monitored input device
+ * 
+ * @param fd Input device file descriptor
+ * @param events epoll events reported for the descriptor
+ * @param ctx Handler context (input_device_t *)
+ */
+void device_monitor_handle_event(int fd, uint32_t events, void *ctx);
+
+/**
+ * @brief uring_reader handler for a monitored input device
  * 
- * @param arg Thread argument (device_thread_data_t *)
- * @return NULL
+ * @param fd Input device file descriptor
+ * @param data Events read
+ * @param len Bytes read, 0 at end of file or a negative errno value
+ * @param ctx Handler context (input_device_t *)
  */
-void *device_monitor_thread(void *arg);
+void device_monitor_handle_read(int fd, const void *data, ssize_t len, void *ctx);
 
 /**
  * @brief Print a summary of monitored devices
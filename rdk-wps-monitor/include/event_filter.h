@@ -0,0 +1,133 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file event_filter.h
+ * @brief Debounce and cross-device dedupe between evdev reads and the button callback
+ *
+ * Debounce works per (device, key) on kernel timestamps: the first edge is
+ * passed on at once and further edges within the window are dropped. If
+ * the key ends the window in another state than the one passed on, that
+ * state is passed on when the window closes, so a dropped release never
+ * leaves a button held.
+ *
+ * Dedupe drops a press of a key that another device pressed within the
+ * dedupe window, and everything that device sends for the key until it
+ * is released; boards that expose one button through several event nodes
+ * then deliver it once.
+ *
+ * Everything runs on the event loop thread.
+ */
+
+#ifndef EVENT_FILTER_H
+#define EVENT_FILTER_H
+
+#include <sys/types.h>
+#include <sys/time.h>
+
+/**
+ * @brief Default debounce window
+ */
+#define EVENT_FILTER_DEBOUNCE_MS 20
+
+/**
+ * @brief Default window in which presses on other devices are duplicates
+ */
+#define EVENT_FILTER_DEDUPE_MS 50
+
+/**
+ * @brief Maximum number of (device, key) pairs tracked at once
+ */
+#define EVENT_FILTER_MAX_KEYS 64
+
+/**
+ * @brief Filter windows, 0 disables a rule
+ */
+typedef struct {
+    unsigned int debounce_ms;
+    unsigned int dedupe_ms;
+} event_filter_config_t;
+
+/**
+ * @brief Filter counters
+ */
+typedef struct {
+    unsigned long passed;
+    unsigned long debounced;    /* Edges dropped as chatter */
+    unsigned long settled;      /* States passed on when a debounce window closed */
+    unsigned long deduplicated; /* Events dropped as another device's duplicate */
+    unsigned long untracked;    /* Passed unfiltered because every slot was busy */
+} event_filter_stats_t;
+
+/**
+ * @brief Set up the settle timer
+ *
+ * Must be called after event_loop_init(). Without the timer debounce is
+ * turned off.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int event_filter_init(void);
+
+/**
+ * @brief Release the settle timer and all key state
+ */
+void event_filter_cleanup(void);
+
+/**
+ * @brief Change the filter windows
+ *
+ * @param config New windows
+ */
+void event_filter_set_config(const event_filter_config_t *config);
+
+/**
+ * @brief Get the filter windows
+ *
+ * @param config Receives the windows
+ */
+void event_filter_get_config(event_filter_config_t *config);
+
+/**
+ * @brief Filter a key event and pass it to the button callback
+ *
+ * @param devt Device number the event came from
+ * @param device Device path given to the callback
+ * @param code Key code
+ * @param value 1 for press, 0 for release, 2 for repeat
+ * @param timestamp Kernel timestamp (CLOCK_MONOTONIC)
+ */
+void event_filter_event(dev_t devt, const char *device, int code, int value,
+                        const struct timeval *timestamp);
+
+/**
+ * @brief Forget the key state of a device that went away
+ *
+ * @param devt Device number
+ */
+void event_filter_forget(dev_t devt);
+
+/**
+ * @brief Get a snapshot of the filter counters
+ *
+ * @param stats Receives the counters
+ */
+void event_filter_get_stats(event_filter_stats_t *stats);
+
+#endif /* EVENT_FILTER_H */
@@ -0,0 +1,104 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file event_loop.h
+ * @brief Single-threaded epoll event loop for the netlink button monitor
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+
+/**
+ * @brief Handler invoked when a registered file descriptor becomes ready
+ *
+ * @param fd The ready file descriptor
+ * @param events The epoll events reported for the descriptor
+ * @param ctx Context pointer given at registration
+ */
+typedef void (*event_handler)(int fd, uint32_t events, void *ctx);
+
+/**
+ * @brief Initialize the event loop (epoll instance and shutdown eventfd)
+ *
+ * @return 0 on success, -1 on failure
+ */
+int event_loop_init(void);
+
+/**
+ * @brief Release all event loop resources
+ */
+void event_loop_cleanup(void);
+
+/**
+ * @brief Register a file descriptor with the event loop
+ *
+ * @param fd File descriptor to watch
+ * @param events epoll event mask (EPOLLIN, ...)
+ * @param handler Handler called when the descriptor is ready
+ * @param ctx Context pointer passed to the handler
+ * @return 0 on success, -1 on failure
+ */
+int event_loop_add(int fd, uint32_t events, event_handler handler, void *ctx);
+
+/**
+ * @brief Change the epoll events watched for a registered descriptor
+ *
+ * @param fd Registered file descriptor
+ * @param events New epoll event mask
+ * @return 0 on success, -1 on failure
+ */
+int event_loop_modify(int fd, uint32_t events);
+
+/**
+ * @brief Unregister a file descriptor from the event loop
+ *
+ * Safe to call from within any handler, including for descriptors that
+ * still have pending events in the current batch.
+ *
+ * @param fd File descriptor to remove
+ */
+void event_loop_remove(int fd);
+
+/**
+ * @brief Run the event loop until event_loop_stop() is called
+ *
+ * @return 0 on clean shutdown, -1 on failure
+ */
+int event_loop_run(void);
+
+/**
+ * @brief Request the event loop to stop
+ *
+ * Async-signal-safe; wakes the loop immediately through its eventfd.
+ */
+void event_loop_stop(void);
+
+/**
+ * @brief Get the number of times the loop returned from epoll_wait()
+ *
+ * May be called from any thread.
+ *
+ * @return Number of wakeups since initialization
+ */
+unsigned long event_loop_get_wakeups(void);
+
+#endif /* EVENT_LOOP_H */
@@ -0,0 +1,118 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file gesture.h
+ * @brief Button gesture recognition driven by timerfd deadlines
+ *
+ * Every button has a small state machine fed with press and release
+ * events. Deadlines (long press, end of a tap sequence) are timerfds on
+ * the event loop, so recognition never blocks or sleeps.
+ */
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <sys/time.h>
+
+/**
+ * @brief Hold time that makes a press a long press
+ *
+ * Overridable at build time so the gesture checks need not hold for 10 s.
+ */
+#ifndef GESTURE_LONG_PRESS_MS
+#define GESTURE_LONG_PRESS_MS 10000
+#endif
+
+/**
+ * @brief Maximum gap between the taps of a double tap
+ */
+#define GESTURE_MULTI_TAP_MS 400
+
+/**
+ * @brief Maximum number of buttons tracked at once
+ */
+#define GESTURE_MAX_BUTTONS 16
+
+/**
+ * @brief Recognised gestures
+ */
+typedef enum {
+    GESTURE_SHORT_PRESS,
+    GESTURE_LONG_PRESS,
+    GESTURE_DOUBLE_TAP,
+    GESTURE_COUNT
+} gesture_t;
+
+/**
+ * @brief Bit for a gesture in the mask given to gesture_init()
+ */
+#define GESTURE_BIT(gesture) (1u << (gesture))
+
+/**
+ * @brief Called on the event loop thread when a gesture is recognised
+ *
+ * @param device Device the button belongs to
+ * @param button_code Button code
+ * @param gesture The gesture
+ * @param timestamp Timestamp of the press that started the gesture
+ */
+typedef void (*gesture_handler)(const char *device, int button_code, gesture_t gesture,
+                                const struct timeval *timestamp);
+
+/**
+ * @brief Initialize the gesture engine
+ *
+ * Must be called after event_loop_init().
+ *
+ * @param handler Function called for recognised gestures
+ * @return 0 on success, -1 on failure
+ */
+int gesture_init(gesture_handler handler);
+
+/**
+ * @brief Release all button state and timers
+ */
+void gesture_cleanup(void);
+
+/**
+ * @brief Feed a key event into the state machine of its button
+ *
+ * The mask taken at the first press of a sequence holds for the whole
+ * sequence. When GESTURE_DOUBLE_TAP is not in it, a short press is
+ * reported on release without waiting for a second tap.
+ *
+ * @param device Device the event came from
+ * @param button_code Button code
+ * @param value 1 for press, 0 for release; repeats are ignored
+ * @param timestamp Event timestamp
+ * @param gestures Mask of GESTURE_BIT()s bound to this button
+ */
+void gesture_handle_event(const char *device, int button_code, int value,
+                          const struct timeval *timestamp, unsigned int gestures);
+
+/**
+ * @brief Get the printable name of a gesture
+ *
+ * @param gesture The gesture
+ * @return Gesture name
+ */
+const char *gesture_name(gesture_t gesture);
+
+#endif /* GESTURE_H */
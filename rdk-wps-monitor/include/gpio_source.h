@@ -0,0 +1,133 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file gpio_source.h
+ * @brief Buttons wired to GPIO lines, read through the GPIO character device
+ *
+ * Each configured line is looked up by name on /dev/gpiochip* and
+ * requested for both edges with the v2 line uAPI. The kernel debounces
+ * the line and timestamps every edge, with the hardware timestamp engine
+ * where the chip has one; the request fd is read on the event loop like
+ * an evdev node and its edges go through the same filter, journal and
+ * button callback as key events. Hardware timestamps count on the
+ * engine's clock, so they are not used for latency figures.
+ *
+ * A line given as an absolute path is a FIFO carrying struct
+ * gpio_v2_line_event records instead, for testing without a GPIO chip.
+ *
+ * Everything runs on the event loop thread.
+ */
+
+#ifndef GPIO_SOURCE_H
+#define GPIO_SOURCE_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Directory searched for GPIO chips
+ */
+#define GPIO_SOURCE_DEV_DIR "/dev"
+
+/**
+ * @brief Maximum number of configured lines
+ */
+#define GPIO_SOURCE_MAX_LINES 8
+
+/**
+ * @brief Default kernel debounce period
+ */
+#define GPIO_SOURCE_DEBOUNCE_MS 10
+
+/**
+ * @brief Line events drained per read()
+ */
+#define GPIO_SOURCE_READ_BATCH 16
+
+/**
+ * @brief Low minor bits of a line's dev_t holding its offset on the chip
+ *
+ * A line is keyed as the chip's major and (chip minor << 12) | offset, so
+ * the journal's 20-bit minor still separates the lines of 256 chips.
+ */
+#define GPIO_SOURCE_OFFSET_BITS 12
+
+/**
+ * @brief Consumer label shown for requested lines
+ */
+#define GPIO_SOURCE_CONSUMER "netlink-button-monitor"
+
+/**
+ * @brief Configured line as seen by a visitor
+ */
+typedef struct {
+    const char *device;         /* "<chip>:<line>" or FIFO path, as given to the callback */
+    dev_t devt;                 /* Per line, see GPIO_SOURCE_OFFSET_BITS */
+    int code;
+    int requested;              /* 0 if the line could not be requested */
+    int hte;                    /* Edges timestamped by the hardware timestamp engine */
+    unsigned long key_events;
+    unsigned long lost;         /* Edges the kernel dropped before they were read */
+} gpio_line_info_t;
+
+/**
+ * @brief Visitor for gpio_source_foreach()
+ *
+ * @param line The line; only valid during the call
+ * @param ctx Caller context
+ */
+typedef void (*gpio_line_visitor)(const gpio_line_info_t *line, void *ctx);
+
+/**
+ * @brief Configure a line from a command line spec
+ *
+ * The spec is "<line>:<key>[:<debounce ms>][:active-high]". Lines are
+ * active low unless active-high is given. Must be called before
+ * gpio_source_init().
+ *
+ * @param spec Line spec
+ * @return 0 on success, -1 if the spec is invalid or too many lines are configured
+ */
+int gpio_source_add(const char *spec);
+
+/**
+ * @brief Request the configured lines and read them on the event loop
+ *
+ * Must be called after event_loop_init() and device_monitor_init(). Lines
+ * that cannot be found or requested are logged and left out.
+ *
+ * @return 0 if every line was requested, -1 otherwise
+ */
+int gpio_source_init(void);
+
+/**
+ * @brief Release all lines
+ */
+void gpio_source_cleanup(void);
+
+/**
+ * @brief Visit every configured line
+ *
+ * @param visitor Called once per line
+ * @param ctx Passed to the visitor
+ * @return Number of lines visited
+ */
+int gpio_source_foreach(gpio_line_visitor visitor, void *ctx);
+
+#endif /* GPIO_SOURCE_H */
@@ -0,0 +1,148 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file hotplug_monitor.h
+ * @brief Selection of the input device hotplug backend
+ */
+
+#ifndef HOTPLUG_MONITOR_H
+#define HOTPLUG_MONITOR_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * @brief Window in which hotplug events are collected before the registry
+ *        is updated
+ */
+#define HOTPLUG_DEBOUNCE_MS 20
+
+/**
+ * @brief Devices with pending events per window; more trigger a rescan
+ */
+#define HOTPLUG_PENDING_MAX 64
+
+/**
+ * @brief Available hotplug backends
+ */
+typedef enum {
+    HOTPLUG_BACKEND_NETLINK,    /* Filtered NETLINK_KOBJECT_UEVENT socket */
+    HOTPLUG_BACKEND_INOTIFY,    /* inotify watch on /dev/input */
+    HOTPLUG_BACKEND_STREAM      /* uevents replayed from a FIFO or file */
+} hotplug_backend_t;
+
+/**
+ * @brief Device change reported by a backend
+ */
+typedef enum {
+    HOTPLUG_ADD,
+    HOTPLUG_REMOVE
+} hotplug_action_t;
+
+/**
+ * @brief Hotplug event counters
+ */
+typedef struct {
+    unsigned long accepted;     /* Events that reached the device registry */
+    unsigned long dropped;      /* Events filtered out in kernel or user space */
+    unsigned long coalesced;    /* Events merged into another of the same window */
+    unsigned long overflows;    /* Times events were lost by the kernel or the window */
+    unsigned long resyncs;      /* Rescans of the input directory after a loss */
+} hotplug_stats_t;
+
+/**
+ * @brief Create the hotplug event source for the given backend
+ *
+ * Events arriving between init and start are queued, so existing devices
+ * can be scanned in between without missing a hotplug.
+ *
+ * @param backend Backend to use
+ * @return 0 on success, -1 on failure
+ */
+int hotplug_monitor_init(hotplug_backend_t backend);
+
+/**
+ * @brief Set the FIFO or file read by the stream backend
+ *
+ * @param path Stream to read (see uevent_stream.h for the format)
+ */
+void hotplug_monitor_set_stream(const char *path);
+
+/**
+ * @brief Register the hotplug event source with the event loop
+ *
+ * @return 0 on success, -1 on failure
+ */
+int hotplug_monitor_start(void);
+
+/**
+ * @brief Close the hotplug event source
+ */
+void hotplug_monitor_stop(void);
+
+/**
+ * @brief Queue a device change for the next registry update
+ *
+ * Called by the backends on the event loop thread. Changes are applied
+ * HOTPLUG_DEBOUNCE_MS after the first one, at most one add and one remove
+ * per device, so a burst costs a single pass over the registry.
+ *
+ * @param action Device change
+ * @param path Path of the device node
+ * @param devt Device number if the event carries one, 0 otherwise
+ * @param received_ns CLOCK_MONOTONIC time the event was received
+ */
+void hotplug_monitor_queue(hotplug_action_t action, const char *path, dev_t devt,
+                           uint64_t received_ns);
+
+/**
+ * @brief Report lost hotplug events
+ *
+ * Pending changes are replaced by a full rescan at the end of the window.
+ *
+ * @param reason Logged cause of the loss
+ */
+void hotplug_monitor_request_resync(const char *reason);
+
+/**
+ * @brief Get the counters of the active backend
+ *
+ * @param stats Structure receiving the counters
+ */
+void hotplug_monitor_get_stats(hotplug_stats_t *stats);
+
+/**
+ * @brief Get the name of a backend
+ *
+ * @param backend The backend
+ * @return Backend name
+ */
+const char *hotplug_backend_name(hotplug_backend_t backend);
+
+/**
+ * @brief Parse a backend name
+ *
+ * @param name Backend name ("netlink", "inotify" or "stream")
+ * @param backend Receives the parsed backend
+ * @return 0 on success, -1 if the name is unknown
+ */
+int hotplug_backend_from_name(const char *name, hotplug_backend_t *backend);
+
+#endif /* HOTPLUG_MONITOR_H */
@@ -0,0 +1,68 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file inotify_monitor.h
+ * @brief inotify based hotplug monitoring of /dev/input
+ *
+ * Used where no uevent socket is available, e.g. in containers.
+ */
+
+#ifndef INOTIFY_MONITOR_H
+#define INOTIFY_MONITOR_H
+
+#include <stdint.h>
+#include "hotplug_monitor.h"
+
+/**
+ * @brief Create the inotify instance and watch /dev/input
+ *
+ * @return 0 on success, -1 on failure
+ */
+int init_inotify_monitor(void);
+
+/**
+ * @brief Register the inotify descriptor with the event loop
+ *
+ * @return 0 on success, -1 on failure
+ */
+int start_inotify_monitor(void);
+
+/**
+ * @brief Close the inotify descriptor
+ */
+void close_inotify_monitor(void);
+
+/**
+ * @brief Event loop handler for the inotify descriptor
+ *
+ * @param fd inotify descriptor
+ * @param events epoll events reported for the descriptor
+ * @param ctx Handler context (unused)
+ */
+void inotify_monitor_handle_event(int fd, uint32_t events, void *ctx);
+
+/**
+ * @brief Get the inotify backend counters
+ *
+ * @param stats Structure receiving the counters
+ */
+void inotify_monitor_get_stats(hotplug_stats_t *stats);
+
+#endif /* INOTIFY_MONITOR_H */
@@ -0,0 +1,165 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file journal.h
+ * @brief Binary event journal in a memory-mapped file
+ *
+ * A fixed-size ring of 32-byte records (key events, gestures, action
+ * submissions and results, hotplug) kept in a file on tmpfs. Writers claim
+ * a slot with one atomic add and fill it with plain stores; the record's
+ * sequence number is stored last so readers can tell complete records from
+ * ones being written or overwritten. The file survives a daemon crash and
+ * a restart appends to it. Decode it with bin/wps-journal.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * @brief Default journal file
+ */
+#define JOURNAL_FILE "/tmp/netlink-button-monitor.journal"
+
+#define JOURNAL_MAGIC "WPSJRNL1"
+#define JOURNAL_VERSION 1
+
+/**
+ * @brief Records in the ring (power of two)
+ */
+#define JOURNAL_RECORDS 4096
+
+/**
+ * @brief Size of the header, records start after it
+ */
+#define JOURNAL_HEADER_SIZE 4096
+
+/**
+ * @brief Action names the header can hold
+ */
+#define JOURNAL_ACTIONS 64
+#define JOURNAL_ACTION_NAME_MAX 48
+
+/**
+ * @brief Action id of records without an action
+ */
+#define JOURNAL_NO_ACTION 0xffff
+
+/**
+ * @brief Record types
+ */
+typedef enum {
+    JOURNAL_START = 1,          /* value: daemon pid */
+    JOURNAL_KEY,                /* dev, code, value; latency: kernel timestamp to read */
+    JOURNAL_GESTURE,            /* code, value: gesture_t */
+    JOURNAL_SUBMIT,             /* action, code, value: journal_submit_t; latency: press to submit */
+    JOURNAL_ACTION,             /* action, code, value: handler result; latency: run time */
+    JOURNAL_DEVICE_ADD,         /* dev */
+    JOURNAL_DEVICE_REMOVE,      /* dev */
+    JOURNAL_RESYNC,             /* value: devices monitored afterwards */
+    JOURNAL_CONFIG,             /* value: button table generation */
+    JOURNAL_WPS                 /* code: access point or 0, value: wps_session_state_t; latency: time in previous state */
+} journal_type_t;
+
+/**
+ * @brief Outcome of an action submission
+ */
+typedef enum {
+    JOURNAL_QUEUED,
+    JOURNAL_COALESCED,          /* Pending or cooling down */
+    JOURNAL_DROPPED             /* Queue full or stopped */
+} journal_submit_t;
+
+/**
+ * @brief One journal record
+ */
+typedef struct {
+    uint64_t time_ns;           /* CLOCK_MONOTONIC */
+    uint32_t seq;               /* Stored last; 0 until the slot is first written */
+    uint32_t dev;               /* major << 20 | minor, 0 if not known */
+    uint16_t type;              /* journal_type_t */
+    uint16_t code;
+    int32_t value;
+    uint32_t latency_us;
+    uint16_t action;            /* Index into the header's action names */
+    uint16_t reserved;
+} journal_record_t;
+
+/**
+ * @brief File header, followed by JOURNAL_RECORDS records at JOURNAL_HEADER_SIZE
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t records;
+    uint32_t action_count;
+    uint32_t next_seq;          /* Sequence number of the next record, claimed atomically */
+    uint32_t reserved;
+    int64_t realtime_offset_ns; /* CLOCK_REALTIME - CLOCK_MONOTONIC when last opened */
+    char actions[JOURNAL_ACTIONS][JOURNAL_ACTION_NAME_MAX];
+} journal_header_t;
+
+/**
+ * @brief Map the journal, creating or resetting the file if needed
+ *
+ * An existing journal with the same layout is appended to.
+ *
+ * @param path Journal file, or NULL for JOURNAL_FILE
+ * @return 0 on success, -1 on failure (records are then discarded)
+ */
+int journal_open(const char *path);
+
+/**
+ * @brief Unmap the journal
+ *
+ * No other thread may write records any more.
+ */
+void journal_close(void);
+
+/**
+ * @brief Get the id that records use for an action name
+ *
+ * Names are kept in the file and reused across restarts.
+ *
+ * @param name Action name
+ * @return Action id, or JOURNAL_NO_ACTION if the table is full or the
+ *         journal is not open
+ */
+unsigned int journal_action_id(const char *name);
+
+/**
+ * @brief Append a record
+ *
+ * Safe from any thread; does nothing if the journal is not open.
+ *
+ * @param type Record type
+ * @param dev Device number, 0 if not known
+ * @param code Key code
+ * @param value Type dependent value
+ * @param action Action id or JOURNAL_NO_ACTION
+ * @param latency_ns Type dependent latency
+ */
+void journal_write(journal_type_t type, dev_t dev, int code, int value, unsigned int action,
+                   uint64_t latency_ns);
+
+#endif /* JOURNAL_H */
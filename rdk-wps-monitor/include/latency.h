@@ -0,0 +1,135 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file latency.h
+ * @brief Per-stage latency histograms for the button and hotplug paths
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+/**
+ * @brief Default file written by latency_write_file() on SIGUSR1
+ */
+#define LATENCY_STATS_FILE "/tmp/netlink-button-monitor.stats"
+
+/**
+ * @brief Sub-buckets per power of two; bounds the relative error to 1/16
+ */
+#define LATENCY_SUB_BITS 4
+
+/**
+ * @brief Largest recorded latency is 2^LATENCY_MAX_BITS - 1 ns (about 18 minutes)
+ */
+#define LATENCY_MAX_BITS 40
+
+/**
+ * @brief Number of buckets per histogram
+ */
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+
+/**
+ * @brief Measured stages
+ */
+typedef enum {
+    LATENCY_KERNEL_TO_READ,         /* evdev timestamp to read() returning it */
+    LATENCY_READ_TO_CALLBACK,       /* read() to the button callback */
+    LATENCY_CALLBACK_TO_ACK,        /* Action submission to a successful rbus set */
+    LATENCY_UEVENT_TO_MONITORED,    /* Hotplug event to the device being monitored */
+    LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+/**
+ * @brief Summary of one stage, merged over all threads
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+} latency_summary_t;
+
+/**
+ * @brief Current CLOCK_MONOTONIC time
+ *
+ * @return Time in nanoseconds
+ */
+uint64_t latency_now(void);
+
+/**
+ * @brief Convert an evdev timestamp (CLOCK_MONOTONIC) to nanoseconds
+ *
+ * @param tv The timestamp
+ * @return Time in nanoseconds
+ */
+uint64_t latency_from_timeval(const struct timeval *tv);
+
+/**
+ * @brief Record one sample
+ *
+ * Lock-free: each thread records into its own histograms. Samples with
+ * end before start are ignored.
+ *
+ * @param stage The stage measured
+ * @param start_ns Start of the stage from latency_now()
+ * @param end_ns End of the stage from latency_now()
+ */
+void latency_record(latency_stage_t stage, uint64_t start_ns, uint64_t end_ns);
+
+/**
+ * @brief Merge the histograms of all threads for one stage
+ *
+ * @param stage The stage
+ * @param summary Receives the merged summary
+ */
+void latency_get_summary(latency_stage_t stage, latency_summary_t *summary);
+
+/**
+ * @brief Get the printable name of a stage
+ *
+ * @param stage The stage
+ * @return Stage name
+ */
+const char *latency_stage_name(latency_stage_t stage);
+
+/**
+ * @brief Print a summary line for every stage
+ *
+ * @param f Stream to print to
+ */
+void latency_dump(FILE *f);
+
+/**
+ * @brief Replace a file with the output of latency_dump()
+ *
+ * @param path File to write
+ * @return 0 on success, -1 on failure
+ */
+int latency_write_file(const char *path);
+
+#endif /* LATENCY_H */
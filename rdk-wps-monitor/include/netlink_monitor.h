@@ -25,11 +25,16 @@
 #ifndef NETLINK_MONITOR_H
 #define NETLINK_MONITOR_H
 
-#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "hotplug_monitor.h"
 
 /**
  * @brief Initialize the netlink socket
  * 
+ * A socket filter is attached so that only input subsystem uevents are
+ * delivered; without it every uevent is parsed in user space.
+ * 
  * @return 0 on success, -1 on failure
  */
 int init_netlink_socket(void);
@@ -40,20 +45,41 @@ int init_netlink_socket(void);
 void close_netlink_socket(void);
 
 /**
- * @brief Start the netlink monitoring thread
+ * @brief Register the netlink socket with the event loop
+ * 
+ * The socket is read through uring_reader instead when it is set up.
  * 
- * @param thread Pointer to pthread_t to store thread ID
  * @return 0 on success, -1 on failure
  */
-int start_netlink_monitor(pthread_t *thread);
+int start_netlink_monitor(void);
+
+/**
+ * @brief Event loop handler for the netlink socket
+ * 
+ * @param fd Netlink socket descriptor
+ * @param events epoll events reported for the socket
+ * @param ctx Handler context (unused)
+ */
+void netlink_monitor_handle_event(int fd, uint32_t events, void *ctx);
 
 /**
- * @brief Event monitoring thread for netlink
+ * @brief uring_reader handler for the netlink socket
+ * 
+ * @param fd Netlink socket descriptor
+ * @param data Message received
+ * @param len Bytes received or a negative errno value
+ * @param ctx Handler context (unused)
+ */
+void netlink_monitor_handle_read(int fd, const void *data, ssize_t len, void *ctx);
+
+/**
+ * @brief Get the netlink backend counters
+ * 
+ * Dropped events are derived from gaps in the uevent SEQNUM sequence.
  * 
- * @param arg Thread argument (unused)
- * @return NULL
+ * @param stats Structure receiving the counters
  */
-void *netlink_monitor_thread(void *arg);
+void netlink_monitor_get_stats(hotplug_stats_t *stats);
 
 /**
  * @brief Parse a netlink message for input devices
@@ -0,0 +1,113 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file rbus_client.h
+ * @brief Persistent rbus session used to trigger WPS on the access points
+ */
+
+#ifndef RBUS_CLIENT_H
+#define RBUS_CLIENT_H
+
+/**
+ * @brief rbus component name used by the daemon
+ */
+#define RBUS_CLIENT_COMPONENT "netlink-button-monitor"
+
+/**
+ * @brief Default parameter below Device.WiFi.AccessPoint.{i}.WPS. whose
+ *        value-change events report the progress of a WPS session
+ *
+ * TR-181 has no such parameter: WPS.Status only tells whether WPS is
+ * configured. The name depends on the Wi-Fi agent, so it can be changed
+ * with rbus_client_set_wps_status() (-W).
+ */
+#define RBUS_CLIENT_WPS_STATUS "X_RDK_SessionStatus"
+
+/**
+ * @brief Maximum number of cached WPS-capable access points
+ */
+#define RBUS_CLIENT_MAX_APS 32
+
+/**
+ * @brief Choose the WPS session status parameter to subscribe to
+ *
+ * Call before rbus_client_init(). The values it reports are matched as
+ * listed in wps_session.h.
+ *
+ * @param name Parameter name below Device.WiFi.AccessPoint.{i}.WPS.
+ * @return 0 on success, -1 if the name is empty, dotted or too long
+ */
+int rbus_client_set_wps_status(const char *name);
+
+/**
+ * @brief Open the rbus session and discover WPS-capable access points
+ *
+ * Failure to reach rbus is not fatal; the session is reopened on demand.
+ *
+ * @return 0 if the session is open, -1 otherwise
+ */
+int rbus_client_init(void);
+
+/**
+ * @brief Close the rbus session
+ */
+void rbus_client_cleanup(void);
+
+/**
+ * @brief Activate the WPS push button on every cached access point
+ *
+ * Issues a single multi-parameter set, reconnecting once if the session
+ * was lost. Must only be called from one thread at a time.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int rbus_client_trigger_wps(void);
+
+/**
+ * @brief Ask the device control component for a full factory reset
+ *
+ * Must only be called from one thread at a time.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int rbus_client_factory_reset(void);
+
+/**
+ * @brief Set a string parameter, reconnecting once if the session was lost
+ *
+ * Must only be called from one thread at a time.
+ *
+ * @param name Full parameter name
+ * @param value New value
+ * @return 0 on success, -1 on failure
+ */
+int rbus_client_set_string(const char *name, const char *value);
+
+/**
+ * @brief Tell whether an rbus error means the session itself is gone
+ *
+ * Shared with the rbus provider, so both reconnect on the same errors.
+ *
+ * @param err rbusError_t returned by an rbus call
+ * @return 1 if reopening the session may help, 0 otherwise
+ */
+int rbus_client_is_connection_error(int err);
+
+#endif /* RBUS_CLIENT_H */
@@ -0,0 +1,75 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file rbus_provider.h
+ * @brief rbus data elements that push button events to other components
+ *
+ * Registers the table Device.X_RDK_Button.{i}. with one row per key code
+ * seen, added on its first event:
+ *
+ *   Device.X_RDK_Button.{i}.Code   key code (int32, read-only)
+ *   Device.X_RDK_Button.{i}.Event  last event of the button (string):
+ *                                  pressed, released, short, long or double
+ *
+ * Event is subscribable. Presses, releases and gestures are published as
+ * value-change events carrying value, oldValue, device and time; nothing
+ * is published for a button without subscribers. A get returns the
+ * cached last event, so consumers never poll.
+ *
+ * Events reach the provider through a key event bus subscriber with a
+ * thread of its own, so rbus calls never run on the event loop.
+ */
+
+#ifndef RBUS_PROVIDER_H
+#define RBUS_PROVIDER_H
+
+/**
+ * @brief rbus component name of the provider session
+ */
+#define RBUS_PROVIDER_COMPONENT "netlink-button-monitor-events"
+
+/**
+ * @brief Table holding one row per button
+ */
+#define RBUS_PROVIDER_TABLE "Device.X_RDK_Button."
+
+/**
+ * @brief Maximum number of rows
+ */
+#define RBUS_PROVIDER_MAX_BUTTONS 16
+
+/**
+ * @brief Subscribe to the key event bus and register the data elements
+ *
+ * Must be called on the event loop thread after event_loop_init(). If
+ * rbus is not up yet, registration is retried on the next event.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int rbus_provider_init(void);
+
+/**
+ * @brief Publish what is still queued, then unregister and close the session
+ *
+ * Must be called on the event loop thread.
+ */
+void rbus_provider_cleanup(void);
+
+#endif /* RBUS_PROVIDER_H */
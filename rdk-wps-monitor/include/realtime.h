@@ -0,0 +1,93 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file realtime.h
+ * @brief Opt-in real-time mode for the event loop thread
+ *
+ * All input is read and turned into gestures on the event loop thread, so
+ * that is the only thread made real-time. Action, rbus and log work runs
+ * on threads started before it and keeps the normal policy; threads and
+ * processes started from the loop thread later are reset to it as well.
+ */
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+/**
+ * @brief Default SCHED_FIFO priority
+ *
+ * Below the kernel's threaded interrupt handlers (50), so the drivers that
+ * deliver the input still run first.
+ */
+#define REALTIME_DEFAULT_PRIORITY 40
+
+/**
+ * @brief Stack touched up front so the loop never faults on stack growth
+ */
+#define REALTIME_STACK_PREFAULT (256 * 1024)
+
+/**
+ * @brief Default stack size of threads started in real-time mode
+ *
+ * mlockall() pins every thread stack in full; glibc's default is 8 MiB.
+ */
+#define REALTIME_THREAD_STACK (256 * 1024)
+
+/**
+ * @brief Real-time settings
+ */
+typedef struct {
+    int priority;               /* SCHED_FIFO priority, 1 to 99 */
+    int cpu;                    /* CPU to pin the loop thread to, -1 for any */
+} realtime_config_t;
+
+/**
+ * @brief Parse "<priority>[:<cpu>]"
+ *
+ * @param spec String to parse
+ * @param config Receives the settings
+ * @return 0 on success, -1 if the string is invalid
+ */
+int realtime_parse(const char *spec, realtime_config_t *config);
+
+/**
+ * @brief Shrink the default stack of threads started from now on
+ *
+ * Applies to every later pthread_create() in the process, including the
+ * threads rbus starts and the event bus delivery threads. Call before the
+ * first thread starts.
+ *
+ * @return 0 on success, -1 on error
+ */
+int realtime_prepare(void);
+
+/**
+ * @brief Make the calling thread real-time and lock the process in memory
+ *
+ * Pins the thread, locks current and future memory, pre-faults the stack
+ * and switches to SCHED_FIFO. Call from the event loop thread once every
+ * other thread has started. Steps that fail are logged and skipped.
+ *
+ * @param config Settings
+ * @return 0 if every step succeeded, -1 otherwise
+ */
+int realtime_enter(const realtime_config_t *config);
+
+#endif /* REALTIME_H */
@@ -0,0 +1,100 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uevent_parser.h
+ * @brief Single-pass, zero-copy parser for kernel uevent messages
+ */
+
+#ifndef UEVENT_PARSER_H
+#define UEVENT_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of message bytes the uevent socket filter searches for
+ *        SUBSYSTEM=input
+ */
+#define UEVENT_FILTER_SCAN_LEN 256
+
+/**
+ * @brief View into the receive buffer; not NUL-terminated
+ */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} uevent_str_t;
+
+/**
+ * @brief Fields extracted from one uevent
+ *
+ * String fields point into the parsed buffer and stay valid only as long
+ * as the buffer does. Missing fields have a NULL pointer and zero length.
+ */
+typedef struct {
+    uevent_str_t action;
+    uevent_str_t devpath;
+    uevent_str_t subsystem;
+    uevent_str_t devname;
+    uint64_t seqnum;
+    int major;              /* -1 if not present */
+    int minor;              /* -1 if not present */
+} uevent_t;
+
+/**
+ * @brief Parse a uevent message
+ *
+ * @param buffer Message buffer ("KEY=value" entries separated by NUL bytes)
+ * @param len Length of the message
+ * @param event Receives the parsed fields
+ * @return 0 on success, -1 if the message carries no ACTION
+ */
+int uevent_parse(const char *buffer, size_t len, uevent_t *event);
+
+/**
+ * @brief Compare a view against a NUL-terminated string
+ *
+ * @param str The view
+ * @param literal String to compare against
+ * @return Non-zero if equal
+ */
+int uevent_str_eq(uevent_str_t str, const char *literal);
+
+/**
+ * @brief Check whether a view starts with a NUL-terminated prefix
+ *
+ * @param str The view
+ * @param prefix Prefix to look for
+ * @return Non-zero if str starts with prefix
+ */
+int uevent_str_has_prefix(uevent_str_t str, const char *prefix);
+
+/**
+ * @brief Attach a socket filter that drops uevents of other subsystems
+ *
+ * Only messages whose SUBSYSTEM key names another subsystem are dropped;
+ * anything the filter cannot decide is passed on for uevent_parse().
+ *
+ * @param sock Socket receiving uevents
+ * @return 0 on success, -1 on failure with errno set
+ */
+int uevent_filter_attach(int sock);
+
+#endif /* UEVENT_PARSER_H */
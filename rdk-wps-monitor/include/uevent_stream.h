@@ -0,0 +1,68 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uevent_stream.h
+ * @brief Hotplug backend reading uevents from a pipe or a recorded file
+ *
+ * The stream uses the corpus format of tools/uevent_corpus.txt: one
+ * KEY=value per line, messages separated by a blank line, lines starting
+ * with '#' ignored. Messages go through the same parser as netlink
+ * uevents, so replayed and live hotplugs take the same path.
+ */
+
+#ifndef UEVENT_STREAM_H
+#define UEVENT_STREAM_H
+
+#include <stdint.h>
+#include "hotplug_monitor.h"
+
+/**
+ * @brief Open the uevent stream
+ *
+ * @param path FIFO or regular file to read
+ * @return 0 on success, -1 on failure
+ */
+int init_uevent_stream(const char *path);
+
+/**
+ * @brief Start reading the stream
+ *
+ * A FIFO is registered with the event loop; a regular file is replayed
+ * completely before this returns.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int start_uevent_stream(void);
+
+/**
+ * @brief Close the uevent stream
+ */
+void close_uevent_stream(void);
+
+/**
+ * @brief Event loop handler for the stream descriptor
+ *
+ * @param fd Stream descriptor
+ * @param events epoll events reported for the descriptor
+ * @param ctx Handler context (unused)
+ */
+void uevent_stream_handle_event(int fd, uint32_t events, void *ctx);
+
+#endif /* UEVENT_STREAM_H */
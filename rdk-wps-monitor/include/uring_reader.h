@@ -0,0 +1,140 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uring_reader.h
+ * @brief Optional io_uring read backend for evdev nodes and the uevent socket
+ *
+ * Every registered descriptor keeps a multishot read (recv for sockets)
+ * outstanding that picks its buffer from a ring registered with the
+ * kernel. Completions are drained from the shared completion queue when
+ * the event loop reports the ring descriptor readable, so a batch of
+ * input costs no read() calls and, while the multishot requests stay
+ * armed, no submissions. Kernels without multishot reads (before 6.7)
+ * get single-shot reads that are re-armed after every completion.
+ *
+ * Built without io_uring when NO_IO_URING is defined; uring_reader_init()
+ * then fails and callers keep using the event loop and read().
+ */
+
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Maximum number of descriptors read through the ring
+ */
+#define URING_READER_MAX 64
+
+/**
+ * @brief Size of each read buffer
+ *
+ * A multiple of the evdev event size on 32 and 64-bit targets and larger
+ * than a uevent, so one buffer never splits an input event or truncates
+ * a uevent.
+ */
+#define URING_READER_BUFFER_SIZE 6144
+
+/**
+ * @brief Number of read buffers shared by all descriptors
+ */
+#define URING_READER_BUFFERS 64
+
+/**
+ * @brief Handler for a completed read
+ *
+ * @param fd Descriptor the data was read from
+ * @param data Data read, only valid during the call; NULL unless len > 0
+ * @param len Bytes read, 0 at end of file or a negative errno value;
+ *            -ENOBUFS means the shared buffers ran out (nothing was read)
+ *            or, for sockets, that the socket dropped messages
+ * @param ctx Context passed to uring_reader_add()
+ */
+typedef void (*uring_read_handler)(int fd, const void *data, ssize_t len, void *ctx);
+
+/**
+ * @brief Ring counters
+ */
+typedef struct {
+    unsigned long completions;  /* Reads completed, with or without data */
+    unsigned long submits;      /* io_uring_enter() calls that submitted requests */
+    unsigned long stalls;       /* Reads ended because every buffer was in use */
+} uring_reader_stats_t;
+
+/**
+ * @brief Set up the ring and register it with the event loop
+ *
+ * Must be called after event_loop_init().
+ *
+ * @return 0 on success, -1 if io_uring is unavailable or not built in
+ */
+int uring_reader_init(void);
+
+/**
+ * @brief Cancel all reads and release the ring
+ *
+ * Must be called after every descriptor has been removed and before
+ * event_loop_cleanup().
+ */
+void uring_reader_cleanup(void);
+
+/**
+ * @brief Check whether the ring is set up
+ *
+ * @return 1 if uring_reader_add() can be used, 0 otherwise
+ */
+int uring_reader_enabled(void);
+
+/**
+ * @brief Start reading a descriptor through the ring
+ *
+ * The descriptor must be non-blocking. As with the event loop, nothing is
+ * read until the descriptor polls readable. Must be called on the event
+ * loop thread.
+ *
+ * @param fd Descriptor to read from
+ * @param handler Handler called for every completed read
+ * @param ctx Context passed to the handler
+ * @return 0 on success, -1 if the ring is unavailable or full
+ */
+int uring_reader_add(int fd, uring_read_handler handler, void *ctx);
+
+/**
+ * @brief Stop reading a descriptor
+ *
+ * The handler is not called for the descriptor afterwards, even for
+ * completions already queued. Cancellation of the outstanding read is
+ * submitted before this returns, so the descriptor may be closed right
+ * away. Must be called on the event loop thread.
+ *
+ * @param fd Descriptor passed to uring_reader_add()
+ */
+void uring_reader_remove(int fd);
+
+/**
+ * @brief Get the ring counters
+ *
+ * Must be called on the event loop thread.
+ *
+ * @param stats Filled with the current counters
+ */
+void uring_reader_get_stats(uring_reader_stats_t *stats);
+
+#endif /* URING_READER_H */
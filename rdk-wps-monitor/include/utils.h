@@ -28,6 +28,35 @@
 #include <stdbool.h>
 #include <syslog.h>
 
+/**
+ * @brief Number of slots in the log ring (power of two)
+ */
+#define LOG_RING_SIZE 128
+
+/**
+ * @brief Maximum length of one formatted log line
+ */
+#define LOG_LINE_MAX 512
+
+/**
+ * @brief Messages each call site may log per rate limit interval
+ */
+#define LOG_RATELIMIT_BURST 20
+
+/**
+ * @brief Rate limit interval in seconds
+ */
+#define LOG_RATELIMIT_INTERVAL 1
+
+/**
+ * @brief Per call site rate limit state
+ */
+typedef struct {
+    long window;                /* Interval the counters belong to */
+    unsigned int count;         /* Messages logged in the window */
+    unsigned int suppressed;    /* Messages rate limited in the window */
+} log_ratelimit_t;
+
 /**
  * @brief Initialize logging
  * 
@@ -39,10 +68,65 @@ void log_init(bool daemon_mode, bool debug_mode);
 /**
  * @brief Log a message to syslog and stdout if in debug mode
  * 
+ * Each call site is rate limited separately. While the log writer runs,
+ * the message is formatted into a lock-free ring and never blocks.
+ * 
+ * @param level The log level (LOG_INFO, LOG_WARNING, etc.)
+ * @param ... Format string followed by arguments
+ */
+#define log_message(level, ...) \
+    do { \
+        static log_ratelimit_t log_ratelimit_; \
+        log_message_ratelimited(&log_ratelimit_, (level), __VA_ARGS__); \
+    } while (0)
+
+/**
+ * @brief Log a message subject to a rate limit
+ * 
+ * @param ratelimit Rate limit state of the call site
  * @param level The log level (LOG_INFO, LOG_WARNING, etc.)
  * @param fmt Format string followed by arguments
  */
-void log_message(int level, const char *fmt, ...);
+void log_message_ratelimited(log_ratelimit_t *ratelimit, int level, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Log one line of a listing, without rate limit
+ *
+ * For output bounded by what is listed, such as the device scan or the
+ * monitored device list, which would otherwise be cut off after
+ * LOG_RATELIMIT_BURST lines. Never for messages an outside event can
+ * repeat. If the log ring is full the line is written synchronously.
+ *
+ * @param level The log level (LOG_INFO, LOG_WARNING, etc.)
+ * @param fmt Format string followed by arguments
+ */
+void log_listing(int level, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Start the background thread draining the log ring
+ * 
+ * Until it runs, messages are written synchronously.
+ * 
+ * @return 0 on success, -1 on failure
+ */
+int log_start_writer(void);
+
+/**
+ * @brief Flush the log ring and stop the writer thread
+ *
+ * Every other thread that logs must have been stopped first; messages are
+ * written synchronously again afterwards.
+ */
+void log_stop_writer(void);
+
+/**
+ * @brief Get the number of messages lost to a full ring or rate limiting
+ * 
+ * @return Number of dropped messages
+ */
+unsigned long log_get_dropped(void);
 
 /**
  * @brief Daemonize the process
@@ -83,6 +167,9 @@ bool get_running_state(void);
 /**
  * @brief Set debug mode
  * 
+ * Debug output is echoed to stdout only when log_init() ran in the
+ * foreground; a daemon writes it to syslog alone.
+ * 
  * @param debug Whether debug mode is enabled
  */
 void set_debug_mode(bool debug);
@@ -0,0 +1,138 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wps_session.h
+ * @brief WPS session state machine driven by access point status events
+ *
+ * The wps action asks wps_session_press() whether a press starts a new
+ * session, extends the running one or is ignored. The session then
+ * follows the WPS status events the access points publish on rbus: it
+ * succeeds when one of them reports success, and otherwise ends with the
+ * worst result once no access point is active any more. Without status
+ * events a session times out when the walk time has passed. Nothing
+ * waits for the outcome; the state is only looked at when something
+ * happens.
+ *
+ * All functions may be called from any thread.
+ */
+
+#ifndef WPS_SESSION_H
+#define WPS_SESSION_H
+
+#include <stdint.h>
+
+/**
+ * @brief WPS walk time; a session without a result is timed out after it
+ */
+#define WPS_SESSION_WALK_MS 120000
+
+/**
+ * @brief Presses within this time of triggering WPS are ignored
+ */
+#define WPS_SESSION_HOLDOFF_MS 5000
+
+/**
+ * @brief Access points tracked per session
+ */
+#define WPS_SESSION_MAX_APS 32
+
+/**
+ * @brief Session states
+ */
+typedef enum {
+    WPS_SESSION_IDLE,
+    WPS_SESSION_ACTIVE,
+    WPS_SESSION_SUCCESS,
+    WPS_SESSION_TIMEOUT,
+    WPS_SESSION_FAILURE,
+    WPS_SESSION_STATE_COUNT
+} wps_session_state_t;
+
+/**
+ * @brief What a press does
+ */
+typedef enum {
+    WPS_PRESS_START,            /* No session, or the last one succeeded */
+    WPS_PRESS_RESTART,          /* The last session timed out or failed */
+    WPS_PRESS_EXTEND,           /* Trigger again, restarting the walk time */
+    WPS_PRESS_IGNORE            /* A session was triggered moments ago */
+} wps_press_t;
+
+/**
+ * @brief Session counters
+ */
+typedef struct {
+    wps_session_state_t state;
+    uint64_t state_ns;          /* Time in the current state */
+    unsigned long sessions;
+    unsigned long succeeded;
+    unsigned long timed_out;
+    unsigned long failed;
+    unsigned long extended;
+    unsigned long ignored;
+} wps_session_stats_t;
+
+/**
+ * @brief Decide what a press does and, unless ignored, mark the session active
+ *
+ * @return What the caller should do
+ */
+wps_press_t wps_session_press(void);
+
+/**
+ * @brief Record that WPS could not be triggered; the session fails
+ */
+void wps_session_trigger_failed(void);
+
+/**
+ * @brief Feed a WPS status event of an access point
+ *
+ * Status values are Idle, Active (or InProgress), Success, Timeout and
+ * Failed (or Error, Overlap); others, or NULL, are ignored.
+ *
+ * @param instance Access point instance number
+ * @param status Status value from the event
+ */
+void wps_session_status(unsigned int instance, const char *status);
+
+/**
+ * @brief Get the session state and counters
+ *
+ * @param stats Structure receiving the counters
+ */
+void wps_session_get_stats(wps_session_stats_t *stats);
+
+/**
+ * @brief Get the name of a session state
+ *
+ * @param state The state
+ * @return Lower-case name, e.g. "active"
+ */
+const char *wps_session_state_name(wps_session_state_t state);
+
+/**
+ * @brief Get the name of a press decision
+ *
+ * @param press The decision
+ * @return Lower-case name, e.g. "extend"
+ */
+const char *wps_press_name(wps_press_t press);
+
+#endif /* WPS_SESSION_H */
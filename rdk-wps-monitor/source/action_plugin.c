@@ -0,0 +1,474 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file action_plugin.c
+ * @brief Implementation of the built-in action plugins and plugin loading
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <syslog.h>
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include "../include/action_plugin.h"
+#include "../include/latency.h"
+#include "../include/rbus_client.h"
+#include "../include/utils.h"
+
+#define SPAWN_MAX_ARGS 15
+#define SPAWN_TIMEOUT_MS 5000       // Longest a spawned program may hold up the worker
+#define SPAWN_KILL_GRACE_MS 500     // Between SIGTERM and SIGKILL
+#define SPAWN_POLL_MS 10            // Exit check interval without pidfd_open()
+
+extern char **environ;
+
+// An action bound to a plugin instance
+typedef struct {
+    const action_plugin_t *plugin;
+    void *instance;
+} plugin_action_t;
+
+// Plugin registry, only changed during startup and shutdown
+static const action_plugin_t *plugins[ACTION_PLUGIN_MAX];
+static int plugin_count = 0;
+static void *modules[ACTION_PLUGIN_MAX];
+static int module_count = 0;
+
+// Split "<left>=<right>" into two strings owned by one allocation
+static char *split_assignment(const char *arg, char **right) {
+    char *left = strdup(arg);
+    char *eq = left ? strchr(left, '=') : NULL;
+
+    if (!eq || eq == left) {
+        free(left);
+        return NULL;
+    }
+
+    *eq = '\0';
+    *right = eq + 1;
+    return left;
+}
+
+/* append:<file> */
+
+static void *append_create(const char *arg) {
+    return *arg ? strdup(arg) : NULL;
+}
+
+static int append_run(void *instance, const action_request_t *request) {
+    const char *path = (const char *)instance;
+    char line[160];
+    int len;
+    int fd;
+
+    len = snprintf(line, sizeof(line), "%ld.%06ld %s button %d %s\n",
+                   (long)request->timestamp.tv_sec, (long)request->timestamp.tv_usec,
+                   request->device, request->button_code, action_get_name(request->action));
+    if (len >= (int)sizeof(line)) {
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+
+    // Reopened every time so log rotation needs no signal
+    fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_message(LOG_WARNING, "Failed to open %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    // O_APPEND makes a single write atomic against other writers
+    if (write(fd, line, len) != len) {
+        log_message(LOG_WARNING, "Failed to append to %s: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    close(fd);
+    return 0;
+}
+
+/* rbus-set:<name>=<value> and sysfs:<file>=<value> */
+
+typedef struct {
+    char *name;
+    char *value;
+} assignment_t;
+
+static void *assignment_create(const char *arg) {
+    assignment_t *a = malloc(sizeof(*a));
+
+    if (!a) {
+        return NULL;
+    }
+
+    a->name = split_assignment(arg, &a->value);
+    if (!a->name) {
+        free(a);
+        return NULL;
+    }
+
+    return a;
+}
+
+static void assignment_destroy(void *instance) {
+    assignment_t *a = (assignment_t *)instance;
+
+    free(a->name);
+    free(a);
+}
+
+static int rbus_set_run(void *instance, const action_request_t *request) {
+    const assignment_t *a = (const assignment_t *)instance;
+
+    /* Prevent unused parameter warning */
+    (void)request;
+
+    return rbus_client_set_string(a->name, a->value);
+}
+
+static int sysfs_run(void *instance, const action_request_t *request) {
+    const assignment_t *a = (const assignment_t *)instance;
+    size_t len = strlen(a->value);
+    int fd;
+
+    /* Prevent unused parameter warning */
+    (void)request;
+
+    fd = open(a->name, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_message(LOG_WARNING, "Failed to open %s: %s", a->name, strerror(errno));
+        return -1;
+    }
+
+    // sysfs takes the whole value in one write
+    if (write(fd, a->value, len) != (ssize_t)len) {
+        log_message(LOG_WARNING, "Failed to write %s: %s", a->name, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    close(fd);
+    return 0;
+}
+
+/* spawn:<program> <args...> */
+
+typedef struct {
+    char *words;
+    char *argv[SPAWN_MAX_ARGS + 1];
+} spawn_t;
+
+// The command line is split once; there is no shell and no quoting
+static void *spawn_create(const char *arg) {
+    spawn_t *s = calloc(1, sizeof(*s));
+    char *save = NULL;
+    int argc = 0;
+
+    if (!s || !(s->words = strdup(arg))) {
+        free(s);
+        return NULL;
+    }
+
+    for (char *word = strtok_r(s->words, " \t", &save); word; word = strtok_r(NULL, " \t", &save)) {
+        if (argc == SPAWN_MAX_ARGS) {
+            log_message(LOG_ERR, "Too many arguments for spawn action: %s", arg);
+            argc = 0;
+            break;
+        }
+        s->argv[argc++] = word;
+    }
+
+    if (argc == 0 || s->argv[0][0] != '/') {
+        log_message(LOG_ERR, "spawn action needs an absolute program path: %s", arg);
+        free(s->words);
+        free(s);
+        return NULL;
+    }
+
+    return s;
+}
+
+static void spawn_destroy(void *instance) {
+    spawn_t *s = (spawn_t *)instance;
+
+    free(s->words);
+    free(s);
+}
+
+static pid_t reap(pid_t pid, int *status, int flags) {
+    pid_t ret;
+
+    while ((ret = waitpid(pid, status, flags)) < 0 && errno == EINTR) {
+    }
+    return ret;
+}
+
+// 1 once the child is reaped, 0 if it still runs after timeout_ms, -1 on error
+static int wait_for_child(pid_t pid, unsigned int timeout_ms, int *status) {
+    uint64_t deadline = latency_now() + (uint64_t)timeout_ms * 1000000ULL;
+    struct pollfd pfd = { -1, POLLIN, 0 };
+    int ret = 0;
+
+#ifdef SYS_pidfd_open
+    pfd.fd = (int)syscall(SYS_pidfd_open, pid, 0);
+#endif
+
+    for (;;) {
+        pid_t reaped = reap(pid, status, WNOHANG);
+        uint64_t now = latency_now();
+        int wait_ms;
+
+        if (reaped != 0) {
+            ret = reaped == pid ? 1 : -1;
+            break;
+        }
+        if (now >= deadline) {
+            break;
+        }
+
+        wait_ms = (int)((deadline - now + 999999) / 1000000);
+        if (pfd.fd >= 0) {
+            poll(&pfd, 1, wait_ms);
+        } else {
+            // Kernels before 5.3 have no pidfd to wait on
+            poll(NULL, 0, wait_ms < SPAWN_POLL_MS ? wait_ms : SPAWN_POLL_MS);
+        }
+    }
+
+    if (pfd.fd >= 0) {
+        close(pfd.fd);
+    }
+    return ret;
+}
+
+static int spawn_run(void *instance, const action_request_t *request) {
+    spawn_t *s = (spawn_t *)instance;
+    posix_spawnattr_t attr;
+    sigset_t none;
+    pid_t pid;
+    int status;
+    int err;
+
+    /* Prevent unused parameter warning */
+    (void)request;
+
+    // The daemon blocks signals it reads through signalfd; the child must
+    // not. Its own process group lets a timeout kill what it started too.
+    sigemptyset(&none);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETPGROUP);
+
+    err = posix_spawn(&pid, s->argv[0], NULL, &attr, s->argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        log_message(LOG_WARNING, "Failed to spawn %s: %s", s->argv[0], strerror(err));
+        return -1;
+    }
+
+    // The worker runs every other action too, so a hung program is killed
+    switch (wait_for_child(pid, SPAWN_TIMEOUT_MS, &status)) {
+    case 1:
+        break;
+    case 0:
+        log_message(LOG_WARNING, "%s still running after %d ms, killing it", s->argv[0], SPAWN_TIMEOUT_MS);
+        kill(-pid, SIGTERM);
+        if (wait_for_child(pid, SPAWN_KILL_GRACE_MS, &status) == 0) {
+            kill(-pid, SIGKILL);
+            reap(pid, &status, 0);
+        }
+        return -1;
+    default:
+        log_message(LOG_WARNING, "Failed to wait for %s: %s", s->argv[0], strerror(errno));
+        return -1;
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        log_message(LOG_WARNING, "%s failed with status %d", s->argv[0], status);
+        return -1;
+    }
+
+    return 0;
+}
+
+static const action_plugin_t builtin_plugins[] = {
+    { ACTION_PLUGIN_API_VERSION, "append", append_create, append_run, free },
+    { ACTION_PLUGIN_API_VERSION, "rbus-set", assignment_create, rbus_set_run, assignment_destroy },
+    { ACTION_PLUGIN_API_VERSION, "sysfs", assignment_create, sysfs_run, assignment_destroy },
+    { ACTION_PLUGIN_API_VERSION, "spawn", spawn_create, spawn_run, spawn_destroy },
+};
+
+int action_plugin_init(void) {
+    for (size_t i = 0; i < sizeof(builtin_plugins) / sizeof(builtin_plugins[0]); i++) {
+        if (action_plugin_register(&builtin_plugins[i]) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void action_plugin_cleanup(void) {
+    plugin_count = 0;
+
+    while (module_count > 0) {
+        dlclose(modules[--module_count]);
+    }
+}
+
+static const action_plugin_t *find_plugin(const char *name, size_t len) {
+    for (int i = 0; i < plugin_count; i++) {
+        if (strncmp(plugins[i]->name, name, len) == 0 && plugins[i]->name[len] == '\0') {
+            return plugins[i];
+        }
+    }
+
+    return NULL;
+}
+
+int action_plugin_register(const action_plugin_t *plugin) {
+    if (!plugin || !plugin->name || !plugin->create || !plugin->run) {
+        return -1;
+    }
+
+    if (plugin->api_version != ACTION_PLUGIN_API_VERSION) {
+        log_message(LOG_ERR, "Action plugin %s has API version %u, expected %u",
+                    plugin->name, plugin->api_version, ACTION_PLUGIN_API_VERSION);
+        return -1;
+    }
+
+    if (find_plugin(plugin->name, strlen(plugin->name))) {
+        log_message(LOG_ERR, "Action plugin %s is already registered", plugin->name);
+        return -1;
+    }
+
+    if (plugin_count == ACTION_PLUGIN_MAX) {
+        log_message(LOG_ERR, "Too many action plugins, not registering %s", plugin->name);
+        return -1;
+    }
+
+    plugins[plugin_count++] = plugin;
+    return 0;
+}
+
+int action_plugin_load(const char *path) {
+    const action_plugin_t *plugin;
+    void *module;
+
+    if (module_count == ACTION_PLUGIN_MAX) {
+        log_message(LOG_ERR, "Too many plugin modules, not loading %s", path);
+        return -1;
+    }
+
+    module = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!module) {
+        log_message(LOG_ERR, "Failed to load plugin module: %s", dlerror());
+        return -1;
+    }
+
+    plugin = (const action_plugin_t *)dlsym(module, ACTION_PLUGIN_SYMBOL);
+    if (!plugin || action_plugin_register(plugin) < 0) {
+        log_message(LOG_ERR, "%s does not export a usable %s", path, ACTION_PLUGIN_SYMBOL);
+        dlclose(module);
+        return -1;
+    }
+
+    modules[module_count++] = module;
+    log_message(LOG_INFO, "Loaded action plugin %s from %s", plugin->name, path);
+    return 0;
+}
+
+static int plugin_action_handler(const action_request_t *request, void *ctx) {
+    plugin_action_t *pa = (plugin_action_t *)ctx;
+
+    if (pa->plugin->run(pa->instance, request) < 0) {
+        log_message(LOG_WARNING, "Action %s failed", action_get_name(request->action));
+        return -1;
+    }
+    return 0;
+}
+
+action_t *action_plugin_create_action(const char *spec, unsigned int cooldown_ms) {
+    const char *colon = strchr(spec, ':');
+    size_t name_len = colon ? (size_t)(colon - spec) : strlen(spec);
+    const action_plugin_t *plugin = find_plugin(spec, name_len);
+    plugin_action_t *pa;
+    action_t *action;
+
+    if (!plugin) {
+        log_message(LOG_ERR, "Unknown action plugin in %s", spec);
+        return NULL;
+    }
+
+    pa = malloc(sizeof(*pa));
+    if (!pa) {
+        return NULL;
+    }
+
+    pa->plugin = plugin;
+    pa->instance = plugin->create(colon ? colon + 1 : "");
+    if (!pa->instance) {
+        log_message(LOG_ERR, "Invalid action %s", spec);
+        free(pa);
+        return NULL;
+    }
+
+    action = action_create(spec, plugin_action_handler, pa, cooldown_ms);
+    if (!action) {
+        if (plugin->destroy) {
+            plugin->destroy(pa->instance);
+        }
+        free(pa);
+        return NULL;
+    }
+
+    return action;
+}
+
+void action_plugin_destroy_action(action_t *action) {
+    action_timing_t timing;
+    plugin_action_t *pa;
+
+    if (!action) {
+        return;
+    }
+
+    action_get_timing(action, &timing);
+    if (timing.runs > 0) {
+        log_message(LOG_INFO, "Action %s: %lu runs, mean %.3f ms, max %.3f ms", action_get_name(action),
+                    timing.runs, timing.total_ns / 1e6 / timing.runs, timing.max_ns / 1e6);
+    }
+
+    pa = (plugin_action_t *)action_get_ctx(action);
+    if (pa->plugin->destroy) {
+        pa->plugin->destroy(pa->instance);
+    }
+    free(pa);
+    action_destroy(action);
+}
@@ -0,0 +1,333 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file action_queue.c
+ * @brief Implementation of the asynchronous action dispatch queue
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <syslog.h>
+#include <pthread.h>
+#include "../include/action_queue.h"
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+struct action {
+    char *name;
+    action_handler handler;
+    void *ctx;
+    unsigned int cooldown_ms;
+    int pending;                    /* Queued or running */
+    struct timespec cooldown_until; /* CLOCK_MONOTONIC */
+    action_timing_t timing;
+    unsigned int journal_id;
+};
+
+// Queue state, all protected by queue_mutex
+static action_request_t *requests = NULL;
+static unsigned int queue_head = 0;
+static action_queue_stats_t stats;
+static int worker_running = 0;
+static pthread_t worker_thread;
+static pthread_mutex_t queue_mutex;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+
+static int timespec_before(const struct timespec *a, const struct timespec *b) {
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+action_t *action_create(const char *name, action_handler handler, void *ctx,
+                        unsigned int cooldown_ms) {
+    action_t *action;
+
+    if (!name || !handler) {
+        return NULL;
+    }
+
+    action = calloc(1, sizeof(*action));
+    if (!action) {
+        return NULL;
+    }
+
+    action->name = strdup(name);
+    if (!action->name) {
+        free(action);
+        return NULL;
+    }
+
+    action->handler = handler;
+    action->ctx = ctx;
+    action->cooldown_ms = cooldown_ms;
+    action->journal_id = journal_action_id(name);
+    return action;
+}
+
+void action_destroy(action_t *action) {
+    if (action) {
+        free(action->name);
+        free(action);
+    }
+}
+
+const char *action_get_name(const action_t *action) {
+    return action->name;
+}
+
+void *action_get_ctx(const action_t *action) {
+    return action->ctx;
+}
+
+int action_is_pending(const action_t *action) {
+    int pending;
+
+    pthread_mutex_lock(&queue_mutex);
+    pending = action->pending;
+    pthread_mutex_unlock(&queue_mutex);
+    return pending;
+}
+
+void action_get_timing(const action_t *action, action_timing_t *timing) {
+    pthread_mutex_lock(&queue_mutex);
+    *timing = action->timing;
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+int action_queue_init(unsigned int capacity) {
+    pthread_mutexattr_t attr;
+    int err;
+
+    if (capacity == 0) {
+        capacity = ACTION_QUEUE_DEFAULT_CAPACITY;
+    }
+
+    // The loop submits at SCHED_FIFO (-R) while the worker holds the lock at
+    // the normal policy; inheriting the loop's priority keeps other threads
+    // from preempting the worker inside its critical section
+    pthread_mutexattr_init(&attr);
+    err = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    if (err == 0) {
+        err = pthread_mutex_init(&queue_mutex, &attr);
+    }
+    pthread_mutexattr_destroy(&attr);
+    if (err != 0) {
+        log_message(LOG_WARNING, "Action queue lock without priority inheritance: %s", strerror(err));
+        pthread_mutex_init(&queue_mutex, NULL);
+    }
+
+    requests = calloc(capacity, sizeof(*requests));
+    if (!requests) {
+        log_message(LOG_ERR, "Failed to allocate action queue");
+        return -1;
+    }
+
+    queue_head = 0;
+    memset(&stats, 0, sizeof(stats));
+    stats.capacity = capacity;
+    return 0;
+}
+
+static void *action_worker_thread(void *arg) {
+    /* Prevent unused parameter warning */
+    (void)arg;
+    action_request_t request;
+    struct timespec start, done;
+    uint64_t ran_ns;
+    int result;
+
+    log_message(LOG_INFO, "Action worker thread started");
+
+    pthread_mutex_lock(&queue_mutex);
+    for (;;) {
+        while (worker_running && stats.depth == 0) {
+            pthread_cond_wait(&queue_cond, &queue_mutex);
+        }
+
+        if (!worker_running) {
+            break;
+        }
+
+        request = requests[queue_head];
+        queue_head = (queue_head + 1) % stats.capacity;
+        stats.depth--;
+
+        // Never hold the queue lock while an action runs
+        pthread_mutex_unlock(&queue_mutex);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        result = request.action->handler(&request, request.action->ctx);
+        clock_gettime(CLOCK_MONOTONIC, &done);
+        ran_ns = (uint64_t)(done.tv_sec - start.tv_sec) * 1000000000ULL + (uint64_t)done.tv_nsec - (uint64_t)start.tv_nsec;
+        journal_write(JOURNAL_ACTION, 0, request.button_code, result, request.action->journal_id, ran_ns);
+        log_message(LOG_DEBUG, "Action %s ran for %.3f ms", request.action->name, ran_ns / 1e6);
+        pthread_mutex_lock(&queue_mutex);
+
+        request.action->timing.runs++;
+        request.action->timing.last_ns = ran_ns;
+        request.action->timing.total_ns += ran_ns;
+        if (ran_ns > request.action->timing.max_ns) {
+            request.action->timing.max_ns = ran_ns;
+        }
+
+        request.action->pending = 0;
+        // A failed run must not swallow the user's retry press
+        if (result == 0) {
+            request.action->cooldown_until.tv_sec = done.tv_sec + request.action->cooldown_ms / 1000;
+            request.action->cooldown_until.tv_nsec = done.tv_nsec + (long)(request.action->cooldown_ms % 1000) * 1000000L;
+            if (request.action->cooldown_until.tv_nsec >= 1000000000L) {
+                request.action->cooldown_until.tv_sec++;
+                request.action->cooldown_until.tv_nsec -= 1000000000L;
+            }
+        }
+        stats.executed++;
+    }
+
+    // Pending requests are discarded on shutdown
+    for (unsigned int i = 0; i < stats.depth; i++) {
+        requests[(queue_head + i) % stats.capacity].action->pending = 0;
+    }
+    stats.depth = 0;
+    pthread_mutex_unlock(&queue_mutex);
+
+    log_message(LOG_INFO, "Action worker thread stopped");
+    return NULL;
+}
+
+int action_queue_start(void) {
+    int err;
+
+    if (!requests) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    worker_running = 1;
+    pthread_mutex_unlock(&queue_mutex);
+
+    err = pthread_create(&worker_thread, NULL, action_worker_thread, NULL);
+    if (err != 0) {
+        log_message(LOG_ERR, "Failed to create action worker thread: %s", strerror(err));
+        worker_running = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+void action_queue_stop(void) {
+    int was_running;
+
+    pthread_mutex_lock(&queue_mutex);
+    was_running = worker_running;
+    worker_running = 0;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+
+    // Waits for an action that is still running to finish
+    if (was_running) {
+        pthread_join(worker_thread, NULL);
+    }
+
+    free(requests);
+    requests = NULL;
+}
+
+// Journals how a submission ended, with the time since the triggering event
+static void journal_submit(const action_t *action, int button_code, const struct timeval *timestamp,
+                           const struct timespec *now, journal_submit_t outcome) {
+    uint64_t now_ns = (uint64_t)now->tv_sec * 1000000000ULL + (uint64_t)now->tv_nsec;
+    uint64_t event_ns = now_ns;
+
+    if (timestamp && (timestamp->tv_sec || timestamp->tv_usec)) {
+        event_ns = latency_from_timeval(timestamp);
+    }
+
+    journal_write(JOURNAL_SUBMIT, 0, button_code, outcome, action->journal_id,
+                  now_ns > event_ns ? now_ns - event_ns : 0);
+}
+
+int action_queue_submit(action_t *action, const char *device, int button_code,
+                        const struct timeval *timestamp) {
+    action_request_t *request;
+    struct timespec now;
+
+    if (!action) {
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&queue_mutex);
+    stats.submitted++;
+
+    if (!worker_running) {
+        stats.dropped++;
+        pthread_mutex_unlock(&queue_mutex);
+        journal_submit(action, button_code, timestamp, &now, JOURNAL_DROPPED);
+        return -1;
+    }
+
+    // A press while the action is pending or cooling down adds nothing
+    if (action->pending || timespec_before(&now, &action->cooldown_until)) {
+        stats.coalesced++;
+        pthread_mutex_unlock(&queue_mutex);
+        journal_submit(action, button_code, timestamp, &now, JOURNAL_COALESCED);
+        return 0;
+    }
+
+    if (stats.depth == stats.capacity) {
+        stats.dropped++;
+        pthread_mutex_unlock(&queue_mutex);
+        journal_submit(action, button_code, timestamp, &now, JOURNAL_DROPPED);
+        log_message(LOG_WARNING, "Action queue full, dropping %s", action->name);
+        return -1;
+    }
+
+    request = &requests[(queue_head + stats.depth) % stats.capacity];
+    request->action = action;
+    snprintf(request->device, sizeof(request->device), "%s", device ? device : "");
+    request->button_code = button_code;
+    if (timestamp) {
+        request->timestamp = *timestamp;
+    } else {
+        memset(&request->timestamp, 0, sizeof(request->timestamp));
+    }
+    request->queued = now;
+
+    action->pending = 1;
+    stats.depth++;
+    if (stats.depth > stats.max_depth) {
+        stats.max_depth = stats.depth;
+    }
+
+    // Journaled before the worker can run it, so records stay in order
+    journal_submit(action, button_code, timestamp, &now, JOURNAL_QUEUED);
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+    return 0;
+}
+
+void action_queue_get_stats(action_queue_stats_t *out) {
+    pthread_mutex_lock(&queue_mutex);
+    *out = stats;
+    pthread_mutex_unlock(&queue_mutex);
+}
@@ -0,0 +1,330 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file button_bus.c
+ * @brief Implementation of the key event bus
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "../include/button_bus.h"
+#include "../include/event_loop.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+#define CACHE_LINE 64
+
+struct button_bus_subscriber {
+    // Written by the producer
+    unsigned long head;
+    unsigned int max_depth;
+    unsigned long dropped;
+    char pad0[CACHE_LINE];
+
+    // Written by the consumer
+    unsigned long tail;
+    unsigned long delivered;
+    uint64_t last_lag_ns;
+    uint64_t max_lag_ns;
+    int sleeping;                   /* Thread consumer is about to block on wake_fd */
+    char pad1[CACHE_LINE];
+
+    char *name;
+    button_bus_delivery_t delivery;
+    button_bus_handler handler;
+    void *ctx;
+    button_event_t *ring;
+    unsigned int mask;
+    int wake_fd;                    /* eventfd */
+    int scheduled;                  /* Loop consumer: wake_fd written, not yet drained */
+    int paused;
+    int stopping;
+    pthread_t thread;
+};
+
+// Only touched from the event loop thread
+static button_bus_subscriber_t *subscribers[BUTTON_BUS_MAX_SUBSCRIBERS];
+static int subscriber_count = 0;
+
+static void wake(button_bus_subscriber_t *sub) {
+    uint64_t one = 1;
+
+    if (write(sub->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        log_message(LOG_WARNING, "Failed to wake bus subscriber %s: %s", sub->name, strerror(errno));
+    }
+}
+
+// Deliver queued events in order; returns the number delivered
+static unsigned long drain(button_bus_subscriber_t *sub) {
+    unsigned long tail = sub->tail;
+    unsigned long head = __atomic_load_n(&sub->head, __ATOMIC_ACQUIRE);
+    unsigned long count = 0;
+
+    while (tail != head && !__atomic_load_n(&sub->paused, __ATOMIC_RELAXED)) {
+        const button_event_t *event = &sub->ring[tail & sub->mask];
+        uint64_t lag = latency_now() - event->published_ns;
+
+        sub->handler(event, sub->ctx);
+
+        __atomic_store_n(&sub->last_lag_ns, lag, __ATOMIC_RELAXED);
+        if (lag > sub->max_lag_ns) {
+            __atomic_store_n(&sub->max_lag_ns, lag, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&sub->delivered, sub->delivered + 1, __ATOMIC_RELAXED);
+
+        // Hands the slot back to the producer
+        __atomic_store_n(&sub->tail, ++tail, __ATOMIC_RELEASE);
+        count++;
+    }
+
+    return count;
+}
+
+static void *delivery_thread(void *arg) {
+    button_bus_subscriber_t *sub = (button_bus_subscriber_t *)arg;
+    uint64_t wakeups;
+
+    for (;;) {
+        drain(sub);
+
+        // Announce the sleep, then look again so a publish in between is not missed
+        __atomic_store_n(&sub->sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&sub->head, __ATOMIC_SEQ_CST) != sub->tail) {
+            __atomic_store_n(&sub->sleeping, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_load_n(&sub->stopping, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        if (read(sub->wake_fd, &wakeups, sizeof(wakeups)) < 0 && errno != EINTR) {
+            log_message(LOG_ERR, "Bus subscriber %s cannot wait: %s", sub->name, strerror(errno));
+            break;
+        }
+        __atomic_store_n(&sub->sleeping, 0, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static void loop_event(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    button_bus_subscriber_t *sub = (button_bus_subscriber_t *)ctx;
+    uint64_t wakeups;
+
+    if (read(fd, &wakeups, sizeof(wakeups)) < 0 && errno != EAGAIN) {
+        log_message(LOG_WARNING, "Failed to read bus wakeup: %s", strerror(errno));
+    }
+    sub->scheduled = 0;
+    drain(sub);
+}
+
+static void free_subscriber(button_bus_subscriber_t *sub) {
+    if (sub->wake_fd >= 0) {
+        close(sub->wake_fd);
+    }
+    free(sub->ring);
+    free(sub->name);
+    free(sub);
+}
+
+button_bus_subscriber_t *button_bus_subscribe(const char *name, button_bus_delivery_t delivery,
+                                              unsigned int capacity, button_bus_handler handler,
+                                              void *ctx) {
+    button_bus_subscriber_t *sub;
+    unsigned int size = 1;
+    int err;
+
+    if (!name || !handler || subscriber_count == BUTTON_BUS_MAX_SUBSCRIBERS) {
+        return NULL;
+    }
+
+    if (capacity == 0) {
+        capacity = BUTTON_BUS_DEFAULT_CAPACITY;
+    }
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    sub = calloc(1, sizeof(*sub));
+    if (!sub) {
+        return NULL;
+    }
+    sub->wake_fd = -1;
+    sub->name = strdup(name);
+    sub->ring = calloc(size, sizeof(*sub->ring));
+    if (!sub->name || !sub->ring) {
+        free_subscriber(sub);
+        return NULL;
+    }
+    sub->mask = size - 1;
+    sub->delivery = delivery;
+    sub->handler = handler;
+    sub->ctx = ctx;
+
+    // Thread consumers block on it; the loop polls it
+    sub->wake_fd = eventfd(0, EFD_CLOEXEC | (delivery == BUTTON_BUS_LOOP ? EFD_NONBLOCK : 0));
+    if (sub->wake_fd < 0) {
+        log_message(LOG_ERR, "Failed to create wakeup for bus subscriber %s: %s", name, strerror(errno));
+        free_subscriber(sub);
+        return NULL;
+    }
+
+    if (delivery == BUTTON_BUS_LOOP) {
+        if (event_loop_add(sub->wake_fd, EPOLLIN, loop_event, sub) < 0) {
+            free_subscriber(sub);
+            return NULL;
+        }
+    } else {
+        err = pthread_create(&sub->thread, NULL, delivery_thread, sub);
+        if (err != 0) {
+            log_message(LOG_ERR, "Failed to create thread for bus subscriber %s: %s", name, strerror(err));
+            free_subscriber(sub);
+            return NULL;
+        }
+    }
+
+    subscribers[subscriber_count++] = sub;
+    log_message(LOG_INFO, "Bus subscriber %s added, %u events on %s", name, size,
+                delivery == BUTTON_BUS_LOOP ? "the event loop" : "its own thread");
+    return sub;
+}
+
+void button_bus_unsubscribe(button_bus_subscriber_t *sub) {
+    int i = 0;
+
+    if (!sub) {
+        return;
+    }
+
+    while (i < subscriber_count && subscribers[i] != sub) {
+        i++;
+    }
+    if (i == subscriber_count) {
+        return;
+    }
+    subscribers[i] = subscribers[--subscriber_count];
+
+    if (sub->delivery == BUTTON_BUS_LOOP) {
+        event_loop_remove(sub->wake_fd);
+    } else {
+        __atomic_store_n(&sub->stopping, 1, __ATOMIC_RELEASE);
+        wake(sub);
+        pthread_join(sub->thread, NULL);
+    }
+
+    log_message(LOG_INFO, "Bus subscriber %s removed: delivered %lu, dropped %lu", sub->name,
+                sub->delivered, sub->dropped);
+    free_subscriber(sub);
+}
+
+void button_bus_pause(button_bus_subscriber_t *sub, int paused) {
+    __atomic_store_n(&sub->paused, paused, __ATOMIC_RELAXED);
+
+    // Pick up what queued while paused
+    if (!paused && !sub->scheduled && sub->head != sub->tail) {
+        sub->scheduled = 1;
+        wake(sub);
+    }
+}
+
+static void publish(button_event_type_t type, const char *device, int code, int value,
+                    const struct timeval *timestamp) {
+    uint64_t now;
+
+    if (subscriber_count == 0) {
+        return;
+    }
+
+    now = latency_now();
+    for (int i = 0; i < subscriber_count; i++) {
+        button_bus_subscriber_t *sub = subscribers[i];
+        unsigned long head = sub->head;
+        unsigned long depth = head - __atomic_load_n(&sub->tail, __ATOMIC_ACQUIRE);
+        button_event_t *event;
+
+        // A full ring only costs this subscriber the event
+        if (depth > sub->mask) {
+            __atomic_store_n(&sub->dropped, sub->dropped + 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        event = &sub->ring[head & sub->mask];
+        event->type = type;
+        snprintf(event->device, sizeof(event->device), "%s", device);
+        event->code = code;
+        event->value = value;
+        event->timestamp = *timestamp;
+        event->published_ns = now;
+
+        __atomic_store_n(&sub->head, head + 1, __ATOMIC_SEQ_CST);
+        if (depth + 1 > sub->max_depth) {
+            __atomic_store_n(&sub->max_depth, (unsigned int)(depth + 1), __ATOMIC_RELAXED);
+        }
+
+        // Only a sleeping thread or an idle loop slot needs the syscall
+        if (sub->delivery == BUTTON_BUS_THREAD) {
+            if (__atomic_load_n(&sub->sleeping, __ATOMIC_SEQ_CST)) {
+                wake(sub);
+            }
+        } else if (!sub->scheduled && !sub->paused) {
+            sub->scheduled = 1;
+            wake(sub);
+        }
+    }
+}
+
+void button_bus_publish(const char *device, int code, int value, const struct timeval *timestamp) {
+    publish(BUTTON_EVENT_KEY, device, code, value, timestamp);
+}
+
+void button_bus_publish_gesture(const char *device, int code, int gesture,
+                                const struct timeval *timestamp) {
+    publish(BUTTON_EVENT_GESTURE, device, code, gesture, timestamp);
+}
+
+int button_bus_foreach(button_bus_visitor visitor, void *ctx) {
+    button_bus_stats_t stats;
+
+    for (int i = 0; i < subscriber_count; i++) {
+        button_bus_subscriber_t *sub = subscribers[i];
+
+        stats.name = sub->name;
+        stats.delivery = sub->delivery;
+        stats.capacity = sub->mask + 1;
+        stats.depth = (unsigned int)(sub->head - __atomic_load_n(&sub->tail, __ATOMIC_ACQUIRE));
+        stats.max_depth = sub->max_depth;
+        stats.delivered = __atomic_load_n(&sub->delivered, __ATOMIC_RELAXED);
+        stats.dropped = sub->dropped;
+        stats.last_lag_ns = __atomic_load_n(&sub->last_lag_ns, __ATOMIC_RELAXED);
+        stats.max_lag_ns = __atomic_load_n(&sub->max_lag_ns, __ATOMIC_RELAXED);
+        visitor(&stats, ctx);
+    }
+
+    return subscriber_count;
+}
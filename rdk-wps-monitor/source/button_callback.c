@@ -24,89 +24,233 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <syslog.h>
 #include "../include/button_callback.h"
+#include "../include/action_queue.h"
+#include "../include/action_plugin.h"
+#include "../include/button_bus.h"
+#include "../include/button_config.h"
+#include "../include/gesture.h"
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/rbus_client.h"
 #include "../include/utils.h"
+#include "../include/wps_session.h"
 
-#include <rbus.h>
-#include <pthread.h>
-#include <unistd.h>
+#define WPS_LED_DIR "/sys/class/leds/wps"
+#define WPS_EVENT_LOG "/tmp/wps_events.log"
 
-pthread_mutex_t wps_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Actions run by the custom WPS callback, in order
+static action_t *custom_actions[BUTTON_CALLBACK_MAX_CUSTOM_ACTIONS];
+static int custom_action_count = 0;
 
-#define WPS_DELAY 60 // 60 seconds delay between presses
+/* Built-in plugins for the button table; they run on the action worker */
 
-void set_wps_push_button(rbusHandle_t handle, const char* param) {
-    pthread_mutex_lock(&wps_mutex);
+static void *no_arg_create(const char *arg) {
+    static int no_state;
 
-    rbusError_t err = rbus_setBoolean(handle, param, true);
-    if (err != RBUS_ERROR_SUCCESS) {
-        printf("Failed to set %s: %d\n", param, err);
-    } else {
-        printf("Successfully set %s.\n", param);
+    /* Prevent unused parameter warning */
+    (void)arg;
+
+    // Any non-NULL pointer will do for plugins without state
+    return &no_state;
+}
+
+static int wps_run(void *instance, const action_request_t *request) {
+    /* Prevent unused parameter warning */
+    (void)instance;
+    wps_press_t press = wps_session_press();
+
+    // The access points are already in push button mode
+    if (press == WPS_PRESS_IGNORE) {
+        log_message(LOG_INFO, "WPS button pressed on device %s - session just triggered, ignoring", request->device);
+        return 0;
+    }
+
+    log_message(LOG_INFO, "WPS button pressed on device %s - triggering WPS action (%s)", request->device,
+                wps_press_name(press));
+    if (rbus_client_trigger_wps() < 0) {
+        wps_session_trigger_failed();
+        return -1;
     }
 
-    pthread_mutex_unlock(&wps_mutex);
+    latency_record(LATENCY_CALLBACK_TO_ACK,
+                   (uint64_t)request->queued.tv_sec * 1000000000ULL + (uint64_t)request->queued.tv_nsec,
+                   latency_now());
+    return 0;
 }
 
-// The active callback function
+static int factory_reset_run(void *instance, const action_request_t *request) {
+    /* Prevent unused parameter warning */
+    (void)instance;
+
+    log_message(LOG_NOTICE, "Long press on device %s - requesting factory reset", request->device);
+    return rbus_client_factory_reset();
+}
+
+// led-toggle:<led directory>, default WPS_LED_DIR
+static void *led_toggle_create(const char *arg) {
+    return strdup(*arg ? arg : WPS_LED_DIR);
+}
+
+static int read_led_value(const char *dir, const char *name) {
+    char path[256];
+    int value = -1;
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    f = fopen(path, "r");
+    if (f) {
+        if (fscanf(f, "%d", &value) != 1) {
+            value = -1;
+        }
+        fclose(f);
+    }
+
+    return value;
+}
+
+static int led_toggle_run(void *instance, const action_request_t *request) {
+    const char *dir = (const char *)instance;
+    int brightness = read_led_value(dir, "brightness");
+    int max_brightness = read_led_value(dir, "max_brightness");
+    char path[256];
+    FILE *f;
+
+    if (brightness < 0) {
+        log_message(LOG_WARNING, "Button on device %s toggles LED %s, which does not exist", request->device, dir);
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s/brightness", dir);
+    f = fopen(path, "w");
+    if (!f) {
+        log_message(LOG_WARNING, "Failed to toggle LED %s: %s", dir, strerror(errno));
+        return -1;
+    }
+    fprintf(f, "%d\n", brightness > 0 ? 0 : (max_brightness > 0 ? max_brightness : 1));
+    fclose(f);
+
+    log_message(LOG_INFO, "Button on device %s turned LED %s %s", request->device, dir, brightness > 0 ? "off" : "on");
+    return 0;
+}
+
+static const action_plugin_t button_plugins[] = {
+    { ACTION_PLUGIN_API_VERSION, "wps", no_arg_create, wps_run, NULL },
+    { ACTION_PLUGIN_API_VERSION, "factory-reset", no_arg_create, factory_reset_run, NULL },
+    { ACTION_PLUGIN_API_VERSION, "led-toggle", led_toggle_create, led_toggle_run, free },
+};
+
+// Runs on the event loop thread; hands the work to the action worker
+static void gesture_action_handler(const char *device, int button_code, gesture_t gesture,
+                                   const struct timeval *timestamp) {
+    log_message(LOG_INFO, "Device: %s, Button %d %s", device, button_code, gesture_name(gesture));
+    journal_write(JOURNAL_GESTURE, 0, button_code, gesture, JOURNAL_NO_ACTION, 0);
+    button_config_dispatch(device, button_code, gesture, timestamp);
+    button_bus_publish_gesture(device, button_code, gesture, timestamp);
+}
+
+// The active callback function, read on the event loop thread
 static button_callback event_callback = default_button_callback;
 
-void default_button_callback(const char *device, int button_code, int value) {
-    const char *action = (value == 1) ? "PRESSED" : (value == 0) ? "RELEASED" : "REPEATED";
-    
-    log_message(LOG_INFO, "Device: %s, Button %d %s", 
-           device, button_code, action);
-
-    rbusHandle_t handle;
-    rbusError_t err;
-    char button_name[32];
-    snprintf(button_name, sizeof(button_name), "wps_button_%d", button_code);
-
-    // Initialize RBus
-    //err = rbus_open(&handle, "wps_push_button");
-    err = rbus_open(&handle, button_name);
-    if (err != RBUS_ERROR_SUCCESS) {
-        printf("Failed to initialize RBus: %d\n", err);
+int button_callback_init(void) {
+    if (action_plugin_init() < 0) {
+        log_message(LOG_ERR, "Failed to register action plugins");
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(button_plugins) / sizeof(button_plugins[0]); i++) {
+        if (action_plugin_register(&button_plugins[i]) < 0) {
+            action_plugin_cleanup();
+            return -1;
+        }
+    }
+
+    // The session is reopened on the first press if rbus is not up yet
+    if (rbus_client_init() < 0) {
+        log_message(LOG_WARNING, "rbus not available yet, WPS session will be opened on demand");
+    }
+
+    // The custom callback always records presses, without forking a shell
+    if (button_callback_add_custom_action("append:" WPS_EVENT_LOG) < 0) {
+        button_callback_cleanup();
+        return -1;
+    }
+
+    // Which gestures mean what comes from the button table
+    if (gesture_init(gesture_action_handler) < 0) {
+        log_message(LOG_ERR, "Failed to initialize gesture recognition");
+        button_callback_cleanup();
+        return -1;
+    }
+
+    return 0;
+}
+
+int button_callback_add_custom_action(const char *spec) {
+    action_t *action;
+
+    if (custom_action_count == BUTTON_CALLBACK_MAX_CUSTOM_ACTIONS) {
+        log_message(LOG_ERR, "Too many custom actions, ignoring %s", spec);
+        return -1;
     }
 
-    // Set WPS Push Button for Access Point 1
-    log_message(LOG_INFO, "WPS button pressed on device %s - triggering WPS action for 2G", device);
-    set_wps_push_button(handle, "Device.WiFi.AccessPoint.1.WPS.X_CISCO_COM_ActivatePushButton");
+    action = action_plugin_create_action(spec, 0);
+    if (!action) {
+        return -1;
+    }
 
-    // Set WPS Push Button for Access Point 2
-    log_message(LOG_INFO, "WPS button pressed on device %s - triggering WPS action for 5G", device);
-    set_wps_push_button(handle, "Device.WiFi.AccessPoint.2.WPS.X_CISCO_COM_ActivatePushButton");
-    sleep(WPS_DELAY);
+    custom_actions[custom_action_count++] = action;
+    return 0;
+}
 
-    // Close RBus
-    rbus_close(handle);
+void button_callback_cleanup(void) {
+    gesture_cleanup();
+    button_config_cleanup();
+    while (custom_action_count > 0) {
+        action_plugin_destroy_action(custom_actions[--custom_action_count]);
+    }
+    action_plugin_cleanup();
+    rbus_client_cleanup();
 }
 
-void custom_wps_button_callback(const char *device, int button_code, int value) {
+void default_button_callback(const char *device, int button_code, int value,
+                             const struct timeval *timestamp) {
+    const char *action = (value == 1) ? "PRESSED" : (value == 0) ? "RELEASED" : "REPEATED";
+    
+    log_message(LOG_INFO, "Device: %s, Button %d %s at %ld.%06ld", 
+           device, button_code, action,
+           (long)timestamp->tv_sec, (long)timestamp->tv_usec);
+
+    // Gestures decide which action runs; recognition never blocks
+    gesture_handle_event(device, button_code, value, timestamp,
+                         button_config_gestures(device, button_code));
+}
+
+void custom_wps_button_callback(const char *device, int button_code, int value,
+                                const struct timeval *timestamp) {
     // Check if the button code matches what we're looking for
     // Button codes: KEY_WPS_BUTTON (0x211) or BTN_0 (0x100)
     if (button_code == 0x211 || button_code == 0x100) {
         if (value == 1) { // Button pressed
             log_message(LOG_INFO, "WPS button pressed on device %s - triggering WPS action", device);
             
-            // Here you would add code to trigger the actual WPS functionality
-            system("echo 'WPS button pressed' >> /tmp/wps_events.log");
+            // Each action runs in-process on the action worker
+            for (int i = 0; i < custom_action_count; i++) {
+                action_queue_submit(custom_actions[i], device, button_code, timestamp);
+            }
         }
     } else {
         // For other buttons, use the default behavior
-        default_button_callback(device, button_code, value);
+        default_button_callback(device, button_code, value, timestamp);
     }
 }
 
 void register_button_callback(button_callback callback) {
-    if (callback != NULL) {
-        event_callback = callback;
-    } else {
-        event_callback = default_button_callback;
-    }
+    __atomic_store_n(&event_callback, callback ? callback : default_button_callback, __ATOMIC_RELEASE);
 }
 
 button_callback get_button_callback(void) {
-    return event_callback;
+    return __atomic_load_n(&event_callback, __ATOMIC_ACQUIRE);
 }
@@ -0,0 +1,542 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file button_config.c
+ * @brief Implementation of the config-driven button table
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <linux/input.h>
+#include "../include/button_config.h"
+#include "../include/action_plugin.h"
+#include "../include/event_loop.h"
+#include "../include/journal.h"
+#include "../include/utils.h"
+
+#define CONFIG_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM)
+
+typedef struct button_rule {
+    gesture_t gesture;
+    char *device;                   /* fnmatch() pattern, NULL for any device */
+    unsigned int cooldown_ms;
+    action_t *action;
+    struct button_rule *next;       /* Next rule of the same key, in file order */
+    struct button_rule *next_all;   /* Every rule of the table, for teardown */
+} button_rule_t;
+
+typedef struct button_table {
+    unsigned int generation;
+    unsigned int rule_count;
+    button_rule_t *rules;
+    button_rule_t *any_key;         /* Rules for keys without rules of their own */
+    button_rule_t *keys[KEY_CNT];
+    struct button_table *next_retired;
+} button_table_t;
+
+static const struct {
+    const char *name;
+    int code;
+} key_names[] = {
+    { "KEY_WPS_BUTTON", KEY_WPS_BUTTON },
+    { "KEY_RESTART", KEY_RESTART },
+    { "KEY_POWER", KEY_POWER },
+    { "KEY_CONFIG", KEY_CONFIG },
+    { "KEY_WLAN", KEY_WLAN },
+    { "KEY_RFKILL", KEY_RFKILL },
+    { "KEY_VENDOR", KEY_VENDOR },
+    { "BTN_0", BTN_0 },
+    { "BTN_1", BTN_1 },
+    { "BTN_2", BTN_2 },
+};
+
+static const char *gesture_tokens[GESTURE_COUNT] = {
+    "short",
+    "long",
+    "double",
+};
+
+/*
+ * Behaviour of the daemon before config files existed; WPS sessions pace
+ * the wps action. Only the dedicated restart key resets: holding volume,
+ * power or any other key must never wipe the device.
+ */
+static const char default_config[] =
+    "* short wps\n"
+    "* double led-toggle\n"
+    "KEY_RESTART long cooldown=300000 factory-reset\n";
+
+/*
+ * Readers and the reload all run on the event loop thread, so a retired
+ * table has no readers left once it is unpublished. It is freed when the
+ * action worker no longer holds any of its actions.
+ */
+static button_table_t *current = NULL;
+static button_table_t *retired = NULL;
+static unsigned int generation = 0;
+static char *config_path = NULL;
+static int watch_fd = -1;
+
+static void free_table(button_table_t *table) {
+    button_rule_t *next;
+
+    for (button_rule_t *rule = table->rules; rule; rule = next) {
+        next = rule->next_all;
+        action_plugin_destroy_action(rule->action);
+        free(rule->device);
+        free(rule);
+    }
+
+    free(table);
+}
+
+static int table_busy(const button_table_t *table) {
+    for (const button_rule_t *rule = table->rules; rule; rule = rule->next_all) {
+        if (action_is_pending(rule->action)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void reclaim(int force) {
+    button_table_t **link = &retired;
+
+    while (*link) {
+        button_table_t *table = *link;
+
+        if (force || !table_busy(table)) {
+            *link = table->next_retired;
+            free_table(table);
+        } else {
+            link = &table->next_retired;
+        }
+    }
+}
+
+static void publish(button_table_t *table) {
+    button_table_t *old = current;
+
+    table->generation = ++generation;
+    __atomic_store_n(&current, table, __ATOMIC_RELEASE);
+
+    if (old) {
+        old->next_retired = retired;
+        retired = old;
+    }
+    reclaim(0);
+
+    journal_write(JOURNAL_CONFIG, 0, 0, (int)table->generation, JOURNAL_NO_ACTION, 0);
+    log_message(LOG_INFO, "Button table generation %u published with %u rules",
+                table->generation, table->rule_count);
+}
+
+static char *next_word(char **cursor) {
+    char *word = *cursor;
+    char *end;
+
+    while (isspace((unsigned char)*word)) {
+        word++;
+    }
+    if (*word == '\0') {
+        *cursor = word;
+        return NULL;
+    }
+
+    end = word;
+    while (*end && !isspace((unsigned char)*end)) {
+        end++;
+    }
+    *cursor = *end ? end + 1 : end;
+    *end = '\0';
+    return word;
+}
+
+static int parse_key(const char *word, int *code) {
+    char *end;
+    long value;
+
+    if (strcmp(word, "*") == 0) {
+        *code = -1;
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof(key_names) / sizeof(key_names[0]); i++) {
+        if (strcmp(word, key_names[i].name) == 0) {
+            *code = key_names[i].code;
+            return 0;
+        }
+    }
+
+    value = strtol(word, &end, 0);
+    if (*end != '\0' || value < 0 || value >= KEY_CNT) {
+        return -1;
+    }
+
+    *code = (int)value;
+    return 0;
+}
+
+static int parse_gesture(const char *word, gesture_t *gesture) {
+    for (int i = 0; i < GESTURE_COUNT; i++) {
+        if (strcmp(word, gesture_tokens[i]) == 0) {
+            *gesture = (gesture_t)i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+// Compile one line into a rule appended to the table
+static int compile_line(button_table_t *table, char *line) {
+    char *cursor = line;
+    char *word;
+    char *device = NULL;
+    unsigned long cooldown_ms = 0;
+    gesture_t gesture;
+    button_rule_t *rule;
+    button_rule_t **link;
+    size_t len;
+    int code;
+
+    if (!(word = next_word(&cursor)) || parse_key(word, &code) < 0) {
+        return -1;
+    }
+    if (!(word = next_word(&cursor)) || parse_gesture(word, &gesture) < 0) {
+        return -1;
+    }
+
+    // Options come before the action, which takes the rest of the line
+    for (;;) {
+        while (isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        if (strncmp(cursor, "device=", 7) == 0) {
+            device = next_word(&cursor) + 7;
+        } else if (strncmp(cursor, "cooldown=", 9) == 0) {
+            char *end;
+            word = next_word(&cursor) + 9;
+            cooldown_ms = strtoul(word, &end, 10);
+            if (*word == '\0' || *end != '\0') {
+                return -1;
+            }
+        } else {
+            break;
+        }
+    }
+
+    len = strlen(cursor);
+    while (len > 0 && isspace((unsigned char)cursor[len - 1])) {
+        cursor[--len] = '\0';
+    }
+    if (len == 0) {
+        return -1;
+    }
+
+    rule = calloc(1, sizeof(*rule));
+    if (!rule) {
+        return -1;
+    }
+
+    rule->gesture = gesture;
+    rule->cooldown_ms = (unsigned int)cooldown_ms;
+    rule->action = action_plugin_create_action(cursor, (unsigned int)cooldown_ms);
+    if (!rule->action || (device && !(rule->device = strdup(device)))) {
+        action_plugin_destroy_action(rule->action);
+        free(rule);
+        return -1;
+    }
+
+    rule->next_all = table->rules;
+    table->rules = rule;
+    table->rule_count++;
+
+    link = code < 0 ? &table->any_key : &table->keys[code];
+    while (*link) {
+        link = &(*link)->next;
+    }
+    *link = rule;
+    return 0;
+}
+
+static button_table_t *compile(FILE *f, const char *name) {
+    button_table_t *table = calloc(1, sizeof(*table));
+    char *line = NULL;
+    size_t size = 0;
+    int line_no = 0;
+
+    if (!table) {
+        return NULL;
+    }
+
+    while (getline(&line, &size, f) >= 0) {
+        char *start = line;
+
+        line_no++;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+
+        if (compile_line(table, start) < 0) {
+            log_message(LOG_ERR, "%s:%d: invalid button rule", name, line_no);
+            free(line);
+            free_table(table);
+            return NULL;
+        }
+    }
+
+    free(line);
+    return table;
+}
+
+// The built-in table is only a start-up default; losing the file later
+// must not swap it in over the table the file defined
+static button_table_t *load(const char *path, int startup) {
+    button_table_t *table;
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (!f && errno == ENOENT && startup) {
+        log_message(LOG_INFO, "No %s, using the built-in button table", path);
+        f = fmemopen((void *)default_config, sizeof(default_config) - 1, "r");
+        path = "built-in table";
+    }
+    if (!f) {
+        log_message(LOG_ERR, "Failed to open %s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    table = compile(f, path);
+    fclose(f);
+    return table;
+}
+
+static int reload(int startup) {
+    button_table_t *table = load(config_path, startup);
+
+    if (!table) {
+        if (!startup) {
+            log_message(LOG_WARNING, "Keeping button table generation %u", generation);
+        }
+        return -1;
+    }
+
+    publish(table);
+    return 0;
+}
+
+int button_config_reload(void) {
+    return reload(0);
+}
+
+static void config_changed(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const char *base = strrchr(config_path, '/') ? strrchr(config_path, '/') + 1 : config_path;
+    int changed = 0;
+    ssize_t len;
+
+    // Editors replace the file, so the directory is watched and filtered
+    while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (char *ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)ptr;
+            if ((ev->mask & IN_Q_OVERFLOW) || (ev->len > 0 && strcmp(ev->name, base) == 0)) {
+                changed = 1;
+            }
+            ptr += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+
+    if (changed) {
+        log_message(LOG_INFO, "%s changed, reloading button table", config_path);
+        button_config_reload();
+    }
+}
+
+static void watch_config(void) {
+    char *dir = strdup(config_path);
+    char *slash = dir ? strrchr(dir, '/') : NULL;
+
+    if (!dir) {
+        return;
+    }
+    if (slash) {
+        *(slash == dir ? slash + 1 : slash) = '\0';
+    }
+
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd < 0 || inotify_add_watch(watch_fd, slash ? dir : ".", CONFIG_WATCH_MASK) < 0 ||
+        event_loop_add(watch_fd, EPOLLIN, config_changed, NULL) < 0) {
+        log_message(LOG_WARNING, "Not watching %s for changes: %s", config_path, strerror(errno));
+        if (watch_fd >= 0) {
+            close(watch_fd);
+            watch_fd = -1;
+        }
+    }
+
+    free(dir);
+}
+
+int button_config_init(const char *path) {
+    config_path = strdup(path ? path : BUTTON_CONFIG_FILE);
+    if (!config_path || reload(1) < 0) {
+        free(config_path);
+        config_path = NULL;
+        return -1;
+    }
+
+    watch_config();
+    return 0;
+}
+
+void button_config_cleanup(void) {
+    if (watch_fd >= 0) {
+        event_loop_remove(watch_fd);
+        close(watch_fd);
+        watch_fd = -1;
+    }
+
+    if (current) {
+        current->next_retired = retired;
+        retired = current;
+        __atomic_store_n(&current, NULL, __ATOMIC_RELEASE);
+    }
+    reclaim(1);
+
+    free(config_path);
+    config_path = NULL;
+}
+
+static const button_rule_t *rules_for(const button_table_t *table, int button_code) {
+    if (button_code >= 0 && button_code < KEY_CNT && table->keys[button_code]) {
+        return table->keys[button_code];
+    }
+
+    return table->any_key;
+}
+
+static int device_matches(const button_rule_t *rule, const char *device) {
+    return !rule->device || fnmatch(rule->device, device, 0) == 0;
+}
+
+unsigned int button_config_gestures(const char *device, int button_code) {
+    const button_table_t *table = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+    unsigned int gestures = 0;
+
+    if (!table) {
+        return 0;
+    }
+
+    for (const button_rule_t *rule = rules_for(table, button_code); rule; rule = rule->next) {
+        if (device_matches(rule, device)) {
+            gestures |= GESTURE_BIT(rule->gesture);
+        }
+    }
+
+    return gestures;
+}
+
+void button_config_dispatch(const char *device, int button_code, gesture_t gesture,
+                            const struct timeval *timestamp) {
+    const button_table_t *table = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+
+    if (retired) {
+        reclaim(0);
+    }
+    if (!table) {
+        return;
+    }
+
+    for (const button_rule_t *rule = rules_for(table, button_code); rule; rule = rule->next) {
+        if (rule->gesture == gesture && device_matches(rule, device)) {
+            action_queue_submit(rule->action, device, button_code, timestamp);
+        }
+    }
+}
+
+static void dump_rules(FILE *f, const button_rule_t *rule, int button_code) {
+    const char *key = button_code < 0 ? "*" : NULL;
+
+    for (size_t i = 0; !key && i < sizeof(key_names) / sizeof(key_names[0]); i++) {
+        if (key_names[i].code == button_code) {
+            key = key_names[i].name;
+        }
+    }
+
+    for (; rule; rule = rule->next) {
+        if (key) {
+            fprintf(f, "%s", key);
+        } else {
+            fprintf(f, "%d", button_code);
+        }
+        fprintf(f, " %s", gesture_tokens[rule->gesture]);
+        if (rule->device) {
+            fprintf(f, " device=%s", rule->device);
+        }
+        if (rule->cooldown_ms) {
+            fprintf(f, " cooldown=%u", rule->cooldown_ms);
+        }
+        fprintf(f, " %s\n", action_get_name(rule->action));
+    }
+}
+
+void button_config_dump(FILE *f) {
+    const button_table_t *table = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+
+    if (!table) {
+        return;
+    }
+
+    fprintf(f, "# %s, generation %u, %u rules\n", config_path, table->generation, table->rule_count);
+    for (int code = 0; code < KEY_CNT; code++) {
+        dump_rules(f, table->keys[code], code);
+    }
+    dump_rules(f, table->any_key, -1);
+}
+
+unsigned int button_config_generation(void) {
+    const button_table_t *table = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+
+    return table ? table->generation : 0;
+}
+
+int button_config_key_code(const char *name) {
+    int code;
+
+    if (!name || parse_key(name, &code) < 0 || code < 0) {
+        return -1;
+    }
+    return code;
+}
@@ -0,0 +1,678 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file control_socket.c
+ * @brief Implementation of the control socket
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/un.h>
+#include "../include/control_socket.h"
+#include "../include/action_queue.h"
+#include "../include/button_bus.h"
+#include "../include/button_callback.h"
+#include "../include/button_config.h"
+#include "../include/device_monitor.h"
+#include "../include/event_filter.h"
+#include "../include/event_loop.h"
+#include "../include/gesture.h"
+#include "../include/gpio_source.h"
+#include "../include/hotplug_monitor.h"
+#include "../include/latency.h"
+#include "../include/uring_reader.h"
+#include "../include/utils.h"
+#include "../include/wps_session.h"
+
+#define SIMULATED_DEVICE "control"
+#define WATCH_CAPACITY 64
+
+typedef struct {
+    int fd;                         /* -1 if the slot is free */
+    char line[CONTROL_LINE_MAX];
+    size_t line_len;
+    char *out;                      /* Output not written yet */
+    size_t out_len;
+    size_t out_off;
+    int closing;                    /* Close once the output is written */
+    button_bus_subscriber_t *watch; /* Bus events streamed to the client */
+} control_client_t;
+
+typedef const char *(*command_handler)(FILE *out, char *args);
+
+// Only touched on the event loop thread
+static control_client_t clients[CONTROL_MAX_CLIENTS];
+static int listen_fd = -1;
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static control_client_t *command_client = NULL; /* Client whose command is running */
+
+static int flush_client(control_client_t *c);
+
+// Output queues up behind earlier output of the same client; takes buf
+static void append_output(control_client_t *c, char *buf, size_t len) {
+    if (c->out) {
+        char *joined = realloc(c->out, c->out_len + len);
+        if (joined) {
+            memcpy(joined + c->out_len, buf, len);
+            c->out = joined;
+            c->out_len += len;
+        }
+        free(buf);
+    } else {
+        c->out = buf;
+        c->out_len = len;
+        c->out_off = 0;
+    }
+}
+
+static void print_device(const input_device_t *dev, void *ctx) {
+    FILE *out = (FILE *)ctx;
+
+    fprintf(out, "%s %u:%u generation %lu key_events %lu\n", dev->device_path,
+            major(dev->devt), minor(dev->devt), dev->generation, dev->key_events);
+}
+
+static void print_gpio_line(const gpio_line_info_t *line, void *ctx) {
+    FILE *out = (FILE *)ctx;
+
+    fprintf(out, "gpio %s %u:%u code %d %s key_events %lu lost %lu\n", line->device,
+            major(line->devt), minor(line->devt), line->code,
+            !line->requested ? "unrequested" : line->hte ? "hte" : "monotonic",
+            line->key_events, line->lost);
+}
+
+static const char *cmd_devices(FILE *out, char *args) {
+    int lines;
+
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    fprintf(out, "%d devices\n", device_monitor_foreach(print_device, out));
+    lines = gpio_source_foreach(print_gpio_line, out);
+    if (lines > 0) {
+        fprintf(out, "%d gpio lines\n", lines);
+    }
+    return NULL;
+}
+
+static void count_device(const input_device_t *dev, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)dev;
+    (void)ctx;
+}
+
+static const char *cmd_stats(FILE *out, char *args) {
+    action_queue_stats_t queue;
+    hotplug_stats_t hotplug;
+    uring_reader_stats_t ring;
+    event_filter_stats_t filter;
+    wps_session_stats_t wps;
+
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    action_queue_get_stats(&queue);
+    hotplug_monitor_get_stats(&hotplug);
+    event_filter_get_stats(&filter);
+    wps_session_get_stats(&wps);
+
+    fprintf(out, "devices %d\n", device_monitor_foreach(count_device, NULL));
+    fprintf(out, "queue depth %u max_depth %u capacity %u submitted %lu executed %lu coalesced %lu dropped %lu\n",
+            queue.depth, queue.max_depth, queue.capacity, queue.submitted, queue.executed,
+            queue.coalesced, queue.dropped);
+    fprintf(out, "hotplug accepted %lu dropped %lu coalesced %lu overflows %lu resyncs %lu\n",
+            hotplug.accepted, hotplug.dropped, hotplug.coalesced, hotplug.overflows, hotplug.resyncs);
+    fprintf(out, "filter passed %lu debounced %lu settled %lu deduplicated %lu untracked %lu\n",
+            filter.passed, filter.debounced, filter.settled, filter.deduplicated, filter.untracked);
+    fprintf(out, "wps %s for %.1f s sessions %lu succeeded %lu timed_out %lu failed %lu extended %lu ignored %lu\n",
+            wps_session_state_name(wps.state), wps.state_ns / 1e9, wps.sessions, wps.succeeded,
+            wps.timed_out, wps.failed, wps.extended, wps.ignored);
+    fprintf(out, "loop wakeups %lu\n", event_loop_get_wakeups());
+    if (uring_reader_enabled()) {
+        uring_reader_get_stats(&ring);
+        fprintf(out, "io_uring completions %lu submits %lu stalls %lu\n",
+                ring.completions, ring.submits, ring.stalls);
+    }
+    fprintf(out, "log dropped %lu\n", log_get_dropped());
+    fprintf(out, "config generation %u\n", button_config_generation());
+    return NULL;
+}
+
+static const char *cmd_latency(FILE *out, char *args) {
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    latency_dump(out);
+    return NULL;
+}
+
+static const char *cmd_config(FILE *out, char *args) {
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    button_config_dump(out);
+    return NULL;
+}
+
+static const char *cmd_reload(FILE *out, char *args) {
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    if (button_config_reload() < 0) {
+        return "config missing or not valid, table unchanged";
+    }
+
+    fprintf(out, "generation %u\n", button_config_generation());
+    return NULL;
+}
+
+static const char *cmd_debug(FILE *out, char *args) {
+    if (strcmp(args, "on") == 0) {
+        set_debug_mode(true);
+    } else if (strcmp(args, "off") == 0) {
+        set_debug_mode(false);
+    } else if (*args) {
+        return "usage: debug [on|off]";
+    }
+
+    fprintf(out, "debug %s\n", get_debug_mode() ? "on" : "off");
+    return NULL;
+}
+
+static const char *cmd_filter(FILE *out, char *args) {
+    event_filter_config_t config;
+    unsigned int ms;
+    char rule[16];
+
+    event_filter_get_config(&config);
+    if (*args) {
+        if (sscanf(args, "%15s %u", rule, &ms) != 2 || ms > 10000) {
+            return "usage: filter [debounce|dedupe <ms>]";
+        }
+        if (strcmp(rule, "debounce") == 0) {
+            config.debounce_ms = ms;
+        } else if (strcmp(rule, "dedupe") == 0) {
+            config.dedupe_ms = ms;
+        } else {
+            return "usage: filter [debounce|dedupe <ms>]";
+        }
+        event_filter_set_config(&config);
+        event_filter_get_config(&config);
+    }
+
+    fprintf(out, "debounce %u ms dedupe %u ms\n", config.debounce_ms, config.dedupe_ms);
+    return NULL;
+}
+
+static const char *cmd_rescan(FILE *out, char *args) {
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    device_monitor_resync();
+    fprintf(out, "%d devices\n", device_monitor_foreach(count_device, NULL));
+    return NULL;
+}
+
+// Feed an event through the same callback as real input
+static void inject(const char *device, int code, int value) {
+    button_callback callback = get_button_callback();
+    struct timespec now;
+    struct timeval tv;
+
+    // Input events are stamped with CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    tv.tv_sec = now.tv_sec;
+    tv.tv_usec = now.tv_nsec / 1000;
+
+    if (callback) {
+        callback(device, code, value, &tv);
+    }
+    button_bus_publish(device, code, value, &tv);
+}
+
+static int parse_key_args(char *args, int *code, int *value, const char **device) {
+    char device_name[CONTROL_LINE_MAX];
+    int fields;
+
+    device_name[0] = '\0';
+    if (value) {
+        fields = sscanf(args, "%i %i %255s", code, value, device_name);
+        if (fields < 2) {
+            return -1;
+        }
+    } else {
+        fields = sscanf(args, "%i %255s", code, device_name);
+        if (fields < 1) {
+            return -1;
+        }
+    }
+
+    if (*code < 0 || *code > 0x2ff) {
+        return -1;
+    }
+
+    // The name lives in args, which outlives the command
+    *device = SIMULATED_DEVICE;
+    if (device_name[0]) {
+        char *name = strstr(args, device_name);
+        name[strlen(device_name)] = '\0';
+        *device = name;
+    }
+    return 0;
+}
+
+static const char *cmd_press(FILE *out, char *args) {
+    const char *device;
+    int code;
+
+    if (parse_key_args(args, &code, NULL, &device) < 0) {
+        return "usage: press <code> [device]";
+    }
+
+    inject(device, code, 1);
+    inject(device, code, 0);
+    fprintf(out, "pressed %d on %s\n", code, device);
+    return NULL;
+}
+
+static const char *cmd_key(FILE *out, char *args) {
+    const char *device;
+    int code;
+    int value;
+
+    if (parse_key_args(args, &code, &value, &device) < 0 || value < 0 || value > 2) {
+        return "usage: key <code> <0|1|2> [device]";
+    }
+
+    inject(device, code, value);
+    fprintf(out, "key %d = %d on %s\n", code, value, device);
+    return NULL;
+}
+
+static void print_subscriber(const button_bus_stats_t *stats, void *ctx) {
+    FILE *out = (FILE *)ctx;
+
+    fprintf(out, "%s %s depth %u max_depth %u capacity %u delivered %lu dropped %lu lag_us %.1f max_lag_us %.1f\n",
+            stats->name, stats->delivery == BUTTON_BUS_LOOP ? "loop" : "thread", stats->depth,
+            stats->max_depth, stats->capacity, stats->delivered, stats->dropped,
+            stats->last_lag_ns / 1000.0, stats->max_lag_ns / 1000.0);
+}
+
+static const char *cmd_bus(FILE *out, char *args) {
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    fprintf(out, "%d subscribers\n", button_bus_foreach(print_subscriber, out));
+    return NULL;
+}
+
+// A client that does not read only fills its own ring; events then drop
+static void watch_event(const button_event_t *event, void *ctx) {
+    control_client_t *c = (control_client_t *)ctx;
+    char *line;
+    int len;
+
+    if (event->type == BUTTON_EVENT_GESTURE) {
+        len = asprintf(&line, "gesture %s %d %ld.%06ld %s\n", event->device, event->code,
+                       (long)event->timestamp.tv_sec, (long)event->timestamp.tv_usec,
+                       gesture_name((gesture_t)event->value));
+    } else {
+        len = asprintf(&line, "event %s %d %d %ld.%06ld\n", event->device, event->code, event->value,
+                       (long)event->timestamp.tv_sec, (long)event->timestamp.tv_usec);
+    }
+    if (len < 0) {
+        return;
+    }
+    append_output(c, line, (size_t)len);
+
+    if (flush_client(c) < 0) {
+        c->closing = 1;
+    }
+    if (c->out) {
+        button_bus_pause(c->watch, 1);
+        event_loop_modify(c->fd, EPOLLOUT);
+    }
+}
+
+static const char *cmd_watch(FILE *out, char *args) {
+    control_client_t *c = command_client;
+    char name[32];
+
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    if (c->watch) {
+        return "already watching";
+    }
+
+    snprintf(name, sizeof(name), "watch:%d", c->fd);
+    c->watch = button_bus_subscribe(name, BUTTON_BUS_LOOP, WATCH_CAPACITY, watch_event, c);
+    if (!c->watch) {
+        return "too many subscribers";
+    }
+
+    fprintf(out, "watching, events follow as: event <device> <code> <value> <timestamp>"
+                 " or gesture <device> <code> <timestamp> <gesture>\n");
+    return NULL;
+}
+
+static const char *cmd_unwatch(FILE *out, char *args) {
+    control_client_t *c = command_client;
+
+    /* Prevent unused parameter warning */
+    (void)out;
+    (void)args;
+
+    if (!c->watch) {
+        return "not watching";
+    }
+
+    button_bus_unsubscribe(c->watch);
+    c->watch = NULL;
+    return NULL;
+}
+
+static const char *cmd_help(FILE *out, char *args);
+
+static const struct {
+    const char *name;
+    command_handler handler;
+    const char *help;
+} commands[] = {
+    { "devices", cmd_devices, "monitored devices and GPIO lines with their key event counts" },
+    { "stats", cmd_stats, "action queue, hotplug, filter, WPS session, loop and log counters" },
+    { "latency", cmd_latency, "per-stage latency histograms" },
+    { "config", cmd_config, "the published button table" },
+    { "reload", cmd_reload, "reload the button table now" },
+    { "debug", cmd_debug, "[on|off] show or set debug logging" },
+    { "filter", cmd_filter, "[debounce|dedupe <ms>] show or set the key event filter windows" },
+    { "rescan", cmd_rescan, "resync monitored devices with the input directory" },
+    { "press", cmd_press, "<code> [device] simulate a press and release" },
+    { "key", cmd_key, "<code> <0|1|2> [device] simulate a single key event" },
+    { "bus", cmd_bus, "key event bus subscribers with their lag and drop counters" },
+    { "watch", cmd_watch, "stream key events and gestures to this client" },
+    { "unwatch", cmd_unwatch, "stop streaming events" },
+    { "help", cmd_help, "this list" },
+};
+
+static const char *cmd_help(FILE *out, char *args) {
+    /* Prevent unused parameter warning */
+    (void)args;
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        fprintf(out, "%-8s %s\n", commands[i].name, commands[i].help);
+    }
+    return NULL;
+}
+
+static void close_client(control_client_t *c) {
+    button_bus_unsubscribe(c->watch);
+    event_loop_remove(c->fd);
+    close(c->fd);
+    free(c->out);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+static void run_command(control_client_t *c, char *line) {
+    const char *error = "unknown command, try help";
+    char *args = line + strcspn(line, " \t");
+    size_t name_len = (size_t)(args - line);
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *out;
+
+    args += strspn(args, " \t");
+
+    out = open_memstream(&buf, &len);
+    if (!out) {
+        c->closing = 1;
+        return;
+    }
+
+    command_client = c;
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strlen(commands[i].name) == name_len && strncmp(line, commands[i].name, name_len) == 0) {
+            error = commands[i].handler(out, args);
+            break;
+        }
+    }
+    command_client = NULL;
+
+    if (error) {
+        fprintf(out, "ERROR %s\n", error);
+    } else {
+        fprintf(out, "OK\n");
+    }
+    fclose(out);
+
+    append_output(c, buf, len);
+}
+
+// Returns -1 if the client went away
+static int flush_client(control_client_t *c) {
+    while (c->out && c->out_off < c->out_len) {
+        // A client that hung up must not take the daemon down with SIGPIPE
+        ssize_t n = send(c->fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN ? 0 : -1;
+        }
+        c->out_off += (size_t)n;
+    }
+
+    free(c->out);
+    c->out = NULL;
+    c->out_len = 0;
+    c->out_off = 0;
+    return 0;
+}
+
+// Split buffered input into commands; stops while output is pending
+static void process_lines(control_client_t *c) {
+    char *nl;
+
+    while (!c->out && !c->closing && (nl = memchr(c->line, '\n', c->line_len))) {
+        size_t consumed = (size_t)(nl - c->line) + 1;
+
+        *nl = '\0';
+        if (nl > c->line && nl[-1] == '\r') {
+            nl[-1] = '\0';
+        }
+        if (c->line[0]) {
+            run_command(c, c->line);
+        }
+
+        memmove(c->line, c->line + consumed, c->line_len - consumed);
+        c->line_len -= consumed;
+
+        if (flush_client(c) < 0) {
+            c->closing = 1;
+        }
+    }
+}
+
+static void client_event(int fd, uint32_t events, void *ctx) {
+    control_client_t *c = (control_client_t *)ctx;
+    ssize_t n;
+
+    if (events & EPOLLOUT) {
+        if (flush_client(c) < 0) {
+            close_client(c);
+            return;
+        }
+        if (c->watch && !c->out && !c->closing) {
+            button_bus_pause(c->watch, 0);
+        }
+        process_lines(c);
+    }
+
+    while (!c->out && !c->closing && (events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+        n = read(fd, c->line + c->line_len, sizeof(c->line) - c->line_len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                c->closing = 1;
+            }
+            break;
+        }
+        if (n == 0) {
+            c->closing = 1;
+            break;
+        }
+
+        c->line_len += (size_t)n;
+        process_lines(c);
+
+        if (c->line_len == sizeof(c->line)) {
+            log_message(LOG_WARNING, "Control command too long, disconnecting client");
+            c->closing = 1;
+        }
+    }
+
+    if (c->closing && !c->out) {
+        close_client(c);
+        return;
+    }
+
+    // Only wait for writability while output is pending
+    event_loop_modify(fd, c->out ? EPOLLOUT : EPOLLIN);
+}
+
+static void accept_clients(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+    control_client_t *c;
+    int client_fd;
+
+    for (;;) {
+        client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                log_message(LOG_WARNING, "Failed to accept control client: %s", strerror(errno));
+            }
+            return;
+        }
+
+        c = NULL;
+        for (int i = 0; i < CONTROL_MAX_CLIENTS && !c; i++) {
+            if (clients[i].fd < 0) {
+                c = &clients[i];
+            }
+        }
+
+        if (!c) {
+            static const char busy[] = "ERROR too many clients\n";
+            if (write(client_fd, busy, sizeof(busy) - 1) < 0) {
+                /* Closing anyway */
+            }
+            close(client_fd);
+            continue;
+        }
+
+        c->fd = client_fd;
+        if (event_loop_add(client_fd, EPOLLIN, client_event, c) < 0) {
+            close(client_fd);
+            c->fd = -1;
+        }
+    }
+}
+
+int control_socket_init(const char *path) {
+    struct sockaddr_un addr;
+
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+        memset(&clients[i], 0, sizeof(clients[i]));
+        clients[i].fd = -1;
+    }
+
+    if (!path) {
+        path = CONTROL_SOCKET_PATH;
+    }
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        log_message(LOG_ERR, "Control socket path too long: %s", path);
+        return -1;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        log_message(LOG_ERR, "Failed to create control socket: %s", strerror(errno));
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    // A stale socket from an earlier run would make bind fail
+    unlink(path);
+
+    // daemonize() clears the umask; create the node owner-only so no other
+    // user can connect between bind and chmod
+    mode_t old_umask = umask(S_IRWXG | S_IRWXO);
+    int bound = bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_umask);
+
+    if (bound < 0 ||
+        chmod(path, S_IRUSR | S_IWUSR) < 0 ||
+        listen(listen_fd, CONTROL_MAX_CLIENTS) < 0 ||
+        event_loop_add(listen_fd, EPOLLIN, accept_clients, NULL) < 0) {
+        log_message(LOG_ERR, "Failed to set up control socket %s: %s", path, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+
+    snprintf(socket_path, sizeof(socket_path), "%s", path);
+    log_message(LOG_INFO, "Control socket listening on %s", path);
+    return 0;
+}
+
+void control_socket_cleanup(void) {
+    for (int i = 0; i < CONTROL_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            close_client(&clients[i]);
+        }
+    }
+
+    if (listen_fd >= 0) {
+        event_loop_remove(listen_fd);
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+    }
+}
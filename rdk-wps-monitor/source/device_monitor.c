@@ -30,110 +30,465 @@
 #include <errno.h>
 #include <syslog.h>
 #include <dirent.h>
+#include <pthread.h>
 #include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include "../include/device_monitor.h"
-#include "../include/button_callback.h"
+#include "../include/event_filter.h"
+#include "../include/event_loop.h"
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/uring_reader.h"
 #include "../include/utils.h"
 
-// Thread management
-static pthread_t device_threads[MAX_INPUT_DEVICES];
-static device_thread_data_t thread_data[MAX_INPUT_DEVICES];
-static int num_device_threads = 0;
-static pthread_mutex_t thread_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define SYSFS_INPUT_CLASS "/sys/class/input"
+#define BITS_PER_ULONG (8 * sizeof(unsigned long))
+
+/*
+ * Device registry: a chained hash table indexed both by dev_t and by path,
+ * protected by device_mutex.
+ */
+typedef struct registry_table {
+    size_t mask;
+    input_device_t **by_devt;
+    input_device_t **by_path;
+    input_device_t *buckets[];
+} registry_table_t;
+
+static registry_table_t *registry = NULL;
+static size_t num_devices = 0;
+static unsigned long registry_generation = 0;
+static pthread_mutex_t device_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Directory scanned for evdev nodes
+static const char *input_dir = INPUT_DEVICE_DIR;
+
+// Devices must be able to emit one of these keys; none means all devices
+static int watched_keys[MAX_WATCHED_KEYS] = { KEY_WPS_BUTTON, BTN_0, KEY_RESTART };
+static int num_watched_keys = 3;
+
+// Set while scan_existing_devices() runs, on the thread that runs it
+static int scanning = 0;
+
+// A scan lists every device once; hotplug storms stay rate limited
+#define log_device(level, ...) \
+    do { \
+        if (scanning) { \
+            log_listing((level), __VA_ARGS__); \
+        } else { \
+            log_message((level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+static size_t hash_devt(dev_t devt) {
+    return (size_t)(((uint64_t)devt * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+// FNV-1a
+static size_t hash_path(const char *path) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    while (*path) {
+        hash = (hash ^ (unsigned char)*path++) * 0x100000001b3ULL;
+    }
+
+    return (size_t)hash;
+}
+
+static registry_table_t *registry_table_alloc(size_t nbuckets) {
+    registry_table_t *table = calloc(1, sizeof(*table) + 2 * nbuckets * sizeof(input_device_t *));
+
+    if (!table) {
+        return NULL;
+    }
+
+    table->mask = nbuckets - 1;
+    table->by_devt = table->buckets;
+    table->by_path = table->buckets + nbuckets;
+    return table;
+}
+
+// Must be called with device_mutex held
+static input_device_t *lookup_devt(const registry_table_t *table, dev_t devt) {
+    input_device_t *dev = table->by_devt[hash_devt(devt) & table->mask];
+
+    while (dev && dev->devt != devt) {
+        dev = dev->next_devt;
+    }
+
+    return dev;
+}
+
+// Must be called with device_mutex held
+static input_device_t *lookup_path(const registry_table_t *table, const char *device_path) {
+    input_device_t *dev = table->by_path[hash_path(device_path) & table->mask];
+
+    while (dev && strcmp(dev->device_path, device_path) != 0) {
+        dev = dev->next_path;
+    }
+
+    return dev;
+}
+
+static void link_device(registry_table_t *table, input_device_t *dev) {
+    input_device_t **devt_head = &table->by_devt[hash_devt(dev->devt) & table->mask];
+    input_device_t **path_head = &table->by_path[hash_path(dev->device_path) & table->mask];
+
+    dev->next_devt = *devt_head;
+    *devt_head = dev;
+    dev->next_path = *path_head;
+    *path_head = dev;
+}
+
+static void unlink_device(registry_table_t *table, input_device_t *dev) {
+    input_device_t **link = &table->by_devt[hash_devt(dev->devt) & table->mask];
+
+    while (*link && *link != dev) {
+        link = &(*link)->next_devt;
+    }
+    if (*link) {
+        *link = dev->next_devt;
+    }
+
+    link = &table->by_path[hash_path(dev->device_path) & table->mask];
+    while (*link && *link != dev) {
+        link = &(*link)->next_path;
+    }
+    if (*link) {
+        *link = dev->next_path;
+    }
+}
+
+// Double the bucket count; device_mutex held
+static int registry_grow(void) {
+    registry_table_t *old = registry;
+    registry_table_t *table = registry_table_alloc(2 * (old->mask + 1));
+
+    if (!table) {
+        return -1;
+    }
+
+    for (size_t i = 0; i <= old->mask; i++) {
+        for (input_device_t *dev = old->by_devt[i]; dev; ) {
+            input_device_t *next = dev->next_devt;
+            link_device(table, dev);
+            dev = next;
+        }
+    }
+
+    registry = table;
+    free(old);
+    return 0;
+}
 
 int device_monitor_init(void) {
-    // Initialize thread data
-    for (int i = 0; i < MAX_INPUT_DEVICES; i++) {
-        thread_data[i].device_path = NULL;
-        thread_data[i].thread_active = 0;
+    pthread_mutex_lock(&device_mutex);
+
+    if (!registry) {
+        registry = registry_table_alloc(DEVICE_REGISTRY_INITIAL_BUCKETS);
+    }
+
+    pthread_mutex_unlock(&device_mutex);
+
+    if (!registry) {
+        log_message(LOG_ERR, "Out of memory allocating device registry");
+        return -1;
+    }
+
+    // Presses still get through unfiltered without it
+    event_filter_init();
+    return 0;
+}
+
+// Stop monitoring, unlink and free the record. Must be called with device_mutex held
+static void release_device(input_device_t *dev) {
+    if (dev->fd >= 0) {
+        if (dev->via_ring) {
+            uring_reader_remove(dev->fd);
+        } else {
+            event_loop_remove(dev->fd);
+        }
+        close(dev->fd);
+        dev->fd = -1;
+    }
+
+    unlink_device(registry, dev);
+    num_devices--;
+    event_filter_forget(dev->devt);
+    journal_write(JOURNAL_DEVICE_REMOVE, dev->devt, 0, 0, JOURNAL_NO_ACTION, 0);
+
+    free(dev->device_path);
+    free(dev);
+}
+
+void device_monitor_set_input_dir(const char *dir) {
+    input_dir = dir ? dir : INPUT_DEVICE_DIR;
+}
+
+const char *device_monitor_get_input_dir(void) {
+    return input_dir;
+}
+
+int device_monitor_set_watched_keys(const int *codes, int count) {
+    if (count < 0 || count > MAX_WATCHED_KEYS || (count > 0 && !codes)) {
+        return -1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        watched_keys[i] = codes[i];
+    }
+    num_watched_keys = count;
+    
+    return 0;
+}
+
+static int has_watched_key(const unsigned long *bits, size_t nlongs) {
+    for (int i = 0; i < num_watched_keys; i++) {
+        size_t word = (size_t)watched_keys[i] / BITS_PER_ULONG;
+        
+        if (word < nlongs && (bits[word] >> (watched_keys[i] % BITS_PER_ULONG)) & 1UL) {
+            return 1;
+        }
     }
     
     return 0;
 }
 
+/*
+ * Check the key capabilities sysfs publishes for an evdev node without
+ * opening it. The bitmap is printed as hex longs, most significant first.
+ * Returns 1 if a watched key is present, 0 if not, -1 if unknown.
+ */
+static int sysfs_has_watched_key(const char *device_path) {
+    unsigned long bits[KEY_STATE_LONGS];
+    char path[512];
+    char line[1024];
+    const char *name = strrchr(device_path, '/');
+    char *token;
+    char *save = NULL;
+    char *words[KEY_STATE_LONGS];
+    size_t nwords = 0;
+    FILE *f;
+    
+    name = name ? name + 1 : device_path;
+    if (snprintf(path, sizeof(path), "%s/%s/device/capabilities/key", SYSFS_INPUT_CLASS, name) >= (int)sizeof(path)) {
+        return -1;
+    }
+    
+    f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    
+    if (!fgets(line, sizeof(line), f)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    
+    for (token = strtok_r(line, " \n", &save); token && nwords < KEY_STATE_LONGS;
+         token = strtok_r(NULL, " \n", &save)) {
+        words[nwords++] = token;
+    }
+    
+    // The last word holds the lowest key codes
+    memset(bits, 0, sizeof(bits));
+    for (size_t i = 0; i < nwords; i++) {
+        bits[i] = strtoul(words[nwords - 1 - i], NULL, 16);
+    }
+    
+    return has_watched_key(bits, nwords);
+}
+
+// Confirm key capabilities on an open node; -1 if it is not an evdev node
+static int evdev_has_watched_key(int fd) {
+    unsigned long bits[KEY_STATE_LONGS];
+    
+    memset(bits, 0, sizeof(bits));
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(bits)), bits) < 0) {
+        return -1;
+    }
+    
+    return has_watched_key(bits, KEY_STATE_LONGS);
+}
+
 void device_monitor_cleanup(void) {
-    pthread_mutex_lock(&thread_mutex);
-    
-    for (int i = 0; i < num_device_threads; i++) {
-        if (thread_data[i].thread_active) {
-            thread_data[i].thread_active = 0;
-            pthread_mutex_unlock(&thread_mutex);
-            pthread_join(device_threads[i], NULL);
-            pthread_mutex_lock(&thread_mutex);
-            
-            if (thread_data[i].device_path) {
-                free(thread_data[i].device_path);
-                thread_data[i].device_path = NULL;
+    pthread_mutex_lock(&device_mutex);
+    
+    if (registry) {
+        for (size_t i = 0; i <= registry->mask; i++) {
+            while (registry->by_devt[i]) {
+                log_listing(LOG_INFO, "Stopped monitoring device: %s", registry->by_devt[i]->device_path);
+                release_device(registry->by_devt[i]);
             }
         }
+        
+        free(registry);
+        registry = NULL;
     }
     
-    pthread_mutex_unlock(&thread_mutex);
+    pthread_mutex_unlock(&device_mutex);
+    
+    event_filter_cleanup();
+}
+
+int device_monitor_contains(dev_t devt) {
+    int found;
+    
+    pthread_mutex_lock(&device_mutex);
+    found = registry && lookup_devt(registry, devt) != NULL;
+    pthread_mutex_unlock(&device_mutex);
+    
+    return found;
+}
+
+// evdev nodes are keyed by device number, FIFOs replaying evdev streams by inode
+static dev_t device_key(const struct stat *st) {
+    return S_ISCHR(st->st_mode) ? st->st_rdev : makedev(0, (unsigned int)st->st_ino);
 }
 
 int add_input_device(const char *device_path) {
-    int i;
-    pthread_mutex_lock(&thread_mutex);
-    
-    // Check if this device is already being monitored
-    for (i = 0; i < num_device_threads; i++) {
-        if (thread_data[i].thread_active && 
-            strcmp(thread_data[i].device_path, device_path) == 0) {
-            pthread_mutex_unlock(&thread_mutex);
-            return 0; // Already monitoring this device
-        }
+    input_device_t *dev;
+    struct stat st;
+    int clock_id;
+    int fd;
+    
+    // Cheap duplicate check before anything is opened; repeated uevents
+    // and rescans mostly name devices that are already monitored
+    if (stat(device_path, &st) == 0 && device_monitor_contains(device_key(&st))) {
+        return 0;
     }
     
-    // Find an available slot
-    for (i = 0; i < MAX_INPUT_DEVICES; i++) {
-        if (!thread_data[i].thread_active) {
-            break;
-        }
+    // Skip nodes that cannot emit any watched key without opening them
+    if (num_watched_keys > 0 && sysfs_has_watched_key(device_path) == 0) {
+        log_device(LOG_INFO, "Skipping %s: no monitored button capabilities", device_path);
+        return 0;
     }
     
-    if (i == MAX_INPUT_DEVICES) {
-        log_message(LOG_ERR, "Maximum number of monitored devices reached");
-        pthread_mutex_unlock(&thread_mutex);
+    // Open the input device
+    fd = open(device_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        log_message(LOG_ERR, "Error opening device %s: %s", device_path, strerror(errno));
         return -1;
     }
     
-    // Set up the thread data
-    thread_data[i].device_path = strdup(device_path);
-    thread_data[i].thread_active = 1;
+    if (fstat(fd, &st) < 0 || (!S_ISCHR(st.st_mode) && !S_ISFIFO(st.st_mode))) {
+        log_message(LOG_ERR, "Not a character device or FIFO: %s", device_path);
+        close(fd);
+        return -1;
+    }
+    
+    if (num_watched_keys > 0 && evdev_has_watched_key(fd) == 0) {
+        log_device(LOG_INFO, "Skipping %s: no monitored button capabilities", device_path);
+        close(fd);
+        return 0;
+    }
     
-    // Create the monitoring thread
-    if (pthread_create(&device_threads[i], NULL, device_monitor_thread, &thread_data[i]) != 0) {
-        log_message(LOG_ERR, "Failed to create monitoring thread for %s", device_path);
-        free(thread_data[i].device_path);
-        thread_data[i].device_path = NULL;
-        thread_data[i].thread_active = 0;
-        pthread_mutex_unlock(&thread_mutex);
+    // Timestamp events on the clock latencies are measured with
+    clock_id = CLOCK_MONOTONIC;
+    if (S_ISCHR(st.st_mode) && ioctl(fd, EVIOCSCLOCKID, &clock_id) < 0) {
+        log_message(LOG_WARNING, "Failed to select monotonic timestamps on %s: %s", device_path, strerror(errno));
+    }
+    
+    dev = calloc(1, sizeof(*dev));
+    if (!dev || !(dev->device_path = strdup(device_path))) {
+        log_message(LOG_ERR, "Out of memory adding device %s", device_path);
+        free(dev);
+        close(fd);
         return -1;
     }
+    dev->devt = device_key(&st);
+    dev->fd = fd;
     
-    if (i >= num_device_threads) {
-        num_device_threads = i + 1;
+    // Seed the key state so a later resync only reports real changes
+    if (ioctl(fd, EVIOCGKEY(sizeof(dev->key_state)), dev->key_state) < 0) {
+        memset(dev->key_state, 0, sizeof(dev->key_state));
     }
     
-    pthread_mutex_unlock(&thread_mutex);
-    return 0;
+    pthread_mutex_lock(&device_mutex);
+    
+    // Another path may have registered the same node meanwhile
+    if (!registry || lookup_devt(registry, dev->devt) || lookup_path(registry, device_path)) {
+        pthread_mutex_unlock(&device_mutex);
+        free(dev->device_path);
+        free(dev);
+        close(fd);
+        return registry ? 0 : -1;
+    }
+    
+    // The ring takes the device when it is set up and has room
+    dev->via_ring = uring_reader_enabled() && uring_reader_add(fd, device_monitor_handle_read, dev) == 0;
+    if (!dev->via_ring && event_loop_add(fd, EPOLLIN, device_monitor_handle_event, dev) < 0) {
+        pthread_mutex_unlock(&device_mutex);
+        log_message(LOG_ERR, "Failed to start monitoring %s", device_path);
+        free(dev->device_path);
+        free(dev);
+        close(fd);
+        return -1;
+    }
+    
+    dev->generation = ++registry_generation;
+    
+    // Keep chains short; a failed grow only costs lookup time
+    if (num_devices + 1 > registry->mask + 1) {
+        registry_grow();
+    }
+    link_device(registry, dev);
+    num_devices++;
+    
+    pthread_mutex_unlock(&device_mutex);
+    
+    journal_write(JOURNAL_DEVICE_ADD, dev->devt, 0, 0, JOURNAL_NO_ACTION, 0);
+    log_device(LOG_INFO, "Started monitoring device: %s (%u:%u)", device_path,
+                major(dev->devt), minor(dev->devt));
+    return 1;
 }
 
 void remove_input_device(const char *device_path) {
-    pthread_mutex_lock(&thread_mutex);
-    
-    for (int i = 0; i < num_device_threads; i++) {
-        if (thread_data[i].thread_active && 
-            strcmp(thread_data[i].device_path, device_path) == 0) {
-            thread_data[i].thread_active = 0;
-            // The thread will detect this and exit
-            log_message(LOG_INFO, "Marked device %s for removal", device_path);
-            break;
+    input_device_t *dev;
+    
+    pthread_mutex_lock(&device_mutex);
+    
+    dev = registry ? lookup_path(registry, device_path) : NULL;
+    if (dev) {
+        log_message(LOG_INFO, "Removed device %s from monitoring", device_path);
+        release_device(dev);
+    }
+    
+    pthread_mutex_unlock(&device_mutex);
+}
+
+void remove_input_device_devt(dev_t devt) {
+    input_device_t *dev;
+    
+    pthread_mutex_lock(&device_mutex);
+    
+    dev = registry ? lookup_devt(registry, devt) : NULL;
+    if (dev) {
+        log_message(LOG_INFO, "Removed device %s from monitoring", dev->device_path);
+        release_device(dev);
+    }
+    
+    pthread_mutex_unlock(&device_mutex);
+}
+
+int device_monitor_foreach(device_visitor visitor, void *ctx) {
+    int count = 0;
+    
+    pthread_mutex_lock(&device_mutex);
+    
+    for (size_t i = 0; registry && i <= registry->mask; i++) {
+        for (const input_device_t *dev = registry->by_devt[i]; dev; dev = dev->next_devt) {
+            visitor(dev, ctx);
+            count++;
         }
     }
     
-    pthread_mutex_unlock(&thread_mutex);
+    pthread_mutex_unlock(&device_mutex);
+    return count;
 }
 
 void scan_existing_devices(void) {
@@ -143,89 +498,234 @@ void scan_existing_devices(void) {
     
     log_message(LOG_INFO, "Scanning existing input devices");
     
-    dir = opendir("/dev/input");
+    dir = opendir(input_dir);
     if (!dir) {
-        log_message(LOG_ERR, "Failed to open /dev/input directory");
+        log_message(LOG_ERR, "Failed to open %s directory", input_dir);
         return;
     }
     
     while ((entry = readdir(dir)) != NULL) {
         if (strncmp(entry->d_name, "event", 5) == 0) {
             /* Use a safer approach to prevent truncation */
-            if (snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name) >= (int)sizeof(path)) {
+            if (snprintf(path, sizeof(path), "%s/%s", input_dir, entry->d_name) >= (int)sizeof(path)) {
                 log_message(LOG_WARNING, "Device name too long: %s", entry->d_name);
                 continue;
             }
-            log_message(LOG_INFO, "Found input device: %s", path);
+            log_listing(LOG_INFO, "Found input device: %s", path);
+            scanning = 1;
             add_input_device(path);
+            scanning = 0;
         }
     }
     
     closedir(dir);
 }
 
-void *device_monitor_thread(void *arg) {
-    device_thread_data_t *data = (device_thread_data_t *)arg;
-    char *device_path = data->device_path;
-    int fd;
-    struct input_event ev;
-    ssize_t n;
+void device_monitor_resync(void) {
+    input_device_t *next;
+    struct stat st;
+    int removed = 0;
     
-    log_message(LOG_INFO, "Started monitoring thread for device: %s", device_path);
+    pthread_mutex_lock(&device_mutex);
     
-    // Open the input device
-    fd = open(device_path, O_RDONLY | O_NONBLOCK);
-    if (fd < 0) {
-        log_message(LOG_ERR, "Error opening device %s: %s", device_path, strerror(errno));
-        data->thread_active = 0;
-        return NULL;
+    for (size_t i = 0; registry && i <= registry->mask; i++) {
+        for (input_device_t *dev = registry->by_devt[i]; dev; dev = next) {
+            next = dev->next_devt;
+            if (stat(dev->device_path, &st) < 0 || device_key(&st) != dev->devt) {
+                log_listing(LOG_INFO, "Device %s is gone, removed from monitoring", dev->device_path);
+                release_device(dev);
+                removed++;
+            }
+        }
     }
     
-    // Main monitoring loop
-    while (get_running_state() && data->thread_active) {
-        n = read(fd, &ev, sizeof(ev));
-        
-        if (n == sizeof(ev)) {
-            // Check if it's a key/button event
-            if (ev.type == EV_KEY) {
-                button_callback callback = get_button_callback();
-                if (callback) {
-                    callback(device_path, ev.code, ev.value);
-                }
+    pthread_mutex_unlock(&device_mutex);
+    
+    log_message(LOG_INFO, "Resync removed %d stale devices", removed);
+    scan_existing_devices();
+
+    pthread_mutex_lock(&device_mutex);
+    journal_write(JOURNAL_RESYNC, 0, 0, (int)num_devices, JOURNAL_NO_ACTION, 0);
+    pthread_mutex_unlock(&device_mutex);
+}
+
+static int key_bit(const unsigned long *bits, int code) {
+    return (bits[code / (8 * sizeof(unsigned long))] >> (code % (8 * sizeof(unsigned long)))) & 1UL;
+}
+
+static void set_key_bit(unsigned long *bits, int code, int on) {
+    unsigned long mask = 1UL << (code % (8 * sizeof(unsigned long)));
+
+    if (on) {
+        bits[code / (8 * sizeof(unsigned long))] |= mask;
+    } else {
+        bits[code / (8 * sizeof(unsigned long))] &= ~mask;
+    }
+}
+
+// Deliver the key events of a completed frame through the filter to the registered callback
+static void flush_frame(input_device_t *dev, uint64_t read_ns) {
+    if (dev->frame_len > 0) {
+        latency_record(LATENCY_READ_TO_CALLBACK, read_ns, latency_now());
+    }
+
+    for (int i = 0; i < dev->frame_len; i++) {
+        const struct input_event *ev = &dev->frame[i];
+        uint64_t kernel_ns;
+
+        if (ev->code < KEY_CNT) {
+            set_key_bit(dev->key_state, ev->code, ev->value != 0);
+        }
+
+        kernel_ns = latency_from_timeval(&ev->time);
+        journal_write(JOURNAL_KEY, dev->devt, ev->code, ev->value, JOURNAL_NO_ACTION,
+                      read_ns > kernel_ns ? read_ns - kernel_ns : 0);
+
+        event_filter_event(dev->devt, dev->device_path, ev->code, ev->value, &ev->time);
+    }
+
+    dev->key_events += (unsigned long)dev->frame_len;
+    dev->frame_len = 0;
+}
+
+// Events were lost in the kernel buffer; rebuild key state from EVIOCGKEY
+static void resync_key_state(input_device_t *dev, const struct timeval *time) {
+    unsigned long current[KEY_STATE_LONGS];
+
+    memset(current, 0, sizeof(current));
+    if (ioctl(dev->fd, EVIOCGKEY(sizeof(current)), current) < 0) {
+        log_message(LOG_WARNING, "Failed to resync key state of %s: %s",
+                    dev->device_path, strerror(errno));
+        return;
+    }
+
+    for (int code = 0; code < KEY_CNT; code++) {
+        int state = key_bit(current, code);
+
+        if (state == key_bit(dev->key_state, code)) {
+            continue;
+        }
+
+        set_key_bit(dev->key_state, code, state);
+        dev->key_events++;
+        journal_write(JOURNAL_KEY, dev->devt, code, state, JOURNAL_NO_ACTION, 0);
+        event_filter_event(dev->devt, dev->device_path, code, state, time);
+    }
+}
+
+static void process_event(input_device_t *dev, const struct input_event *ev, uint64_t read_ns) {
+    if (ev->type == EV_SYN) {
+        switch (ev->code) {
+        case SYN_REPORT:
+            if (dev->dropping) {
+                dev->dropping = 0;
+                resync_key_state(dev, &ev->time);
+            } else {
+                flush_frame(dev, read_ns);
             }
-        } else if (n < 0) {
-            if (errno != EAGAIN) {
-                log_message(LOG_ERR, "Error reading from device %s: %s", device_path, strerror(errno));
+            break;
+        case SYN_DROPPED:
+            log_message(LOG_WARNING, "Input events dropped on %s, resyncing", dev->device_path);
+            dev->frame_len = 0;
+            dev->dropping = 1;
+            break;
+        default:
+            break;
+        }
+        return;
+    }
+
+    // Everything up to the next SYN_REPORT is unreliable after SYN_DROPPED
+    if (dev->dropping || ev->type != EV_KEY) {
+        return;
+    }
+
+    latency_record(LATENCY_KERNEL_TO_READ, latency_from_timeval(&ev->time), read_ns);
+
+    if (dev->frame_len == INPUT_FRAME_MAX) {
+        flush_frame(dev, read_ns);
+    }
+    dev->frame[dev->frame_len++] = *ev;
+}
+
+static void process_events(input_device_t *dev, const struct input_event *buf, size_t count) {
+    uint64_t read_ns = latency_now();
+    
+    for (size_t i = 0; i < count; i++) {
+        process_event(dev, &buf[i], read_ns);
+    }
+}
+
+// n is the read() result, err its errno
+static void read_failed(input_device_t *dev, ssize_t n, int err) {
+    if (n < 0) {
+        log_message(LOG_ERR, "Error reading from device %s: %s", dev->device_path, strerror(err));
+    } else if (n == 0) {
+        // Only FIFOs report end of file; their writer closed
+        log_message(LOG_INFO, "Event stream %s closed", dev->device_path);
+    } else {
+        log_message(LOG_ERR, "Short read from device %s", dev->device_path);
+    }
+    remove_input_device_devt(dev->devt);
+}
+
+void device_monitor_handle_event(int fd, uint32_t events, void *ctx) {
+    input_device_t *dev = (input_device_t *)ctx;
+    struct input_event buf[INPUT_READ_BATCH];
+    ssize_t n;
+    
+    // Drain everything the device has queued, then go back to the loop
+    for (;;) {
+        n = read(fd, buf, sizeof(buf));
+        
+        if (n > 0 && n % sizeof(buf[0]) == 0) {
+            process_events(dev, buf, (size_t)n / sizeof(buf[0]));
+            // A short batch means the kernel queue is empty
+            if ((size_t)n < sizeof(buf)) {
                 break;
             }
-            // No data available right now, sleep a bit
-            usleep(10000); // 10ms
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            break;
+        } else {
+            read_failed(dev, n, errno);
+            return;
         }
     }
     
-    close(fd);
-    log_message(LOG_INFO, "Stopped monitoring thread for device: %s", device_path);
-    
-    data->thread_active = 0;
-    return NULL;
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        remove_input_device_devt(dev->devt);
+    }
 }
 
-void print_monitored_devices(void) {
-    int active_count = 0;
+void device_monitor_handle_read(int fd, const void *data, ssize_t len, void *ctx) {
+    input_device_t *dev = (input_device_t *)ctx;
     
-    pthread_mutex_lock(&thread_mutex);
+    /* Prevent unused parameter warning */
+    (void)fd;
     
-    log_message(LOG_INFO, "Currently monitoring the following input devices:");
-    for (int i = 0; i < num_device_threads; i++) {
-        if (thread_data[i].thread_active) {
-            log_message(LOG_INFO, "  - %s", thread_data[i].device_path);
-            active_count++;
-        }
+    if (len > 0 && len % sizeof(struct input_event) == 0) {
+        // Ring buffers are aligned for any event
+        process_events(dev, (const struct input_event *)data, (size_t)len / sizeof(struct input_event));
+    } else if (len != -ENOBUFS) {
+        // Out of ring buffers only delays the read; anything else ends the device
+        read_failed(dev, len < 0 ? -1 : len, len < 0 ? (int)-len : 0);
     }
+}
+
+static void print_device(const input_device_t *dev, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)ctx;
     
-    if (active_count == 0) {
-        log_message(LOG_INFO, "  No active device monitors");
-    }
+    log_listing(LOG_INFO, "  - %s (%u:%u, generation %lu)", dev->device_path,
+                major(dev->devt), minor(dev->devt), dev->generation);
+}
+
+void print_monitored_devices(void) {
+    log_listing(LOG_INFO, "Currently monitoring the following input devices:");
     
-    pthread_mutex_unlock(&thread_mutex);
+    if (device_monitor_foreach(print_device, NULL) == 0) {
+        log_listing(LOG_INFO, "  No active device monitors");
+    }
 }
@@ -0,0 +1,334 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file event_filter.c
+ * @brief Implementation of the debounce and dedupe filter
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "../include/event_filter.h"
+#include "../include/button_bus.h"
+#include "../include/button_callback.h"
+#include "../include/event_loop.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+typedef struct {
+    int in_use;
+    dev_t devt;
+    int code;
+    char device[64];
+    int reported;               /* State last passed on */
+    int raw;                    /* State last read */
+    int shadowed;               /* Duplicate of another device's press until released */
+    struct timeval raw_time;
+    uint64_t edge_ns;           /* Kernel time of the last edge passed on, 0 if none */
+    uint64_t press_ns;          /* Kernel time of the last press passed on */
+    uint64_t settle_ns;         /* CLOCK_MONOTONIC time to pass raw on, 0 if not pending */
+} filter_key_t;
+
+// Only touched from the event loop thread
+static filter_key_t keys[EVENT_FILTER_MAX_KEYS];
+static event_filter_config_t config = { EVENT_FILTER_DEBOUNCE_MS, EVENT_FILTER_DEDUPE_MS };
+static event_filter_stats_t stats;
+static int timer_fd = -1;
+static int timer_failed = 0;
+
+static void pass(const char *device, int code, int value, const struct timeval *timestamp) {
+    button_callback callback = get_button_callback();
+
+    stats.passed++;
+    if (callback) {
+        callback(device, code, value, timestamp);
+    }
+    button_bus_publish(device, code, value, timestamp);
+}
+
+// Arm the timer for the earliest pending settle, or disarm it
+static void arm_timer(void) {
+    struct itimerspec its;
+    uint64_t next = 0;
+
+    if (timer_fd < 0) {
+        return;
+    }
+
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        if (keys[i].in_use && keys[i].settle_ns && (!next || keys[i].settle_ns < next)) {
+            next = keys[i].settle_ns;
+        }
+    }
+
+    // A zero it_value disarms the timer
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(next / 1000000000ULL);
+    its.it_value.tv_nsec = (long)(next % 1000000000ULL);
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+        log_message(LOG_WARNING, "Failed to set debounce timer: %s", strerror(errno));
+    }
+}
+
+static void timer_expired(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+    uint64_t expirations;
+    uint64_t now = latency_now();
+
+    if (read(fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) {
+        // Disarmed after the expiry was queued
+        return;
+    }
+
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        filter_key_t *k = &keys[i];
+
+        if (!k->in_use || !k->settle_ns || k->settle_ns > now) {
+            continue;
+        }
+
+        k->settle_ns = 0;
+        if (k->raw != k->reported) {
+            k->reported = k->raw;
+            k->edge_ns = latency_from_timeval(&k->raw_time);
+            if (k->raw) {
+                k->press_ns = k->edge_ns;
+            }
+            stats.settled++;
+            pass(k->device, k->code, k->raw, &k->raw_time);
+        }
+    }
+
+    arm_timer();
+}
+
+static filter_key_t *find_key(dev_t devt, int code) {
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        if (keys[i].in_use && keys[i].devt == devt && keys[i].code == code) {
+            return &keys[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Take a free slot, or the released key with the oldest edge
+static filter_key_t *track_key(dev_t devt, const char *device, int code) {
+    filter_key_t *k = NULL;
+
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS && !k; i++) {
+        if (!keys[i].in_use) {
+            k = &keys[i];
+        }
+    }
+    if (!k) {
+        for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+            filter_key_t *c = &keys[i];
+
+            if (!c->reported && !c->shadowed && !c->settle_ns && (!k || c->edge_ns < k->edge_ns)) {
+                k = c;
+            }
+        }
+    }
+    if (!k) {
+        return NULL;
+    }
+
+    memset(k, 0, sizeof(*k));
+    k->in_use = 1;
+    k->devt = devt;
+    k->code = code;
+    snprintf(k->device, sizeof(k->device), "%s", device);
+    return k;
+}
+
+// Another device passed on a press of the same key within the window
+static int is_duplicate(const filter_key_t *k, uint64_t t) {
+    uint64_t window = (uint64_t)config.dedupe_ms * 1000000ULL;
+
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        const filter_key_t *o = &keys[i];
+
+        if (o == k || !o->in_use || o->code != k->code || o->devt == k->devt ||
+            o->shadowed || !o->press_ns) {
+            continue;
+        }
+        if ((t >= o->press_ns ? t - o->press_ns : o->press_ns - t) <= window) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int event_filter_init(void) {
+    memset(keys, 0, sizeof(keys));
+    memset(&stats, 0, sizeof(stats));
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd >= 0 && event_loop_add(timer_fd, EPOLLIN, timer_expired, NULL) < 0) {
+        close(timer_fd);
+        timer_fd = -1;
+    }
+    if (timer_fd < 0) {
+        log_message(LOG_WARNING, "No debounce timer, debouncing disabled");
+        timer_failed = 1;
+        config.debounce_ms = 0;
+        return -1;
+    }
+
+    timer_failed = 0;
+    return 0;
+}
+
+void event_filter_cleanup(void) {
+    if (timer_fd >= 0) {
+        event_loop_remove(timer_fd);
+        close(timer_fd);
+        timer_fd = -1;
+    }
+    memset(keys, 0, sizeof(keys));
+}
+
+void event_filter_set_config(const event_filter_config_t *new_config) {
+    config = *new_config;
+
+    // Debounce cannot settle without the timer
+    if (timer_failed) {
+        config.debounce_ms = 0;
+    }
+}
+
+void event_filter_get_config(event_filter_config_t *out) {
+    *out = config;
+}
+
+void event_filter_event(dev_t devt, const char *device, int code, int value,
+                        const struct timeval *timestamp) {
+    filter_key_t *k;
+    uint64_t t;
+
+    if (config.debounce_ms == 0 && config.dedupe_ms == 0) {
+        pass(device, code, value, timestamp);
+        return;
+    }
+
+    k = find_key(devt, code);
+
+    // Auto-repeat goes wherever its press went
+    if (value != 0 && value != 1) {
+        if (k && k->shadowed) {
+            stats.deduplicated++;
+            return;
+        }
+        pass(device, code, value, timestamp);
+        return;
+    }
+
+    if (!k) {
+        // A release without a press on record has nothing to filter against
+        if (value == 0) {
+            pass(device, code, value, timestamp);
+            return;
+        }
+        k = track_key(devt, device, code);
+        if (!k) {
+            stats.untracked++;
+            pass(device, code, value, timestamp);
+            return;
+        }
+    }
+
+    t = latency_from_timeval(timestamp);
+    k->raw = value;
+    k->raw_time = *timestamp;
+
+    if (k->shadowed) {
+        if (value == 0) {
+            k->shadowed = 0;
+        }
+        stats.deduplicated++;
+        return;
+    }
+
+    if (value == k->reported) {
+        // Bounced back before the window closed
+        if (k->settle_ns) {
+            k->settle_ns = 0;
+            stats.debounced++;
+            arm_timer();
+            return;
+        }
+        pass(device, code, value, timestamp);
+        return;
+    }
+
+    // Timestamps older than the last edge are taken as outside the window
+    if (config.debounce_ms && k->edge_ns && t - k->edge_ns < (uint64_t)config.debounce_ms * 1000000ULL) {
+        k->settle_ns = latency_now() + (k->edge_ns + (uint64_t)config.debounce_ms * 1000000ULL - t);
+        stats.debounced++;
+        arm_timer();
+        return;
+    }
+
+    if (value == 1 && config.dedupe_ms && is_duplicate(k, t)) {
+        k->shadowed = 1;
+        stats.deduplicated++;
+        return;
+    }
+
+    k->reported = value;
+    k->edge_ns = t;
+    if (value) {
+        k->press_ns = t;
+    }
+    if (k->settle_ns) {
+        k->settle_ns = 0;
+        arm_timer();
+    }
+    pass(device, code, value, timestamp);
+}
+
+void event_filter_forget(dev_t devt) {
+    int pending = 0;
+
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        if (keys[i].in_use && keys[i].devt == devt) {
+            pending |= keys[i].settle_ns != 0;
+            keys[i].in_use = 0;
+        }
+    }
+
+    if (pending) {
+        arm_timer();
+    }
+}
+
+void event_filter_get_stats(event_filter_stats_t *out) {
+    *out = stats;
+}
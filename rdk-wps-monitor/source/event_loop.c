@@ -0,0 +1,243 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file event_loop.c
+ * @brief Implementation of the epoll based event loop
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "../include/event_loop.h"
+#include "../include/utils.h"
+
+#define MAX_EVENTS 32
+
+// Registration record, referenced from epoll_event.data.ptr
+typedef struct watcher {
+    int fd;
+    int removed;
+    event_handler handler;
+    void *ctx;
+    struct watcher *next;
+} watcher_t;
+
+static int epoll_fd = -1;
+static int stop_fd = -1;
+static watcher_t *watchers = NULL;
+static int dispatching = 0;
+static unsigned long wakeups = 0;
+
+static void free_removed_watchers(void) {
+    watcher_t **link = &watchers;
+
+    while (*link) {
+        watcher_t *w = *link;
+        if (w->removed) {
+            *link = w->next;
+            free(w);
+        } else {
+            link = &w->next;
+        }
+    }
+}
+
+int event_loop_init(void) {
+    struct epoll_event ev;
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        log_message(LOG_ERR, "Failed to create epoll instance: %s", strerror(errno));
+        return -1;
+    }
+
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd < 0) {
+        log_message(LOG_ERR, "Failed to create shutdown eventfd: %s", strerror(errno));
+        close(epoll_fd);
+        epoll_fd = -1;
+        return -1;
+    }
+
+    // The shutdown eventfd is the only descriptor without a watcher
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev) < 0) {
+        log_message(LOG_ERR, "Failed to watch shutdown eventfd: %s", strerror(errno));
+        event_loop_cleanup();
+        return -1;
+    }
+
+    wakeups = 0;
+    return 0;
+}
+
+void event_loop_cleanup(void) {
+    for (watcher_t *w = watchers; w; w = w->next) {
+        w->removed = 1;
+    }
+    free_removed_watchers();
+
+    if (stop_fd >= 0) {
+        close(stop_fd);
+        stop_fd = -1;
+    }
+
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+}
+
+int event_loop_add(int fd, uint32_t events, event_handler handler, void *ctx) {
+    struct epoll_event ev;
+    watcher_t *w;
+
+    if (epoll_fd < 0 || fd < 0 || !handler) {
+        return -1;
+    }
+
+    w = calloc(1, sizeof(*w));
+    if (!w) {
+        log_message(LOG_ERR, "Out of memory registering fd %d", fd);
+        return -1;
+    }
+
+    w->fd = fd;
+    w->handler = handler;
+    w->ctx = ctx;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = w;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        log_message(LOG_ERR, "Failed to add fd %d to event loop: %s", fd, strerror(errno));
+        free(w);
+        return -1;
+    }
+
+    w->next = watchers;
+    watchers = w;
+    return 0;
+}
+
+int event_loop_modify(int fd, uint32_t events) {
+    struct epoll_event ev;
+
+    for (watcher_t *w = watchers; w; w = w->next) {
+        if (w->fd == fd && !w->removed) {
+            memset(&ev, 0, sizeof(ev));
+            ev.events = events;
+            ev.data.ptr = w;
+            return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+
+    return -1;
+}
+
+void event_loop_remove(int fd) {
+    for (watcher_t *w = watchers; w; w = w->next) {
+        if (w->fd == fd && !w->removed) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            w->removed = 1;
+            break;
+        }
+    }
+
+    // Pending events in the current batch may still reference the watcher
+    if (!dispatching) {
+        free_removed_watchers();
+    }
+}
+
+int event_loop_run(void) {
+    struct epoll_event events[MAX_EVENTS];
+    int n;
+
+    if (epoll_fd < 0) {
+        return -1;
+    }
+
+    log_message(LOG_INFO, "Event loop started");
+
+    while (get_running_state()) {
+        n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_message(LOG_ERR, "epoll_wait failed: %s", strerror(errno));
+            return -1;
+        }
+
+        // Only this thread writes; harness threads read it while idle
+        __atomic_store_n(&wakeups, wakeups + 1, __ATOMIC_RELAXED);
+        dispatching = 1;
+
+        for (int i = 0; i < n; i++) {
+            watcher_t *w = events[i].data.ptr;
+
+            if (!w) {
+                uint64_t value;
+                if (read(stop_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+                    log_message(LOG_WARNING, "Failed to drain shutdown eventfd: %s", strerror(errno));
+                }
+                set_running_state(false);
+                continue;
+            }
+
+            if (!w->removed) {
+                w->handler(w->fd, events[i].events, w->ctx);
+            }
+        }
+
+        dispatching = 0;
+        free_removed_watchers();
+    }
+
+    log_message(LOG_INFO, "Event loop stopped after %lu wakeups", wakeups);
+    return 0;
+}
+
+void event_loop_stop(void) {
+    uint64_t one = 1;
+    int saved_errno = errno;
+
+    set_running_state(false);
+    if (stop_fd >= 0) {
+        // Only fails if the counter would overflow, which still wakes the loop
+        if (write(stop_fd, &one, sizeof(one)) < 0) {
+            // Nothing more can be done from a signal handler
+        }
+    }
+
+    errno = saved_errno;
+}
+
+unsigned long event_loop_get_wakeups(void) {
+    return __atomic_load_n(&wakeups, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,260 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file gesture.c
+ * @brief Implementation of the button gesture engine
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "../include/gesture.h"
+#include "../include/event_loop.h"
+#include "../include/utils.h"
+
+/*
+ * IDLE --press--> PRESSED --release--> WAIT_TAP --timeout--> short press
+ *                    |                    |
+ *                 timeout              press (second tap) --release--> double tap
+ *                    v
+ *                  HELD (long press reported) --release--> IDLE
+ */
+typedef enum {
+    STATE_IDLE,
+    STATE_PRESSED,
+    STATE_WAIT_TAP,
+    STATE_HELD
+} button_state_t;
+
+typedef struct {
+    int in_use;
+    char device[64];
+    int code;
+    button_state_t state;
+    int taps;
+    struct timeval pressed_at;  /* First press of the current sequence */
+    unsigned int gestures;      /* Gestures bound to the button at first press */
+    int timer_fd;
+} button_t;
+
+// Only touched from the event loop thread
+static button_t buttons[GESTURE_MAX_BUTTONS];
+static gesture_handler on_gesture = NULL;
+
+static const char *gesture_names[GESTURE_COUNT] = {
+    "short press",
+    "long press",
+    "double tap",
+};
+
+static int is_enabled(const button_t *b, gesture_t gesture) {
+    return (b->gestures & GESTURE_BIT(gesture)) != 0;
+}
+
+static void arm_timer(button_t *b, long ms) {
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = ms / 1000;
+    its.it_value.tv_nsec = (ms % 1000) * 1000000L;
+
+    // A zero it_value disarms the timer
+    if (timerfd_settime(b->timer_fd, 0, &its, NULL) < 0) {
+        log_message(LOG_WARNING, "Failed to set gesture timer: %s", strerror(errno));
+    }
+}
+
+static void fire(button_t *b, gesture_t gesture) {
+    if (is_enabled(b, gesture) && on_gesture) {
+        on_gesture(b->device, b->code, gesture, &b->pressed_at);
+    }
+}
+
+static void timer_expired(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    button_t *b = (button_t *)ctx;
+    uint64_t expirations;
+
+    if (read(fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) {
+        // Disarmed after the expiry was queued
+        return;
+    }
+
+    switch (b->state) {
+    case STATE_PRESSED:
+        // Reported while the button is still down, so the user gets feedback
+        b->state = STATE_HELD;
+        fire(b, GESTURE_LONG_PRESS);
+        break;
+    case STATE_WAIT_TAP:
+        b->state = STATE_IDLE;
+        fire(b, GESTURE_SHORT_PRESS);
+        break;
+    default:
+        break;
+    }
+}
+
+static button_t *find_button(const char *device, int code) {
+    for (int i = 0; i < GESTURE_MAX_BUTTONS; i++) {
+        if (buttons[i].in_use && buttons[i].code == code &&
+            strcmp(buttons[i].device, device) == 0) {
+            return &buttons[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Take a free slot, or the first idle one when every slot has been used
+static button_t *track_button(const char *device, int code) {
+    button_t *b = NULL;
+
+    for (int i = 0; i < GESTURE_MAX_BUTTONS && !b; i++) {
+        if (!buttons[i].in_use) {
+            b = &buttons[i];
+        }
+    }
+    for (int i = 0; i < GESTURE_MAX_BUTTONS && !b; i++) {
+        if (buttons[i].state == STATE_IDLE) {
+            b = &buttons[i];
+        }
+    }
+    if (!b) {
+        return NULL;
+    }
+
+    if (!b->in_use) {
+        b->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (b->timer_fd < 0) {
+            log_message(LOG_ERR, "Failed to create gesture timer: %s", strerror(errno));
+            return NULL;
+        }
+        if (event_loop_add(b->timer_fd, EPOLLIN, timer_expired, b) < 0) {
+            close(b->timer_fd);
+            return NULL;
+        }
+        b->in_use = 1;
+    }
+
+    snprintf(b->device, sizeof(b->device), "%s", device);
+    b->code = code;
+    b->state = STATE_IDLE;
+    b->taps = 0;
+    return b;
+}
+
+int gesture_init(gesture_handler handler) {
+    memset(buttons, 0, sizeof(buttons));
+    on_gesture = handler;
+    return 0;
+}
+
+void gesture_cleanup(void) {
+    for (int i = 0; i < GESTURE_MAX_BUTTONS; i++) {
+        if (buttons[i].in_use) {
+            event_loop_remove(buttons[i].timer_fd);
+            close(buttons[i].timer_fd);
+            buttons[i].in_use = 0;
+        }
+    }
+
+    on_gesture = NULL;
+}
+
+static void handle_press(button_t *b, const struct timeval *timestamp, unsigned int gestures) {
+    switch (b->state) {
+    case STATE_IDLE:
+        b->taps = 0;
+        b->pressed_at = *timestamp;
+        b->gestures = gestures;
+        /* fall through */
+    case STATE_WAIT_TAP:
+        b->state = STATE_PRESSED;
+        arm_timer(b, is_enabled(b, GESTURE_LONG_PRESS) ? GESTURE_LONG_PRESS_MS : 0);
+        break;
+    default:
+        break;
+    }
+}
+
+static void handle_release(button_t *b) {
+    switch (b->state) {
+    case STATE_PRESSED:
+        arm_timer(b, 0);
+        b->taps++;
+        if (b->taps >= 2) {
+            b->state = STATE_IDLE;
+            fire(b, GESTURE_DOUBLE_TAP);
+        } else if (is_enabled(b, GESTURE_DOUBLE_TAP)) {
+            b->state = STATE_WAIT_TAP;
+            arm_timer(b, GESTURE_MULTI_TAP_MS);
+        } else {
+            // Nothing to wait for; report without the tap delay
+            b->state = STATE_IDLE;
+            fire(b, GESTURE_SHORT_PRESS);
+        }
+        break;
+    case STATE_HELD:
+        b->state = STATE_IDLE;
+        break;
+    default:
+        break;
+    }
+}
+
+void gesture_handle_event(const char *device, int button_code, int value,
+                          const struct timeval *timestamp, unsigned int gestures) {
+    button_t *b;
+
+    // Auto-repeat says nothing the press timer does not already know
+    if (value != 0 && value != 1) {
+        return;
+    }
+
+    b = find_button(device, button_code);
+    if (!b) {
+        // Unbound buttons never take a slot
+        if (value == 0 || gestures == 0) {
+            return;
+        }
+        b = track_button(device, button_code);
+        if (!b) {
+            log_message(LOG_WARNING, "Too many active buttons, ignoring button %d on %s", button_code, device);
+            return;
+        }
+    }
+
+    if (value == 1) {
+        handle_press(b, timestamp, gestures);
+    } else {
+        handle_release(b);
+    }
+}
+
+const char *gesture_name(gesture_t gesture) {
+    return gesture < GESTURE_COUNT ? gesture_names[gesture] : "unknown";
+}
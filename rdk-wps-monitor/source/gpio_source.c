@@ -0,0 +1,454 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file gpio_source.c
+ * @brief Implementation of the GPIO line button source
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <syslog.h>
+#include <dirent.h>
+#include <linux/gpio.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include "../include/gpio_source.h"
+#include "../include/button_config.h"
+#include "../include/event_filter.h"
+#include "../include/event_loop.h"
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+// Kernel headers before 5.19 know the v2 uAPI but not the HTE clock
+#ifndef GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE
+#define GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE _BITULL(9)
+#endif
+
+typedef struct {
+    char *name;                 /* Line name or FIFO path */
+    char device[96];
+    dev_t devt;
+    int code;
+    unsigned int debounce_ms;
+    int active_high;
+    int fd;                     /* Line request or FIFO, -1 when not requested */
+    int fifo;
+    int hte;
+    int state;                  /* Last value passed on */
+    uint32_t line_seqno;        /* Of the last edge read, 0 before the first */
+    unsigned long key_events;
+    unsigned long lost;
+} gpio_line_t;
+
+static gpio_line_t lines[GPIO_SOURCE_MAX_LINES];
+static int line_count = 0;
+
+int gpio_source_add(const char *spec) {
+    char buf[128];
+    char *fields[4];
+    int count = 0;
+    gpio_line_t *line;
+    char *cursor;
+    char *end;
+    long ms;
+
+    if (!spec || line_count == GPIO_SOURCE_MAX_LINES || strlen(spec) >= sizeof(buf)) {
+        return -1;
+    }
+    strcpy(buf, spec);
+
+    // Fields are colon separated, so a FIFO path may not contain ':'
+    cursor = buf;
+    while (count < 4) {
+        fields[count++] = cursor;
+        if (!(cursor = strchr(cursor, ':'))) {
+            break;
+        }
+        *cursor++ = '\0';
+    }
+    if (cursor || count < 2 || fields[0][0] == '\0') {
+        return -1;
+    }
+
+    line = &lines[line_count];
+    memset(line, 0, sizeof(*line));
+    line->fd = -1;
+    line->debounce_ms = GPIO_SOURCE_DEBOUNCE_MS;
+
+    if ((line->code = button_config_key_code(fields[1])) < 0) {
+        return -1;
+    }
+
+    for (int i = 2; i < count; i++) {
+        if (strcmp(fields[i], "active-high") == 0) {
+            line->active_high = 1;
+            continue;
+        }
+        ms = strtol(fields[i], &end, 10);
+        if (fields[i][0] == '\0' || *end != '\0' || ms < 0 || ms > 1000) {
+            return -1;
+        }
+        line->debounce_ms = (unsigned int)ms;
+    }
+
+    if (!(line->name = strdup(fields[0]))) {
+        return -1;
+    }
+    line_count++;
+    return 0;
+}
+
+// Find a line by name on every GPIO chip; chip receives the chip path
+static int find_line(const char *name, char *chip, size_t len, unsigned int *offset) {
+    struct gpiochip_info info;
+    struct gpio_v2_line_info line_info;
+    struct dirent *entry;
+    DIR *dir;
+    int found = 0;
+    int fd;
+
+    dir = opendir(GPIO_SOURCE_DEV_DIR);
+    if (!dir) {
+        return -1;
+    }
+
+    while (!found && (entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "gpiochip", 8) != 0) {
+            continue;
+        }
+        snprintf(chip, len, "%s/%s", GPIO_SOURCE_DEV_DIR, entry->d_name);
+
+        fd = open(chip, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        memset(&info, 0, sizeof(info));
+        if (ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) == 0) {
+            for (unsigned int i = 0; i < info.lines && !found; i++) {
+                memset(&line_info, 0, sizeof(line_info));
+                line_info.offset = i;
+                if (ioctl(fd, GPIO_V2_GET_LINEINFO_IOCTL, &line_info) == 0 &&
+                    strncmp(line_info.name, name, sizeof(line_info.name)) == 0) {
+                    *offset = i;
+                    found = 1;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    closedir(dir);
+    return found ? 0 : -1;
+}
+
+static int request_line(gpio_line_t *line, const char *chip, unsigned int offset) {
+    struct gpio_v2_line_request req;
+    struct gpio_v2_line_values values;
+    struct stat st;
+    int chip_fd;
+    int rc;
+
+    chip_fd = open(chip, O_RDONLY | O_CLOEXEC);
+    if (chip_fd < 0 || fstat(chip_fd, &st) < 0) {
+        log_message(LOG_ERR, "Error opening GPIO chip %s: %s", chip, strerror(errno));
+        if (chip_fd >= 0) {
+            close(chip_fd);
+        }
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = offset;
+    req.num_lines = 1;
+    snprintf(req.consumer, sizeof(req.consumer), "%s", GPIO_SOURCE_CONSUMER);
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING |
+                       GPIO_V2_LINE_FLAG_EDGE_FALLING | GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE;
+    // Pressed reads as 1 and a press as a rising edge either way
+    if (!line->active_high) {
+        req.config.flags |= GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+    }
+    // Chips without hardware debounce get the kernel's software debounce
+    if (line->debounce_ms) {
+        req.config.num_attrs = 1;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+        req.config.attrs[0].attr.debounce_period_us = line->debounce_ms * 1000;
+        req.config.attrs[0].mask = 1;
+    }
+
+    line->hte = 1;
+    rc = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+    if (rc < 0 && errno != EBUSY) {
+        // Most chips have no timestamp engine; edges then carry CLOCK_MONOTONIC
+        req.config.flags &= ~(uint64_t)GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE;
+        line->hte = 0;
+        rc = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+    }
+    close(chip_fd);
+    if (rc < 0) {
+        log_message(LOG_ERR, "Error requesting GPIO line %s on %s: %s", line->name, chip, strerror(errno));
+        return -1;
+    }
+
+    if (fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK) < 0) {
+        log_message(LOG_ERR, "Error setting GPIO line %s non-blocking: %s", line->name, strerror(errno));
+        close(req.fd);
+        return -1;
+    }
+
+    // Start from the current level without reporting it as an edge
+    memset(&values, 0, sizeof(values));
+    values.mask = 1;
+    if (ioctl(req.fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0) {
+        line->state = (int)(values.bits & 1);
+    }
+
+    line->fd = req.fd;
+    // Lines of one chip share its st_rdev; the offset tells the filter and journal them apart
+    line->devt = makedev(major(st.st_rdev), (minor(st.st_rdev) << GPIO_SOURCE_OFFSET_BITS) |
+                         (offset & ((1U << GPIO_SOURCE_OFFSET_BITS) - 1)));
+    snprintf(line->device, sizeof(line->device), "%s:%s", chip, line->name);
+    return 0;
+}
+
+static int open_fifo(gpio_line_t *line) {
+    struct stat st;
+    int fd;
+
+    fd = open(line->name, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        log_message(LOG_ERR, "Error opening GPIO event stream %s: %s", line->name, strerror(errno));
+        return -1;
+    }
+    if (fstat(fd, &st) < 0 || !S_ISFIFO(st.st_mode)) {
+        log_message(LOG_ERR, "Not a FIFO: %s", line->name);
+        close(fd);
+        return -1;
+    }
+
+    line->fd = fd;
+    line->fifo = 1;
+    line->devt = makedev(0, (unsigned int)st.st_ino);
+    snprintf(line->device, sizeof(line->device), "%s", line->name);
+    return 0;
+}
+
+static void release_line(gpio_line_t *line) {
+    if (line->fd < 0) {
+        return;
+    }
+    event_loop_remove(line->fd);
+    close(line->fd);
+    line->fd = -1;
+    event_filter_forget(line->devt);
+}
+
+// Events were lost in the kernel's line buffer; pass on the level it reads now
+static void resync_line(gpio_line_t *line, const struct timeval *time) {
+    struct gpio_v2_line_values values;
+
+    memset(&values, 0, sizeof(values));
+    values.mask = 1;
+    if (ioctl(line->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+        log_message(LOG_WARNING, "Failed to resync GPIO line %s: %s", line->device, strerror(errno));
+        return;
+    }
+    if ((int)(values.bits & 1) != line->state) {
+        line->state = (int)(values.bits & 1);
+        line->key_events++;
+        journal_write(JOURNAL_KEY, line->devt, line->code, line->state, JOURNAL_NO_ACTION, 0);
+        event_filter_event(line->devt, line->device, line->code, line->state, time);
+    }
+}
+
+/*
+ * HTE stamps run on the timestamp engine's clock, which nothing else can
+ * compare with. Such an edge is placed on CLOCK_MONOTONIC at the read time,
+ * less how long before the batch's last edge it came, so the filter and
+ * gestures still see the real spacing of the edges.
+ */
+static uint64_t edge_time(const gpio_line_t *line, const struct gpio_v2_line_event *ev, uint64_t read_ns,
+                          uint64_t batch_last_ns) {
+    uint64_t before_last;
+
+    if (!ev->timestamp_ns) {
+        return read_ns;
+    }
+    if (!line->hte) {
+        return ev->timestamp_ns;
+    }
+
+    before_last = batch_last_ns > ev->timestamp_ns ? batch_last_ns - ev->timestamp_ns : 0;
+    return before_last < read_ns ? read_ns - before_last : read_ns;
+}
+
+static void process_edge(gpio_line_t *line, const struct gpio_v2_line_event *ev, uint64_t read_ns,
+                         uint64_t batch_last_ns) {
+    uint64_t edge_ns = edge_time(line, ev, read_ns, batch_last_ns);
+    uint64_t latency_ns = 0;
+    struct timeval time;
+    int value;
+
+    time.tv_sec = (time_t)(edge_ns / 1000000000ULL);
+    time.tv_usec = (suseconds_t)(edge_ns % 1000000000ULL / 1000);
+
+    // line_seqno counts every edge the kernel saw on the line
+    if (line->line_seqno && ev->line_seqno > line->line_seqno + 1) {
+        line->lost += ev->line_seqno - line->line_seqno - 1;
+        log_message(LOG_WARNING, "GPIO events dropped on %s, resyncing", line->device);
+        line->line_seqno = ev->line_seqno;
+        // A recording has no level to read, its next edge has to do
+        if (!line->fifo) {
+            resync_line(line, &time);
+            return;
+        }
+    }
+    line->line_seqno = ev->line_seqno;
+
+    // Only CLOCK_MONOTONIC stamps are comparable with the read time
+    if (!line->hte && edge_ns <= read_ns) {
+        latency_ns = read_ns - edge_ns;
+        latency_record(LATENCY_KERNEL_TO_READ, edge_ns, read_ns);
+    }
+
+    // A repeated edge means its opposite was debounced away
+    value = ev->id == GPIO_V2_LINE_EVENT_RISING_EDGE;
+    if (value == line->state) {
+        return;
+    }
+    line->state = value;
+    line->key_events++;
+
+    journal_write(JOURNAL_KEY, line->devt, line->code, value, JOURNAL_NO_ACTION, latency_ns);
+    event_filter_event(line->devt, line->device, line->code, value, &time);
+}
+
+static void handle_line(int fd, uint32_t events, void *ctx) {
+    gpio_line_t *line = (gpio_line_t *)ctx;
+    struct gpio_v2_line_event buf[GPIO_SOURCE_READ_BATCH];
+    uint64_t read_ns;
+    ssize_t n;
+
+    /* Prevent unused parameter warning */
+    (void)events;
+
+    // Drain everything the line has queued, then go back to the loop
+    for (;;) {
+        n = read(fd, buf, sizeof(buf));
+
+        if (n > 0 && n % sizeof(buf[0]) == 0) {
+            size_t count = (size_t)n / sizeof(buf[0]);
+
+            read_ns = latency_now();
+            for (size_t i = 0; i < count; i++) {
+                process_edge(line, &buf[i], read_ns, buf[count - 1].timestamp_ns);
+            }
+            latency_record(LATENCY_READ_TO_CALLBACK, read_ns, latency_now());
+            if ((size_t)n < sizeof(buf)) {
+                return;
+            }
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            return;
+        } else {
+            break;
+        }
+    }
+
+    if (n < 0) {
+        log_message(LOG_ERR, "Error reading GPIO line %s: %s", line->device, strerror(errno));
+    } else if (n == 0) {
+        // Only FIFOs report end of file; their writer closed
+        log_message(LOG_INFO, "GPIO event stream %s closed", line->device);
+    } else {
+        log_message(LOG_ERR, "Short read from GPIO line %s", line->device);
+    }
+    release_line(line);
+}
+
+int gpio_source_init(void) {
+    char chip[64];
+    unsigned int offset;
+    int failed = 0;
+
+    for (int i = 0; i < line_count; i++) {
+        gpio_line_t *line = &lines[i];
+
+        if (line->name[0] == '/') {
+            if (open_fifo(line) < 0) {
+                failed++;
+                continue;
+            }
+        } else if (find_line(line->name, chip, sizeof(chip), &offset) < 0) {
+            log_message(LOG_ERR, "GPIO line %s not found", line->name);
+            failed++;
+            continue;
+        } else if (request_line(line, chip, offset) < 0) {
+            failed++;
+            continue;
+        }
+
+        if (event_loop_add(line->fd, EPOLLIN, handle_line, line) < 0) {
+            log_message(LOG_ERR, "Failed to watch GPIO line %s", line->device);
+            close(line->fd);
+            line->fd = -1;
+            failed++;
+            continue;
+        }
+
+        log_message(LOG_INFO, "Monitoring GPIO line %s as key %d, debounce %u ms, %s timestamps",
+                    line->device, line->code, line->debounce_ms,
+                    line->fifo ? "recorded" : line->hte ? "hardware" : "monotonic");
+    }
+
+    return failed ? -1 : 0;
+}
+
+void gpio_source_cleanup(void) {
+    for (int i = 0; i < line_count; i++) {
+        release_line(&lines[i]);
+        free(lines[i].name);
+    }
+    line_count = 0;
+}
+
+int gpio_source_foreach(gpio_line_visitor visitor, void *ctx) {
+    gpio_line_info_t info;
+
+    for (int i = 0; i < line_count; i++) {
+        info.device = lines[i].device[0] ? lines[i].device : lines[i].name;
+        info.devt = lines[i].devt;
+        info.code = lines[i].code;
+        info.requested = lines[i].fd >= 0;
+        info.hte = lines[i].hte;
+        info.key_events = lines[i].key_events;
+        info.lost = lines[i].lost;
+        visitor(&info, ctx);
+    }
+
+    return line_count;
+}
@@ -0,0 +1,312 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file hotplug_monitor.c
+ * @brief Dispatch to the selected hotplug backend
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "../include/hotplug_monitor.h"
+#include "../include/device_monitor.h"
+#include "../include/event_loop.h"
+#include "../include/latency.h"
+#include "../include/inotify_monitor.h"
+#include "../include/netlink_monitor.h"
+#include "../include/uevent_stream.h"
+#include "../include/utils.h"
+
+static hotplug_backend_t active_backend = HOTPLUG_BACKEND_NETLINK;
+static int initialized = 0;
+static const char *stream_path = NULL;
+
+// Net change of one device within the debounce window
+typedef struct {
+    char path[256];
+    dev_t devt;             /* From a remove event, 0 if unknown */
+    int removed;            /* A remove was seen; the old node must go */
+    int present;            /* State after the last event */
+    uint64_t received_ns;   /* First add of the window */
+} pending_hotplug_t;
+
+// Only touched on the event loop thread
+static pending_hotplug_t pending[HOTPLUG_PENDING_MAX];
+static int pending_count = 0;
+static int resync_pending = 0;
+static int debounce_armed = 0;
+static int debounce_fd = -1;
+static hotplug_stats_t window_stats;
+
+static void apply_pending(void) {
+    for (int i = 0; i < pending_count; i++) {
+        pending_hotplug_t *p = &pending[i];
+
+        // A node that was replaced keeps its name, so drop the old one first
+        if (p->removed) {
+            if (p->devt) {
+                remove_input_device_devt(p->devt);
+            } else {
+                remove_input_device(p->path);
+            }
+        }
+        if (p->present && add_input_device(p->path) > 0) {
+            latency_record(LATENCY_UEVENT_TO_MONITORED, p->received_ns, latency_now());
+        }
+    }
+
+    pending_count = 0;
+}
+
+static void flush_window(void) {
+    if (resync_pending) {
+        resync_pending = 0;
+        pending_count = 0;
+        window_stats.resyncs++;
+        device_monitor_resync();
+        return;
+    }
+
+    apply_pending();
+}
+
+static void arm_debounce(void) {
+    struct itimerspec its;
+
+    if (debounce_fd < 0) {
+        flush_window();
+        return;
+    }
+    if (debounce_armed) {
+        return;
+    }
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_nsec = HOTPLUG_DEBOUNCE_MS * 1000000L;
+    if (timerfd_settime(debounce_fd, 0, &its, NULL) < 0) {
+        log_message(LOG_ERR, "Failed to arm hotplug debounce timer: %s", strerror(errno));
+        flush_window();
+        return;
+    }
+    debounce_armed = 1;
+}
+
+static void debounce_expired(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+    uint64_t expirations;
+
+    if (read(fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) {
+        return;
+    }
+    debounce_armed = 0;
+    flush_window();
+}
+
+void hotplug_monitor_queue(hotplug_action_t action, const char *path, dev_t devt,
+                           uint64_t received_ns) {
+    pending_hotplug_t *p = NULL;
+
+    // The rescan at the end of the window sees this change anyway
+    if (resync_pending) {
+        window_stats.coalesced++;
+        return;
+    }
+
+    for (int i = 0; i < pending_count && !p; i++) {
+        if (strcmp(pending[i].path, path) == 0) {
+            p = &pending[i];
+            window_stats.coalesced++;
+        }
+    }
+
+    if (!p) {
+        if (pending_count == HOTPLUG_PENDING_MAX) {
+            hotplug_monitor_request_resync("hotplug burst exceeds the pending table");
+            return;
+        }
+        p = &pending[pending_count++];
+        memset(p, 0, sizeof(*p));
+        snprintf(p->path, sizeof(p->path), "%s", path);
+    }
+
+    if (action == HOTPLUG_ADD) {
+        if (!p->present) {
+            p->received_ns = received_ns;
+        }
+        p->present = 1;
+    } else {
+        p->removed = 1;
+        p->present = 0;
+        if (devt) {
+            p->devt = devt;
+        }
+    }
+
+    arm_debounce();
+}
+
+void hotplug_monitor_request_resync(const char *reason) {
+    window_stats.overflows++;
+
+    if (!resync_pending) {
+        log_message(LOG_WARNING, "Hotplug events lost (%s), rescanning %s",
+                    reason, device_monitor_get_input_dir());
+        resync_pending = 1;
+    }
+
+    arm_debounce();
+}
+
+void hotplug_monitor_set_stream(const char *path) {
+    stream_path = path;
+}
+
+int hotplug_monitor_init(hotplug_backend_t backend) {
+    int ret;
+
+    switch (backend) {
+    case HOTPLUG_BACKEND_NETLINK:
+        ret = init_netlink_socket();
+        break;
+    case HOTPLUG_BACKEND_INOTIFY:
+        ret = init_inotify_monitor();
+        break;
+    case HOTPLUG_BACKEND_STREAM:
+        ret = stream_path ? init_uevent_stream(stream_path) : -1;
+        break;
+    default:
+        ret = -1;
+        break;
+    }
+
+    if (ret < 0) {
+        return -1;
+    }
+
+    // Without the timer every change is applied as it arrives
+    debounce_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (debounce_fd >= 0 && event_loop_add(debounce_fd, EPOLLIN, debounce_expired, NULL) < 0) {
+        close(debounce_fd);
+        debounce_fd = -1;
+    }
+    if (debounce_fd < 0) {
+        log_message(LOG_WARNING, "Hotplug debouncing unavailable");
+    }
+
+    memset(&window_stats, 0, sizeof(window_stats));
+    pending_count = 0;
+    resync_pending = 0;
+    debounce_armed = 0;
+
+    active_backend = backend;
+    initialized = 1;
+    log_message(LOG_INFO, "Using %s hotplug backend", hotplug_backend_name(backend));
+    return 0;
+}
+
+int hotplug_monitor_start(void) {
+    if (!initialized) {
+        return -1;
+    }
+
+    switch (active_backend) {
+    case HOTPLUG_BACKEND_INOTIFY:
+        return start_inotify_monitor();
+    case HOTPLUG_BACKEND_STREAM:
+        return start_uevent_stream();
+    default:
+        return start_netlink_monitor();
+    }
+}
+
+void hotplug_monitor_stop(void) {
+    if (!initialized) {
+        return;
+    }
+
+    switch (active_backend) {
+    case HOTPLUG_BACKEND_INOTIFY:
+        close_inotify_monitor();
+        break;
+    case HOTPLUG_BACKEND_STREAM:
+        close_uevent_stream();
+        break;
+    default:
+        close_netlink_socket();
+        break;
+    }
+
+    // Changes still in the window are of no use when shutting down
+    if (debounce_fd >= 0) {
+        event_loop_remove(debounce_fd);
+        close(debounce_fd);
+        debounce_fd = -1;
+    }
+    pending_count = 0;
+    resync_pending = 0;
+
+    initialized = 0;
+}
+
+void hotplug_monitor_get_stats(hotplug_stats_t *stats) {
+    // Streamed uevents are counted by the shared uevent parser
+    if (active_backend == HOTPLUG_BACKEND_INOTIFY) {
+        inotify_monitor_get_stats(stats);
+    } else {
+        netlink_monitor_get_stats(stats);
+    }
+
+    stats->coalesced = window_stats.coalesced;
+    stats->overflows = window_stats.overflows;
+    stats->resyncs = window_stats.resyncs;
+}
+
+const char *hotplug_backend_name(hotplug_backend_t backend) {
+    switch (backend) {
+    case HOTPLUG_BACKEND_NETLINK:
+        return "netlink";
+    case HOTPLUG_BACKEND_INOTIFY:
+        return "inotify";
+    case HOTPLUG_BACKEND_STREAM:
+        return "stream";
+    default:
+        return "unknown";
+    }
+}
+
+int hotplug_backend_from_name(const char *name, hotplug_backend_t *backend) {
+    if (strcmp(name, "netlink") == 0) {
+        *backend = HOTPLUG_BACKEND_NETLINK;
+    } else if (strcmp(name, "inotify") == 0) {
+        *backend = HOTPLUG_BACKEND_INOTIFY;
+    } else if (strcmp(name, "stream") == 0) {
+        *backend = HOTPLUG_BACKEND_STREAM;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file inotify_monitor.c
+ * @brief Implementation of the inotify hotplug backend
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include "../include/inotify_monitor.h"
+#include "../include/device_monitor.h"
+#include "../include/event_loop.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+#define INOTIFY_MASK (IN_CREATE | IN_ATTRIB | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM)
+
+static int in_fd = -1;
+static hotplug_stats_t in_stats;
+
+int init_inotify_monitor(void) {
+    in_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (in_fd < 0) {
+        log_message(LOG_ERR, "Failed to create inotify instance: %s", strerror(errno));
+        return -1;
+    }
+
+    if (inotify_add_watch(in_fd, device_monitor_get_input_dir(), INOTIFY_MASK) < 0) {
+        log_message(LOG_ERR, "Failed to watch %s: %s", device_monitor_get_input_dir(), strerror(errno));
+        close(in_fd);
+        in_fd = -1;
+        return -1;
+    }
+
+    memset(&in_stats, 0, sizeof(in_stats));
+    log_message(LOG_INFO, "inotify monitor initialized on %s", device_monitor_get_input_dir());
+    return 0;
+}
+
+int start_inotify_monitor(void) {
+    if (event_loop_add(in_fd, EPOLLIN, inotify_monitor_handle_event, NULL) < 0) {
+        log_message(LOG_ERR, "Failed to register inotify descriptor with event loop");
+        return -1;
+    }
+
+    log_message(LOG_INFO, "inotify event monitoring started");
+    return 0;
+}
+
+void close_inotify_monitor(void) {
+    if (in_fd >= 0) {
+        event_loop_remove(in_fd);
+        close(in_fd);
+        in_fd = -1;
+    }
+}
+
+static void process_inotify_event(const struct inotify_event *ev, uint64_t received_ns) {
+    char path[512];
+
+    if (ev->mask & IN_Q_OVERFLOW) {
+        // Events were lost, so the directory is the only source of truth
+        hotplug_monitor_request_resync("inotify queue overflow");
+        return;
+    }
+
+    if (ev->len == 0 || strncmp(ev->name, "event", 5) != 0) {
+        in_stats.dropped++;
+        return;
+    }
+
+    if (snprintf(path, sizeof(path), "%s/%s", device_monitor_get_input_dir(), ev->name) >= (int)sizeof(path)) {
+        in_stats.dropped++;
+        return;
+    }
+
+    in_stats.accepted++;
+
+    // udev may only make the node accessible with a later chmod (IN_ATTRIB)
+    if (ev->mask & (IN_CREATE | IN_ATTRIB | IN_MOVED_TO)) {
+        log_message(LOG_INFO, "Input device event: add %s", path);
+        hotplug_monitor_queue(HOTPLUG_ADD, path, 0, received_ns);
+    } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        log_message(LOG_INFO, "Input device event: remove %s", path);
+        hotplug_monitor_queue(HOTPLUG_REMOVE, path, 0, received_ns);
+    }
+}
+
+void inotify_monitor_handle_event(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    uint64_t received_ns;
+    ssize_t len;
+
+    for (;;) {
+        len = read(fd, buffer, sizeof(buffer));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                log_message(LOG_ERR, "Error reading inotify events: %s", strerror(errno));
+            }
+            break;
+        }
+
+        received_ns = latency_now();
+        for (char *ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)ptr;
+            process_inotify_event(ev, received_ns);
+            ptr += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+}
+
+void inotify_monitor_get_stats(hotplug_stats_t *stats) {
+    *stats = in_stats;
+}
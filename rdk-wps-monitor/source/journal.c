@@ -0,0 +1,177 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file journal.c
+ * @brief Implementation of the binary event journal
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <syslog.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+#define JOURNAL_SIZE (JOURNAL_HEADER_SIZE + JOURNAL_RECORDS * sizeof(journal_record_t))
+
+// Set once at startup, before any writer runs
+static journal_header_t *header = NULL;
+static journal_record_t *records = NULL;
+
+// Serializes additions to the action name table
+static pthread_mutex_t names_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int header_valid(const journal_header_t *h) {
+    return memcmp(h->magic, JOURNAL_MAGIC, sizeof(h->magic)) == 0 &&
+           h->version == JOURNAL_VERSION &&
+           h->record_size == sizeof(journal_record_t) &&
+           h->records == JOURNAL_RECORDS &&
+           h->action_count <= JOURNAL_ACTIONS;
+}
+
+int journal_open(const char *path) {
+    struct timespec mono, real;
+    struct stat st;
+    void *map;
+    int fd;
+
+    if (!path) {
+        path = JOURNAL_FILE;
+    }
+
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_message(LOG_WARNING, "Failed to open journal %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    // A file of another size has another layout; start over
+    if (fstat(fd, &st) < 0 || (st.st_size != (off_t)JOURNAL_SIZE &&
+                               (ftruncate(fd, 0) < 0 || ftruncate(fd, JOURNAL_SIZE) < 0))) {
+        log_message(LOG_WARNING, "Failed to size journal %s: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // Populated up front so writes from the event path never fault
+    map = mmap(NULL, JOURNAL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        log_message(LOG_WARNING, "Failed to map journal %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    header = (journal_header_t *)map;
+    records = (journal_record_t *)((char *)map + JOURNAL_HEADER_SIZE);
+
+    if (!header_valid(header)) {
+        memset(map, 0, JOURNAL_SIZE);
+        memcpy(header->magic, JOURNAL_MAGIC, sizeof(header->magic));
+        header->version = JOURNAL_VERSION;
+        header->record_size = sizeof(journal_record_t);
+        header->records = JOURNAL_RECORDS;
+    }
+
+    // Lets the decoder print wall clock times for this run
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    header->realtime_offset_ns = ((int64_t)real.tv_sec - mono.tv_sec) * 1000000000LL +
+                                 (real.tv_nsec - mono.tv_nsec);
+
+    log_message(LOG_INFO, "Journal %s holds %d records, next is %u", path, JOURNAL_RECORDS,
+                header->next_seq);
+    journal_write(JOURNAL_START, 0, 0, (int)getpid(), JOURNAL_NO_ACTION, 0);
+    return 0;
+}
+
+void journal_close(void) {
+    if (header) {
+        munmap(header, JOURNAL_SIZE);
+        header = NULL;
+        records = NULL;
+    }
+}
+
+unsigned int journal_action_id(const char *name) {
+    unsigned int id;
+
+    if (!header) {
+        return JOURNAL_NO_ACTION;
+    }
+
+    pthread_mutex_lock(&names_mutex);
+
+    // Actions are recreated on every config reload; reuse their names
+    for (id = 0; id < header->action_count; id++) {
+        if (strncmp(header->actions[id], name, JOURNAL_ACTION_NAME_MAX - 1) == 0) {
+            break;
+        }
+    }
+
+    if (id == header->action_count) {
+        if (id == JOURNAL_ACTIONS) {
+            id = JOURNAL_NO_ACTION;
+        } else {
+            snprintf(header->actions[id], JOURNAL_ACTION_NAME_MAX, "%s", name);
+            header->action_count++;
+        }
+    }
+
+    pthread_mutex_unlock(&names_mutex);
+    return id;
+}
+
+void journal_write(journal_type_t type, dev_t dev, int code, int value, unsigned int action,
+                   uint64_t latency_ns) {
+    journal_record_t *r;
+    uint32_t seq;
+
+    if (!records) {
+        return;
+    }
+
+    seq = __atomic_fetch_add(&header->next_seq, 1, __ATOMIC_RELAXED);
+    r = &records[seq & (JOURNAL_RECORDS - 1)];
+
+    // Invalidate first so a reader never pairs the old seq with new fields
+    __atomic_store_n(&r->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    r->time_ns = latency_now();
+    r->dev = (major(dev) << 20) | (minor(dev) & 0xfffff);
+    r->type = (uint16_t)type;
+    r->code = (uint16_t)code;
+    r->value = value;
+    r->latency_us = latency_ns / 1000 > UINT32_MAX ? UINT32_MAX : (uint32_t)(latency_ns / 1000);
+    r->action = (uint16_t)action;
+    r->reserved = 0;
+
+    // Sequence numbers start at 1 so a zero slot reads as empty
+    __atomic_store_n(&r->seq, seq + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,247 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file latency.c
+ * @brief Implementation of the latency histograms
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <syslog.h>
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+#define SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define MAX_VALUE ((UINT64_C(1) << LATENCY_MAX_BITS) - 1)
+#define QUANTILES 4
+
+/*
+ * Histograms of one thread. Only the owning thread writes; readers merge
+ * with relaxed loads and may see a sample in the count before the sum.
+ */
+typedef struct latency_thread {
+    uint64_t counts[LATENCY_STAGE_COUNT][LATENCY_BUCKETS];
+    uint64_t sum_ns[LATENCY_STAGE_COUNT];
+    uint64_t max_ns[LATENCY_STAGE_COUNT];
+    struct latency_thread *next;
+} latency_thread_t;
+
+static const char *stage_names[LATENCY_STAGE_COUNT] = {
+    "kernel->read",
+    "read->callback",
+    "callback->ack",
+    "uevent->monitored",
+};
+
+// Lock-free list of every thread that recorded a sample; never shrinks
+static latency_thread_t *threads = NULL;
+static __thread latency_thread_t *local = NULL;
+
+/*
+ * Log-linear bucketing as in HdrHistogram: values below SUB_BUCKETS get
+ * their own bucket, above that each power of two is split SUB_BUCKETS ways.
+ */
+static unsigned int bucket_index(uint64_t value) {
+    unsigned int exp;
+
+    if (value < SUB_BUCKETS) {
+        return (unsigned int)value;
+    }
+    if (value > MAX_VALUE) {
+        value = MAX_VALUE;
+    }
+
+    exp = 63 - (unsigned int)__builtin_clzll(value);
+    return ((exp - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) +
+           (unsigned int)((value >> (exp - LATENCY_SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+// Highest value that lands in a bucket
+static uint64_t bucket_upper(unsigned int index) {
+    unsigned int exp;
+    uint64_t sub;
+
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    exp = (index >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+    sub = SUB_BUCKETS + (index & (SUB_BUCKETS - 1));
+    return ((sub + 1) << (exp - LATENCY_SUB_BITS)) - 1;
+}
+
+static latency_thread_t *local_histograms(void) {
+    latency_thread_t *t = local;
+
+    if (t) {
+        return t;
+    }
+
+    t = calloc(1, sizeof(*t));
+    if (!t) {
+        return NULL;
+    }
+
+    t->next = __atomic_load_n(&threads, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&threads, &t->next, t, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+
+    local = t;
+    return t;
+}
+
+uint64_t latency_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t latency_from_timeval(const struct timeval *tv) {
+    return (uint64_t)tv->tv_sec * 1000000000ULL + (uint64_t)tv->tv_usec * 1000ULL;
+}
+
+void latency_record(latency_stage_t stage, uint64_t start_ns, uint64_t end_ns) {
+    latency_thread_t *t;
+    uint64_t value;
+    unsigned int index;
+
+    if (stage >= LATENCY_STAGE_COUNT || end_ns < start_ns || !(t = local_histograms())) {
+        return;
+    }
+
+    value = end_ns - start_ns;
+    index = bucket_index(value);
+
+    // Single writer per record, so plain read-modify-write is enough
+    __atomic_store_n(&t->counts[stage][index], t->counts[stage][index] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&t->sum_ns[stage], t->sum_ns[stage] + value, __ATOMIC_RELAXED);
+    if (value > t->max_ns[stage]) {
+        __atomic_store_n(&t->max_ns[stage], value, __ATOMIC_RELAXED);
+    }
+}
+
+void latency_get_summary(latency_stage_t stage, latency_summary_t *summary) {
+    static const unsigned int permille[] = { 500, 900, 990, 999 };
+    uint64_t *quantiles[] = { &summary->p50_ns, &summary->p90_ns, &summary->p99_ns, &summary->p999_ns };
+    uint64_t *counts;
+    uint64_t sum = 0;
+    uint64_t seen = 0;
+    size_t next = 0;
+
+    memset(summary, 0, sizeof(*summary));
+    if (stage >= LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    counts = calloc(LATENCY_BUCKETS, sizeof(*counts));
+    if (!counts) {
+        return;
+    }
+
+    for (latency_thread_t *t = __atomic_load_n(&threads, __ATOMIC_ACQUIRE); t; t = t->next) {
+        for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+            uint64_t n = __atomic_load_n(&t->counts[stage][i], __ATOMIC_RELAXED);
+            counts[i] += n;
+            summary->count += n;
+        }
+        sum += __atomic_load_n(&t->sum_ns[stage], __ATOMIC_RELAXED);
+
+        uint64_t max = __atomic_load_n(&t->max_ns[stage], __ATOMIC_RELAXED);
+        if (max > summary->max_ns) {
+            summary->max_ns = max;
+        }
+    }
+
+    if (summary->count == 0) {
+        free(counts);
+        return;
+    }
+
+    summary->mean_ns = sum / summary->count;
+
+    for (unsigned int i = 0; i < LATENCY_BUCKETS && next < QUANTILES; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        if (seen == 0) {
+            summary->min_ns = i < SUB_BUCKETS ? i : bucket_upper(i - 1) + 1;
+        }
+        seen += counts[i];
+
+        // Report the bucket's upper bound, but never more than the true max
+        while (next < QUANTILES && seen * 1000 >= summary->count * permille[next]) {
+            uint64_t value = bucket_upper(i);
+            *quantiles[next++] = value < summary->max_ns ? value : summary->max_ns;
+        }
+    }
+
+    free(counts);
+}
+
+const char *latency_stage_name(latency_stage_t stage) {
+    return stage < LATENCY_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
+
+void latency_dump(FILE *f) {
+    latency_summary_t s;
+
+    fprintf(f, "%-18s %10s %10s %10s %10s %10s %10s %10s %10s\n", "stage (us)",
+            "count", "min", "mean", "p50", "p90", "p99", "p99.9", "max");
+
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        latency_get_summary((latency_stage_t)stage, &s);
+        fprintf(f, "%-18s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                stage_names[stage], (unsigned long long)s.count,
+                s.min_ns / 1000.0, s.mean_ns / 1000.0, s.p50_ns / 1000.0, s.p90_ns / 1000.0,
+                s.p99_ns / 1000.0, s.p999_ns / 1000.0, s.max_ns / 1000.0);
+    }
+}
+
+int latency_write_file(const char *path) {
+    char tmp_path[512];
+    FILE *f;
+
+    // Readers never see a half-written file
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        return -1;
+    }
+
+    f = fopen(tmp_path, "w");
+    if (!f) {
+        log_message(LOG_WARNING, "Could not create stats file %s: %s", tmp_path, strerror(errno));
+        return -1;
+    }
+
+    latency_dump(f);
+
+    if (fclose(f) != 0 || rename(tmp_path, path) < 0) {
+        log_message(LOG_WARNING, "Could not write stats file %s: %s", path, strerror(errno));
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
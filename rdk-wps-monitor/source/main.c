@@ -27,20 +27,67 @@
 #include <string.h>
 #include <signal.h>
 #include <unistd.h>
+#include <errno.h>
 #include <syslog.h>
 #include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 
 #include "../include/utils.h"
+#include "../include/action_queue.h"
+#include "../include/action_plugin.h"
 #include "../include/button_callback.h"
+#include "../include/button_config.h"
+#include "../include/control_socket.h"
 #include "../include/device_monitor.h"
-#include "../include/netlink_monitor.h"
+#include "../include/event_filter.h"
+#include "../include/event_loop.h"
+#include "../include/gpio_source.h"
+#include "../include/hotplug_monitor.h"
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/rbus_client.h"
+#include "../include/rbus_provider.h"
+#include "../include/realtime.h"
+#include "../include/uring_reader.h"
+#include "../include/wps_session.h"
 
 #define PID_FILE "/var/run/netlink-button-monitor.pid"
+#define MAX_CLI_ENTRIES 8 // Per repeatable option
 
 // Signal handler
 static void sigterm_handler(int sig) {
     log_message(LOG_NOTICE, "Caught signal %d, cleaning up and exiting...", sig);
-    set_running_state(false);
+    event_loop_stop();
+}
+
+// SIGUSR1 arrives through a signalfd, so the dump runs on the loop thread
+static void stats_signal_handler(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    const char *stats_file = (const char *)ctx;
+    struct signalfd_siginfo info;
+    
+    while (read(fd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+        if (latency_write_file(stats_file) == 0) {
+            log_message(LOG_INFO, "Latency statistics written to %s", stats_file);
+        }
+    }
+}
+
+// Parse a window in milliseconds
+static int parse_ms(const char *arg, unsigned int *ms) {
+    char *end;
+    unsigned long value;
+
+    errno = 0;
+    value = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno != 0 || value > 10000 || arg[0] == '-') {
+        return -1;
+    }
+
+    *ms = (unsigned int)value;
+    return 0;
 }
 
 // Show usage
@@ -50,14 +97,48 @@ static void show_usage(const char *prog_name) {
     printf("  -f, --foreground     Run in foreground (not as daemon)\n");
     printf("  -c, --custom-callback Use custom WPS button callback\n");
     printf("  -d, --debug          Enable debug output\n");
+    printf("  -a, --all-devices    Monitor every input device, not only button-capable ones\n");
+    printf("  -H, --hotplug <name> Hotplug backend: netlink (default) or inotify\n");
+    printf("  -B, --read-backend <name> Device and uevent reads: read (default) or io_uring\n");
+    printf("  -I, --input-dir <dir> Directory holding the evdev nodes (default %s)\n", INPUT_DEVICE_DIR);
+    printf("  -U, --uevent-stream <file> Read uevents from a FIFO or recorded file instead\n");
+    printf("  -D, --debounce <ms>  Drop button chatter within this window, 0 disables (default %d)\n", EVENT_FILTER_DEBOUNCE_MS);
+    printf("  -X, --dedupe <ms>    Drop presses another device reported within this window, 0 disables (default %d)\n", EVENT_FILTER_DEDUPE_MS);
+    printf("  -G, --gpio <line>:<key>[:<debounce ms>][:active-high] Button on a named GPIO line (repeatable)\n");
+    printf("  -C, --config <file>  Button table, reloaded when it changes (default %s)\n", BUTTON_CONFIG_FILE);
+    printf("  -P, --plugin <file.so> Load an action plugin module (repeatable)\n");
+    printf("  -A, --action <plugin:arg> Extra action for the custom WPS callback (repeatable)\n");
+    printf("  -S, --control-socket <path> Control socket for runtime commands (default %s)\n", CONTROL_SOCKET_PATH);
+    printf("  -W, --wps-status <name> Parameter below Device.WiFi.AccessPoint.{i}.WPS. reporting session progress (default %s)\n", RBUS_CLIENT_WPS_STATUS);
+    printf("  -R, --realtime <prio>[:<cpu>] Run the event loop SCHED_FIFO, optionally pinned, with memory locked\n");
+    printf("  -J, --journal <file> Binary event journal, \"none\" to disable (default %s)\n", JOURNAL_FILE);
+    printf("  -s, --stats-file <file> Latency statistics written on SIGUSR1 (default %s)\n", LATENCY_STATS_FILE);
     printf("  -h, --help           Show this help message\n");
 }
 
 // Main function
 int main(int argc, char *argv[]) {
-    pthread_t netlink_thread;
+    action_queue_stats_t queue_stats;
+    wps_session_stats_t wps_stats;
+    hotplug_stats_t hotplug_stats;
+    hotplug_backend_t hotplug_backend = HOTPLUG_BACKEND_NETLINK;
     bool daemon_mode = true; // Run as daemon by default
     bool use_custom_callback = false;
+    bool use_io_uring = false;
+    bool use_realtime = false;
+    realtime_config_t realtime;
+    event_filter_config_t filter = { EVENT_FILTER_DEBOUNCE_MS, EVENT_FILTER_DEDUPE_MS };
+    event_filter_stats_t filter_stats;
+    const char *stats_file = LATENCY_STATS_FILE;
+    const char *config_file = BUTTON_CONFIG_FILE;
+    const char *control_path = CONTROL_SOCKET_PATH;
+    const char *journal_file = JOURNAL_FILE;
+    sigset_t stats_signals;
+    int stats_fd;
+    const char *plugin_paths[MAX_CLI_ENTRIES];
+    const char *action_specs[MAX_CLI_ENTRIES];
+    int plugin_count = 0;
+    int action_count = 0;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -67,6 +148,115 @@ int main(int argc, char *argv[]) {
             use_custom_callback = true;
         } else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--debug") == 0) {
             set_debug_mode(true);
+        } else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--all-devices") == 0) {
+            device_monitor_set_watched_keys(NULL, 0);
+        } else if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--hotplug") == 0) {
+            if (i + 1 >= argc || hotplug_backend_from_name(argv[i + 1], &hotplug_backend) < 0) {
+                fprintf(stderr, "Invalid or missing hotplug backend\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-B") == 0 || strcmp(argv[i], "--read-backend") == 0) {
+            if (i + 1 >= argc || (strcmp(argv[i + 1], "read") != 0 && strcmp(argv[i + 1], "io_uring") != 0)) {
+                fprintf(stderr, "Invalid or missing read backend\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            use_io_uring = strcmp(argv[++i], "io_uring") == 0;
+        } else if (strcmp(argv[i], "-I") == 0 || strcmp(argv[i], "--input-dir") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing input directory\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            device_monitor_set_input_dir(argv[++i]);
+        } else if (strcmp(argv[i], "-U") == 0 || strcmp(argv[i], "--uevent-stream") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing uevent stream\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            hotplug_backend = HOTPLUG_BACKEND_STREAM;
+            hotplug_monitor_set_stream(argv[++i]);
+        } else if (strcmp(argv[i], "-D") == 0 || strcmp(argv[i], "--debounce") == 0) {
+            if (i + 1 >= argc || parse_ms(argv[i + 1], &filter.debounce_ms) < 0) {
+                fprintf(stderr, "Invalid or missing debounce window\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-X") == 0 || strcmp(argv[i], "--dedupe") == 0) {
+            if (i + 1 >= argc || parse_ms(argv[i + 1], &filter.dedupe_ms) < 0) {
+                fprintf(stderr, "Invalid or missing dedupe window\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-G") == 0 || strcmp(argv[i], "--gpio") == 0) {
+            if (i + 1 >= argc || gpio_source_add(argv[i + 1]) < 0) {
+                fprintf(stderr, "Invalid or missing GPIO line or too many lines\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-C") == 0 || strcmp(argv[i], "--config") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing config file\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            config_file = argv[++i];
+        } else if (strcmp(argv[i], "-P") == 0 || strcmp(argv[i], "--plugin") == 0) {
+            if (i + 1 >= argc || plugin_count == MAX_CLI_ENTRIES) {
+                fprintf(stderr, "Missing plugin module or too many plugins\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            plugin_paths[plugin_count++] = argv[++i];
+        } else if (strcmp(argv[i], "-A") == 0 || strcmp(argv[i], "--action") == 0) {
+            if (i + 1 >= argc || action_count == MAX_CLI_ENTRIES) {
+                fprintf(stderr, "Missing action or too many actions\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            action_specs[action_count++] = argv[++i];
+        } else if (strcmp(argv[i], "-S") == 0 || strcmp(argv[i], "--control-socket") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing control socket path\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            control_path = argv[++i];
+        } else if (strcmp(argv[i], "-W") == 0 || strcmp(argv[i], "--wps-status") == 0) {
+            if (i + 1 >= argc || rbus_client_set_wps_status(argv[i + 1]) < 0) {
+                fprintf(stderr, "Invalid or missing WPS status parameter\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-R") == 0 || strcmp(argv[i], "--realtime") == 0) {
+            if (i + 1 >= argc || realtime_parse(argv[i + 1], &realtime) < 0) {
+                fprintf(stderr, "Invalid or missing real-time priority\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            use_realtime = true;
+            i++;
+        } else if (strcmp(argv[i], "-J") == 0 || strcmp(argv[i], "--journal") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing journal file\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            journal_file = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--stats-file") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Missing statistics file\n");
+                show_usage(argv[0]);
+                return 1;
+            }
+            stats_file = argv[++i];
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             show_usage(argv[0]);
             return 0;
@@ -77,6 +267,11 @@ int main(int argc, char *argv[]) {
     signal(SIGTERM, sigterm_handler);
     signal(SIGINT, sigterm_handler);
     
+    // Block SIGUSR1 before any thread starts; it is read from a signalfd
+    sigemptyset(&stats_signals);
+    sigaddset(&stats_signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &stats_signals, NULL);
+    
     // Run as daemon if requested
     if (daemon_mode && !get_debug_mode()) {
         if (daemonize() < 0) {
@@ -88,38 +283,127 @@ int main(int argc, char *argv[]) {
         log_init(false, get_debug_mode());
     }
     
+    // Before any thread starts, so memory locking does not pin 8 MiB stacks
+    if (use_realtime) {
+        realtime_prepare();
+    }
+    
+    // Move log formatting off the event path; flushed again on exit, so every
+    // return below stops the action worker and leaves rbus first
+    if (log_start_writer() == 0) {
+        atexit(log_stop_writer);
+    }
+    
     log_message(LOG_NOTICE, "Netlink button monitor daemon starting up");
     
-    // Initialize device monitoring subsystem
+    // Open the journal before actions are created so they get their names in it
+    if (strcmp(journal_file, "none") != 0 && journal_open(journal_file) < 0) {
+        log_message(LOG_WARNING, "Event journal unavailable");
+    }
+    
+    // Initialize the event loop that drives all input and netlink events
+    if (event_loop_init() < 0) {
+        log_message(LOG_ERR, "Failed to initialize event loop, exiting");
+        return 1;
+    }
+    
+    // Dump latency histograms on SIGUSR1; the daemon runs fine without it
+    stats_fd = signalfd(-1, &stats_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (stats_fd < 0 || event_loop_add(stats_fd, EPOLLIN, stats_signal_handler, (void *)stats_file) < 0) {
+        log_message(LOG_WARNING, "Latency statistics on SIGUSR1 unavailable");
+    }
+    
+    // Devices and the uevent socket fall back to read() without a ring
+    if (use_io_uring && uring_reader_init() < 0) {
+        log_message(LOG_WARNING, "io_uring reads unavailable, using read()");
+    }
+    
+    // Start the worker that runs button actions off the input path
+    if (action_queue_init(ACTION_QUEUE_DEFAULT_CAPACITY) < 0 || button_callback_init() < 0 ||
+        action_queue_start() < 0) {
+        log_message(LOG_ERR, "Failed to initialize action dispatch, exiting");
+        action_queue_stop();
+        button_callback_cleanup();
+        event_loop_cleanup();
+        return 1;
+    }
+    
+    // Plugin modules and extra actions; a bad one only loses that action
+    for (int i = 0; i < plugin_count; i++) {
+        action_plugin_load(plugin_paths[i]);
+    }
+    for (int i = 0; i < action_count; i++) {
+        if (button_callback_add_custom_action(action_specs[i]) < 0) {
+            log_message(LOG_WARNING, "Ignoring action %s", action_specs[i]);
+        }
+    }
+    
+    // Compile the button table; it is swapped in again whenever the file changes
+    if (button_config_init(config_file) < 0) {
+        log_message(LOG_ERR, "Invalid button table %s, exiting", config_file);
+        action_queue_stop();
+        button_callback_cleanup();
+        event_loop_cleanup();
+        return 1;
+    }
+    
+    // Initialize device monitoring subsystem and its event filter
+    event_filter_set_config(&filter);
     if (device_monitor_init() < 0) {
         log_message(LOG_ERR, "Failed to initialize device monitoring, exiting");
+        action_queue_stop();
+        button_callback_cleanup();
+        event_loop_cleanup();
         return 1;
     }
     
-    // Initialize netlink socket
-    if (init_netlink_socket() < 0) {
-        log_message(LOG_ERR, "Failed to initialize netlink socket, exiting");
+    // Initialize the hotplug source; containers often have no uevent socket
+    if (hotplug_monitor_init(hotplug_backend) < 0 &&
+        (hotplug_backend != HOTPLUG_BACKEND_NETLINK ||
+         hotplug_monitor_init(HOTPLUG_BACKEND_INOTIFY) < 0)) {
+        log_message(LOG_ERR, "Failed to initialize hotplug monitoring, exiting");
         device_monitor_cleanup();
+        action_queue_stop();
+        button_callback_cleanup();
+        event_loop_cleanup();
         return 1;
     }
     
     // Scan for existing input devices and start monitoring
     scan_existing_devices();
     
+    // Buttons on GPIO lines; the evdev buttons work without them
+    if (gpio_source_init() < 0) {
+        log_message(LOG_WARNING, "Some GPIO lines are not monitored");
+    }
+    
     // Register custom callback if requested
     if (use_custom_callback) {
         log_message(LOG_INFO, "Using custom WPS button callback");
         register_button_callback(custom_wps_button_callback);
     }
     
-    // Start the netlink monitoring thread
-    if (start_netlink_monitor(&netlink_thread) < 0) {
-        log_message(LOG_ERR, "Failed to start netlink monitoring thread, exiting");
-        close_netlink_socket();
+    // Start hotplug monitoring on the event loop
+    if (hotplug_monitor_start() < 0) {
+        log_message(LOG_ERR, "Failed to start hotplug monitoring, exiting");
+        hotplug_monitor_stop();
         device_monitor_cleanup();
+        action_queue_stop();
+        button_callback_cleanup();
+        event_loop_cleanup();
         return 1;
     }
     
+    // Runtime introspection is optional; buttons work without it
+    if (control_socket_init(control_path) < 0) {
+        log_message(LOG_WARNING, "Control socket unavailable");
+    }
+    
+    // Push button events to rbus subscribers; buttons work without it
+    if (rbus_provider_init() < 0) {
+        log_message(LOG_WARNING, "Button events are not published on rbus");
+    }
+    
     // Write PID file for daemon management
     if (daemon_mode) {
         if (write_pid_file(PID_FILE) < 0) {
@@ -134,18 +418,74 @@ int main(int argc, char *argv[]) {
         print_monitored_devices();
     }
     
-    // Main thread - just wait for signals or thread completion
-    pthread_join(netlink_thread, NULL);
+    // Every other thread has started, so only the loop becomes real-time
+    if (use_realtime && realtime_enter(&realtime) < 0) {
+        log_message(LOG_WARNING, "Real-time mode only partly applied");
+    }
+    
+    // Main thread - run the event loop until a signal stops it
+    if (event_loop_run() < 0) {
+        log_message(LOG_ERR, "Event loop terminated abnormally");
+    }
     
     // Cleanup
     log_message(LOG_NOTICE, "Netlink button monitor daemon shutting down");
     
-    // Close the netlink socket
-    close_netlink_socket();
+    // No more commands once the loop has stopped
+    control_socket_cleanup();
+    
+    // Publish what is still queued and leave rbus
+    rbus_provider_cleanup();
+    
+    // Close the hotplug source
+    hotplug_monitor_get_stats(&hotplug_stats);
+    log_message(LOG_INFO, "Hotplug events: accepted %lu, dropped %lu, coalesced %lu, overflows %lu, resyncs %lu",
+                hotplug_stats.accepted, hotplug_stats.dropped, hotplug_stats.coalesced,
+                hotplug_stats.overflows, hotplug_stats.resyncs);
+    hotplug_monitor_stop();
     
     // Clean up device monitoring
+    event_filter_get_stats(&filter_stats);
+    log_message(LOG_INFO, "Key events: passed %lu, debounced %lu, settled %lu, deduplicated %lu, untracked %lu",
+                filter_stats.passed, filter_stats.debounced, filter_stats.settled,
+                filter_stats.deduplicated, filter_stats.untracked);
+    gpio_source_cleanup();
     device_monitor_cleanup();
     
+    // Stop the action worker and report dispatch counters
+    action_queue_stop();
+    action_queue_get_stats(&queue_stats);
+    log_message(LOG_INFO, "Actions: submitted %lu, executed %lu, coalesced %lu, dropped %lu, max depth %u/%u",
+                queue_stats.submitted, queue_stats.executed, queue_stats.coalesced,
+                queue_stats.dropped, queue_stats.max_depth, queue_stats.capacity);
+    wps_session_get_stats(&wps_stats);
+    log_message(LOG_INFO, "WPS sessions: %lu started, %lu succeeded, %lu timed out, %lu failed, %lu extended, %lu presses ignored",
+                wps_stats.sessions, wps_stats.succeeded, wps_stats.timed_out, wps_stats.failed,
+                wps_stats.extended, wps_stats.ignored);
+    button_callback_cleanup();
+    
+    // Leave the final latency figures behind
+    if (latency_write_file(stats_file) == 0) {
+        log_message(LOG_INFO, "Latency statistics written to %s", stats_file);
+    }
+    
+    // Every thread that writes records has stopped
+    journal_close();
+    
+    // Release the event loop
+    if (stats_fd >= 0) {
+        event_loop_remove(stats_fd);
+        close(stats_fd);
+    }
+    uring_reader_cleanup();
+    event_loop_cleanup();
+    
+    // Flush pending log messages
+    if (log_get_dropped() > 0) {
+        log_message(LOG_WARNING, "Log messages dropped: %lu", log_get_dropped());
+    }
+    log_stop_writer();
+    
     // Remove PID file
     if (daemon_mode) {
         remove_pid_file(PID_FILE);
@@ -29,10 +29,16 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <syslog.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <sys/sysmacros.h>
 #include <linux/netlink.h>
 #include "../include/netlink_monitor.h"
 #include "../include/device_monitor.h"
+#include "../include/event_loop.h"
+#include "../include/latency.h"
+#include "../include/uevent_parser.h"
+#include "../include/uring_reader.h"
 #include "../include/utils.h"
 
 // Define UDEV netlink constants if not defined in headers
@@ -42,11 +48,19 @@
 
 // Global netlink socket
 static int nl_socket = -1;
+static int filter_attached = 0;
+static int via_ring = 0;
+static hotplug_stats_t nl_stats;
+static unsigned long long last_seqnum = 0;
+
+// Without the kernel filter every uevent is read, so a SEQNUM gap is a loss
+static int gaps_are_losses = 0;
 
 int init_netlink_socket(void) {
     struct sockaddr_nl nl_addr;
     int ret;
     int buf_size = 1024 * 1024; // 1MB buffer for netlink
+    socklen_t opt_len = sizeof(buf_size);
     
     // Create the netlink socket
     nl_socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_KOBJECT_UEVENT);
@@ -55,8 +69,15 @@ int init_netlink_socket(void) {
         return -1;
     }
     
-    // Increase the buffer size to avoid missing events
-    setsockopt(nl_socket, SOL_SOCKET, SO_RCVBUFFORCE, &buf_size, sizeof(buf_size));
+    // Increase the buffer size to avoid missing events; without
+    // CAP_NET_ADMIN the request is capped at rmem_max
+    if (setsockopt(nl_socket, SOL_SOCKET, SO_RCVBUFFORCE, &buf_size, sizeof(buf_size)) < 0 &&
+        setsockopt(nl_socket, SOL_SOCKET, SO_RCVBUF, &buf_size, sizeof(buf_size)) < 0) {
+        log_message(LOG_WARNING, "Failed to enlarge netlink receive buffer: %s", strerror(errno));
+    }
+    if (getsockopt(nl_socket, SOL_SOCKET, SO_RCVBUF, &buf_size, &opt_len) == 0) {
+        log_message(LOG_INFO, "Netlink receive buffer is %d bytes", buf_size);
+    }
     
     // Set socket to non-blocking
     int flags = fcntl(nl_socket, F_GETFL, 0);
@@ -75,6 +96,17 @@ int init_netlink_socket(void) {
         return -1;
     }
     
+    // Only wake up for input subsystem uevents
+    filter_attached = (uevent_filter_attach(nl_socket) == 0);
+    if (!filter_attached) {
+        log_message(LOG_WARNING, "Failed to attach uevent filter, filtering in user space: %s",
+                    strerror(errno));
+    }
+    
+    memset(&nl_stats, 0, sizeof(nl_stats));
+    last_seqnum = 0;
+    gaps_are_losses = !filter_attached;
+    
     // Set up socket address
     memset(&nl_addr, 0, sizeof(nl_addr));
     nl_addr.nl_family = AF_NETLINK;
@@ -96,80 +128,106 @@ int init_netlink_socket(void) {
 
 void close_netlink_socket(void) {
     if (nl_socket >= 0) {
+        if (via_ring) {
+            uring_reader_remove(nl_socket);
+        } else {
+            event_loop_remove(nl_socket);
+        }
         close(nl_socket);
         nl_socket = -1;
     }
 }
 
-int start_netlink_monitor(pthread_t *thread) {
-    // Create the netlink monitoring thread
-    if (pthread_create(thread, NULL, netlink_monitor_thread, NULL) != 0) {
-        log_message(LOG_ERR, "Failed to create netlink monitoring thread: %s", strerror(errno));
+int start_netlink_monitor(void) {
+    // Keep a multishot recv posted when the ring is set up
+    via_ring = uring_reader_enabled() && uring_reader_add(nl_socket, netlink_monitor_handle_read, NULL) == 0;
+    if (via_ring) {
+        log_message(LOG_INFO, "Netlink event monitoring started on io_uring");
+        return 0;
+    }
+    
+    // Hand the socket to the event loop
+    if (event_loop_add(nl_socket, EPOLLIN, netlink_monitor_handle_event, NULL) < 0) {
+        log_message(LOG_ERR, "Failed to register netlink socket with event loop");
         return -1;
     }
     
+    log_message(LOG_INFO, "Netlink event monitoring started");
     return 0;
 }
 
 void parse_netlink_message(const char *buffer, int len) {
-    // For debugging: log the entire message
-    if (get_debug_mode()) {
-        log_message(LOG_DEBUG, "Received netlink message (%d bytes):", len);
-        for (int i = 0; i < len && buffer[i]; i++) {
-            putchar(buffer[i]);
-        }
-        putchar('\n');
-    }
+    uint64_t received_ns = latency_now();
+    uevent_t ev;
+    uevent_str_t node;
+    char device_path[256];
     
-    // Variables to store extracted information
-    char device_path[256] = {0};
-    char action[32] = {0};
-    int is_input_device = 0;
+    if (uevent_parse(buffer, (size_t)len, &ev) < 0) {
+        nl_stats.dropped++;
+        return;
+    }
     
-    // Parse the buffer line by line
-    const char *ptr = buffer;
-    const char *end = buffer + len;
+    if (get_debug_mode()) {
+        log_message(LOG_DEBUG, "Received uevent (%d bytes): %.*s %.*s subsystem=%.*s seqnum=%llu",
+                    len, (int)ev.action.len, ev.action.ptr,
+                    (int)ev.devpath.len, ev.devpath.ptr ? ev.devpath.ptr : "",
+                    (int)ev.subsystem.len, ev.subsystem.ptr ? ev.subsystem.ptr : "",
+                    (unsigned long long)ev.seqnum);
+    }
     
-    while (ptr < end && *ptr) {
-        if (strncmp(ptr, "ACTION=", 7) == 0) {
-            strncpy(action, ptr + 7, sizeof(action) - 1);
-        }
-        else if (strncmp(ptr, "DEVNAME=", 8) == 0) {
-            if (strstr(ptr + 8, "input/event") != NULL) {
-                is_input_device = 1;
-                snprintf(device_path, sizeof(device_path), "/dev/%s", ptr + 8);
+    // With the kernel filter a SEQNUM gap is what it skipped, without it
+    // the gap is uevents the socket lost
+    if (ev.seqnum) {
+        if (last_seqnum && ev.seqnum > last_seqnum + 1) {
+            if (gaps_are_losses) {
+                log_message(LOG_WARNING, "uevent SEQNUM gap %llu..%llu",
+                            last_seqnum + 1, (unsigned long long)ev.seqnum - 1);
+                hotplug_monitor_request_resync("uevent SEQNUM gap");
+            } else {
+                nl_stats.dropped += ev.seqnum - last_seqnum - 1;
             }
         }
-        
-        // Move to next line
-        while (ptr < end && *ptr) ptr++;
-        ptr++; // Skip the null terminator
+        last_seqnum = ev.seqnum;
     }
     
-    // If we found an input device with an action
-    if (is_input_device && action[0]) {
-        log_message(LOG_INFO, "Input device event: %s %s", action, device_path);
-        
-        if (strcmp(action, "add") == 0) {
-            add_input_device(device_path);
-        }
-        else if (strcmp(action, "remove") == 0) {
-            remove_input_device(device_path);
-        }
+    // Only evdev nodes ("input/eventN") are of interest
+    if (!uevent_str_has_prefix(ev.devname, "input/event")) {
+        nl_stats.dropped++;
+        return;
+    }
+    nl_stats.accepted++;
+    
+    node.ptr = ev.devname.ptr + 6;
+    node.len = ev.devname.len - 6;
+    if (snprintf(device_path, sizeof(device_path), "%s/%.*s",
+                 device_monitor_get_input_dir(), (int)node.len, node.ptr) >= (int)sizeof(device_path)) {
+        log_message(LOG_WARNING, "Device name too long: %.*s", (int)ev.devname.len, ev.devname.ptr);
+        return;
+    }
+    
+    log_message(LOG_INFO, "Input device event: %.*s %s", (int)ev.action.len, ev.action.ptr, device_path);
+    
+    if (uevent_str_eq(ev.action, "add")) {
+        hotplug_monitor_queue(HOTPLUG_ADD, device_path, 0, received_ns);
+    }
+    else if (uevent_str_eq(ev.action, "remove")) {
+        // The node may already be gone, so pass the device number along
+        hotplug_monitor_queue(HOTPLUG_REMOVE, device_path,
+                              ev.major >= 0 && ev.minor >= 0 ? makedev(ev.major, ev.minor) : 0,
+                              received_ns);
     }
 }
 
-void *netlink_monitor_thread(void *arg) {
+void netlink_monitor_handle_event(int fd, uint32_t events, void *ctx) {
     /* Prevent unused parameter warning */
-    (void)arg;
+    (void)events;
+    (void)ctx;
     int ret;
     char buffer[8192];
     struct sockaddr_nl nladdr;
     struct msghdr msg;
     struct iovec iov;
     
-    log_message(LOG_INFO, "Netlink event monitoring thread started");
-    
     // Set up message structures
     memset(&nladdr, 0, sizeof(nladdr));
     nladdr.nl_family = AF_NETLINK;
@@ -177,7 +235,7 @@ void *netlink_monitor_thread(void *arg) {
     nladdr.nl_groups = 0;
     
     iov.iov_base = buffer;
-    iov.iov_len = sizeof(buffer);
+    iov.iov_len = sizeof(buffer) - 1;
     
     memset(&msg, 0, sizeof(msg));
     msg.msg_name = &nladdr;
@@ -185,18 +243,23 @@ void *netlink_monitor_thread(void *arg) {
     msg.msg_iov = &iov;
     msg.msg_iovlen = 1;
     
-    // Main event loop
-    while (get_running_state()) {
-        ret = recvmsg(nl_socket, &msg, 0);
+    // Drain all queued messages before returning to the loop
+    for (;;) {
+        ret = recvmsg(fd, &msg, 0);
         
         if (ret < 0) {
-            if (errno == EINTR || errno == EAGAIN) {
-                // Interrupted or would block - normal conditions
-                usleep(10000); // 10ms
+            if (errno == EINTR) {
                 continue;
             }
-            
-            log_message(LOG_ERR, "Error receiving netlink message: %s", strerror(errno));
+            // The receive buffer overflowed; the socket stays usable
+            if (errno == ENOBUFS) {
+                hotplug_monitor_request_resync("netlink receive buffer overrun");
+                continue;
+            }
+            // Anything else is retried when the loop reports the socket again
+            if (errno != EAGAIN) {
+                log_message(LOG_ERR, "Error receiving netlink message: %s", strerror(errno));
+            }
             break;
         }
         
@@ -206,7 +269,24 @@ void *netlink_monitor_thread(void *arg) {
             parse_netlink_message(buffer, ret);
         }
     }
+}
+
+void netlink_monitor_handle_read(int fd, const void *data, ssize_t len, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)fd;
+    (void)ctx;
     
-    log_message(LOG_INFO, "Netlink event monitoring thread terminated");
-    return NULL;
+    if (len > 0) {
+        parse_netlink_message((const char *)data, (int)len);
+    } else if (len == -ENOBUFS) {
+        // Either the socket overran or the ring ran out of buffers; only
+        // the first loses uevents, but they cannot be told apart
+        hotplug_monitor_request_resync("netlink receive buffer overrun");
+    } else if (len < 0) {
+        log_message(LOG_ERR, "Error receiving netlink message: %s", strerror((int)-len));
+    }
+}
+
+void netlink_monitor_get_stats(hotplug_stats_t *stats) {
+    *stats = nl_stats;
 }
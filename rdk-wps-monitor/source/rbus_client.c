@@ -0,0 +1,359 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file rbus_client.c
+ * @brief Implementation of the persistent rbus session
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <rbus.h>
+#include "../include/rbus_client.h"
+#include "../include/action_queue.h"
+#include "../include/utils.h"
+#include "../include/wps_session.h"
+
+#define AP_TABLE "Device.WiFi.AccessPoint."
+#define AP_WPS_ENABLE_EVENT AP_TABLE "*.WPS.Enable"
+#define AP_WPS_ENABLE_FMT AP_TABLE "%u.WPS.Enable"
+#define AP_WPS_STATUS_FMT AP_TABLE "*.WPS.%s"
+#define AP_PUSH_BUTTON_FMT AP_TABLE "%u.WPS.X_CISCO_COM_ActivatePushButton"
+#define FACTORY_RESET_PARAM "Device.X_CISCO_COM_DeviceControl.FactoryReset"
+#define FACTORY_RESET_VALUE "Router,Wifi,VoIP,Dect,MoCA"
+
+// Session and cache are only touched by the thread running actions
+static rbusHandle_t handle = NULL;
+static char ap_params[RBUS_CLIENT_MAX_APS][96];
+static int ap_count = 0;
+
+// Set from rbus event callbacks whenever the AccessPoint table changes
+static int cache_dirty = 1;
+
+// Rediscovers the access points on the action worker, off the press path
+static action_t *refresh_action = NULL;
+
+// Status parameter to subscribe to, see rbus_client_set_wps_status()
+static char wps_status_event[128] = AP_TABLE "*.WPS." RBUS_CLIENT_WPS_STATUS;
+
+static void ap_table_event_handler(rbusHandle_t h, rbusEvent_t const *event,
+                                   rbusEventSubscription_t *subscription) {
+    /* Prevent unused parameter warning */
+    (void)h;
+    (void)subscription;
+
+    log_message(LOG_INFO, "AccessPoint change (%s), refreshing WPS targets",
+                event->name ? event->name : "unknown");
+    __atomic_store_n(&cache_dirty, 1, __ATOMIC_RELEASE);
+    // Queued ahead of any later press; a storm coalesces into one refresh
+    action_queue_submit(refresh_action, "rbus", 0, NULL);
+}
+
+// Session progress reported by the WiFi agent drives the WPS state machine
+static void wps_status_event_handler(rbusHandle_t h, rbusEvent_t const *event,
+                                     rbusEventSubscription_t *subscription) {
+    /* Prevent unused parameter warning */
+    (void)h;
+    (void)subscription;
+    rbusValue_t value = event->data ? rbusObject_GetValue(event->data, "value") : NULL;
+    unsigned int instance;
+
+    if (!value || !event->name || sscanf(event->name, AP_TABLE "%u.", &instance) != 1) {
+        log_message(LOG_WARNING, "Malformed WPS status event %s", event->name ? event->name : "unknown");
+        return;
+    }
+    // The agent decides the type; anything but a string would crash GetString
+    if (rbusValue_GetType(value) != RBUS_STRING) {
+        log_message(LOG_WARNING, "Ignoring WPS status event %s: value is not a string (type %d)", event->name,
+                    (int)rbusValue_GetType(value));
+        return;
+    }
+
+    wps_session_status(instance, rbusValue_GetString(value, NULL));
+}
+
+int rbus_client_is_connection_error(int err) {
+    return err == RBUS_ERROR_BUS_ERROR ||
+           err == RBUS_ERROR_NOT_INITIALIZED ||
+           err == RBUS_ERROR_INVALID_HANDLE;
+}
+
+static void add_ap(unsigned int instance) {
+    if (ap_count == RBUS_CLIENT_MAX_APS) {
+        log_message(LOG_WARNING, "Too many access points, ignoring instance %u", instance);
+        return;
+    }
+
+    snprintf(ap_params[ap_count], sizeof(ap_params[ap_count]), AP_PUSH_BUTTON_FMT, instance);
+    ap_count++;
+}
+
+static void discover_access_points(void) {
+    rbusRowName_t *rows = NULL;
+    rbusError_t err;
+    char param[96];
+
+    // Events arriving during discovery mark the cache dirty again
+    __atomic_store_n(&cache_dirty, 0, __ATOMIC_RELEASE);
+    ap_count = 0;
+
+    err = rbusTable_getRowNames(handle, AP_TABLE, &rows);
+    if (err != RBUS_ERROR_SUCCESS || !rows) {
+        // Keep the historical 2.4 GHz and 5 GHz private access points
+        log_message(LOG_WARNING, "AccessPoint discovery failed (%d), using default instances", err);
+        add_ap(1);
+        add_ap(2);
+        return;
+    }
+
+    for (rbusRowName_t *row = rows; row; row = row->next) {
+        bool enabled = true;
+
+        snprintf(param, sizeof(param), AP_WPS_ENABLE_FMT, row->instNum);
+        // Only instances that explicitly report WPS as disabled are skipped
+        if (rbus_getBoolean(handle, param, &enabled) == RBUS_ERROR_SUCCESS && !enabled) {
+            continue;
+        }
+
+        add_ap(row->instNum);
+    }
+
+    rbusTable_freeRowNames(handle, rows);
+    log_message(LOG_INFO, "Discovered %d WPS-capable access points", ap_count);
+}
+
+static void session_close(void) {
+    if (!handle) {
+        return;
+    }
+
+    rbusEvent_Unsubscribe(handle, AP_TABLE);
+    rbusEvent_Unsubscribe(handle, AP_WPS_ENABLE_EVENT);
+    rbusEvent_Unsubscribe(handle, wps_status_event);
+    rbus_close(handle);
+    handle = NULL;
+}
+
+static int session_open(void) {
+    rbusError_t err;
+
+    err = rbus_open(&handle, RBUS_CLIENT_COMPONENT);
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_ERR, "Failed to open rbus session: %d", err);
+        handle = NULL;
+        return -1;
+    }
+
+    // Row add/remove and WPS enable changes invalidate the cache
+    err = rbusEvent_Subscribe(handle, AP_TABLE, ap_table_event_handler, NULL, 0);
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_WARNING, "Failed to subscribe to %s: %d", AP_TABLE, err);
+    }
+    err = rbusEvent_Subscribe(handle, AP_WPS_ENABLE_EVENT, ap_table_event_handler, NULL, 0);
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_WARNING, "Failed to subscribe to %s: %d", AP_WPS_ENABLE_EVENT, err);
+    }
+    err = rbusEvent_Subscribe(handle, wps_status_event, wps_status_event_handler, NULL, 0);
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_WARNING, "Failed to subscribe to %s, WPS sessions end with the walk time: %d",
+                    wps_status_event, err);
+    }
+
+    __atomic_store_n(&cache_dirty, 1, __ATOMIC_RELEASE);
+    log_message(LOG_INFO, "rbus session opened");
+    return 0;
+}
+
+static rbusError_t set_push_buttons(void) {
+    rbusProperty_t props[RBUS_CLIENT_MAX_APS];
+    rbusValue_t value;
+    rbusError_t err;
+
+    if (ap_count == 0) {
+        log_message(LOG_WARNING, "No WPS-capable access points to trigger");
+        return RBUS_ERROR_SUCCESS;
+    }
+
+    rbusValue_Init(&value);
+    rbusValue_SetBoolean(value, true);
+
+    for (int i = 0; i < ap_count; i++) {
+        rbusProperty_Init(&props[i], ap_params[i], value);
+        if (i > 0) {
+            rbusProperty_PushBack(props[0], props[i]);
+        }
+    }
+
+    // One round trip for every access point
+    err = rbus_setMulti(handle, ap_count, props[0], NULL);
+
+    for (int i = ap_count - 1; i >= 0; i--) {
+        rbusProperty_Release(props[i]);
+    }
+    rbusValue_Release(value);
+
+    return err;
+}
+
+int rbus_client_set_wps_status(const char *name) {
+    int len;
+
+    if (!*name || strchr(name, '.')) {
+        return -1;
+    }
+
+    len = snprintf(wps_status_event, sizeof(wps_status_event), AP_WPS_STATUS_FMT, name);
+    if (len < 0 || (size_t)len >= sizeof(wps_status_event)) {
+        snprintf(wps_status_event, sizeof(wps_status_event), AP_WPS_STATUS_FMT, RBUS_CLIENT_WPS_STATUS);
+        return -1;
+    }
+    return 0;
+}
+
+// A lost session gets exactly one reconnect attempt per operation
+static rbusError_t run_with_reconnect(rbusError_t (*operation)(const void *arg), const void *arg) {
+    rbusError_t err = RBUS_ERROR_NOT_INITIALIZED;
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!handle && session_open() < 0) {
+            return RBUS_ERROR_NOT_INITIALIZED;
+        }
+
+        err = operation(arg);
+        if (err == RBUS_ERROR_SUCCESS || !rbus_client_is_connection_error(err)) {
+            break;
+        }
+
+        log_message(LOG_WARNING, "rbus session lost (%d), reconnecting", err);
+        session_close();
+    }
+
+    return err;
+}
+
+static rbusError_t refresh(const void *arg) {
+    /* Prevent unused parameter warning */
+    (void)arg;
+
+    if (__atomic_load_n(&cache_dirty, __ATOMIC_ACQUIRE)) {
+        discover_access_points();
+    }
+    return RBUS_ERROR_SUCCESS;
+}
+
+static int refresh_run(const action_request_t *request, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)request;
+    (void)ctx;
+
+    return run_with_reconnect(refresh, NULL) == RBUS_ERROR_SUCCESS ? 0 : -1;
+}
+
+int rbus_client_init(void) {
+    if (!refresh_action) {
+        refresh_action = action_create("ap-refresh", refresh_run, NULL, 0);
+    }
+
+    if (session_open() < 0) {
+        return -1;
+    }
+
+    discover_access_points();
+    return 0;
+}
+
+void rbus_client_cleanup(void) {
+    session_close();
+    ap_count = 0;
+
+    // No more table events can submit it, and the worker has stopped
+    if (refresh_action) {
+        action_destroy(refresh_action);
+        refresh_action = NULL;
+    }
+}
+
+/*
+ * Press the button on every AP. Table events queue a refresh ahead of the
+ * press, so the cache is only still dirty here if no refresh covered the
+ * change yet: the first press after a failed start or a reconnect, or an
+ * event that arrived while a refresh was already running.
+ */
+static rbusError_t trigger_wps(const void *arg) {
+    /* Prevent unused parameter warning */
+    (void)arg;
+
+    if (__atomic_load_n(&cache_dirty, __ATOMIC_ACQUIRE)) {
+        discover_access_points();
+    }
+
+    return set_push_buttons();
+}
+
+typedef struct {
+    const char *name;
+    const char *value;
+} string_param_t;
+
+static rbusError_t set_string(const void *arg) {
+    const string_param_t *param = (const string_param_t *)arg;
+
+    return rbus_setStr(handle, param->name, param->value);
+}
+
+int rbus_client_trigger_wps(void) {
+    rbusError_t err = run_with_reconnect(trigger_wps, NULL);
+
+    if (err == RBUS_ERROR_SUCCESS) {
+        log_message(LOG_INFO, "WPS push button activated on %d access points", ap_count);
+        return 0;
+    }
+
+    // The AccessPoint set may have changed under us
+    __atomic_store_n(&cache_dirty, 1, __ATOMIC_RELEASE);
+    log_message(LOG_ERR, "Failed to activate WPS push button: %d", err);
+    return -1;
+}
+
+int rbus_client_factory_reset(void) {
+    string_param_t param = { FACTORY_RESET_PARAM, FACTORY_RESET_VALUE };
+    rbusError_t err = run_with_reconnect(set_string, &param);
+
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_ERR, "Failed to request factory reset: %d", err);
+        return -1;
+    }
+
+    log_message(LOG_NOTICE, "Factory reset requested");
+    return 0;
+}
+
+int rbus_client_set_string(const char *name, const char *value) {
+    string_param_t param = { name, value };
+    rbusError_t err = run_with_reconnect(set_string, &param);
+
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_ERR, "Failed to set %s: %d", name, err);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,367 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file rbus_provider.c
+ * @brief Implementation of the button event data elements
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <pthread.h>
+#include <rbus.h>
+#include "../include/rbus_provider.h"
+#include "../include/button_bus.h"
+#include "../include/gesture.h"
+#include "../include/rbus_client.h"
+#include "../include/utils.h"
+
+#define ROW_ELEMENT RBUS_PROVIDER_TABLE "{i}."
+#define CODE_ELEMENT RBUS_PROVIDER_TABLE "{i}.Code"
+#define EVENT_ELEMENT RBUS_PROVIDER_TABLE "{i}.Event"
+#define EVENT_FMT RBUS_PROVIDER_TABLE "%d.Event"
+#define TABLE_LEN (sizeof(RBUS_PROVIDER_TABLE) - 1)
+
+typedef struct {
+    int code;
+    char value[16];             /* Last event, empty before the first */
+    unsigned int subscribers;   /* Subscriptions to this row's Event */
+} button_row_t;
+
+// Same words as the gestures in the button table
+static const char *gesture_values[GESTURE_COUNT] = {
+    "short",
+    "long",
+    "double",
+};
+
+// Rows are added by the bus thread and read from rbus handler threads
+static pthread_mutex_t rows_mutex = PTHREAD_MUTEX_INITIALIZER;
+static button_row_t rows[RBUS_PROVIDER_MAX_BUTTONS];
+static int row_count = 0;
+static unsigned int wildcard_subscribers = 0;
+static int table_full_logged = 0;
+
+// Session and counters are only touched by the bus thread once it runs
+static rbusHandle_t handle = NULL;
+static int reconnect = 0;       /* Session lost to, or not opened for, a connection error */
+static button_bus_subscriber_t *subscriber = NULL;
+static unsigned long published = 0;
+static unsigned long unwatched = 0;
+
+// Instance number of a name below the table, 0 for '*', -1 if none
+static int name_instance(const char *name) {
+    const char *p = name + TABLE_LEN;
+    char *end;
+    long instance;
+
+    if (strncmp(name, RBUS_PROVIDER_TABLE, TABLE_LEN) != 0) {
+        return -1;
+    }
+    if (p[0] == '*' && p[1] == '.') {
+        return 0;
+    }
+
+    instance = strtol(p, &end, 10);
+    if (end == p || *end != '.' || instance < 1 || instance > RBUS_PROVIDER_MAX_BUTTONS) {
+        return -1;
+    }
+    return (int)instance;
+}
+
+static rbusError_t get_handler(rbusHandle_t h, rbusProperty_t property, rbusGetHandlerOptions_t *options) {
+    /* Prevent unused parameter warning */
+    (void)h;
+    (void)options;
+    const char *name = rbusProperty_GetName(property);
+    int instance = name_instance(name);
+    rbusValue_t value;
+
+    pthread_mutex_lock(&rows_mutex);
+    if (instance < 1 || instance > row_count) {
+        pthread_mutex_unlock(&rows_mutex);
+        return RBUS_ERROR_ELEMENT_DOES_NOT_EXIST;
+    }
+
+    // Served from the cache, never from the devices
+    rbusValue_Init(&value);
+    if (strcmp(strrchr(name, '.'), ".Code") == 0) {
+        rbusValue_SetInt32(value, rows[instance - 1].code);
+    } else {
+        rbusValue_SetString(value, rows[instance - 1].value);
+    }
+    pthread_mutex_unlock(&rows_mutex);
+
+    rbusProperty_SetValue(property, value);
+    rbusValue_Release(value);
+    return RBUS_ERROR_SUCCESS;
+}
+
+static rbusError_t event_sub_handler(rbusHandle_t h, rbusEventSubAction_t action, const char *eventName,
+                                     rbusFilter_t filter, int32_t interval, bool *autoPublish) {
+    /* Prevent unused parameter warning */
+    (void)h;
+    (void)filter;
+    (void)interval;
+    int instance = name_instance(eventName);
+    unsigned int *count;
+
+    if (instance < 0) {
+        return RBUS_ERROR_INVALID_EVENT;
+    }
+
+    // Events are pushed as they happen, rbus must not poll the get handler
+    if (autoPublish) {
+        *autoPublish = false;
+    }
+
+    pthread_mutex_lock(&rows_mutex);
+    count = instance ? &rows[instance - 1].subscribers : &wildcard_subscribers;
+    if (action == RBUS_EVENT_ACTION_SUBSCRIBE) {
+        (*count)++;
+    } else if (*count > 0) {
+        (*count)--;
+    }
+    pthread_mutex_unlock(&rows_mutex);
+
+    log_message(LOG_INFO, "rbus %s %s", action == RBUS_EVENT_ACTION_SUBSCRIBE ? "subscribed to" : "unsubscribed from",
+                eventName);
+    return RBUS_ERROR_SUCCESS;
+}
+
+static rbusDataElement_t data_elements[] = {
+    { ROW_ELEMENT, RBUS_ELEMENT_TYPE_TABLE, { NULL, NULL, NULL, NULL, NULL, NULL } },
+    { CODE_ELEMENT, RBUS_ELEMENT_TYPE_PROPERTY, { get_handler, NULL, NULL, NULL, NULL, NULL } },
+    { EVENT_ELEMENT, RBUS_ELEMENT_TYPE_PROPERTY, { get_handler, NULL, NULL, NULL, event_sub_handler, NULL } },
+};
+
+#define NUM_ELEMENTS ((int)(sizeof(data_elements) / sizeof(data_elements[0])))
+
+static void session_close(void) {
+    if (!handle) {
+        return;
+    }
+
+    rbus_unregDataElements(handle, NUM_ELEMENTS, data_elements);
+    rbus_close(handle);
+    handle = NULL;
+
+    // Subscriptions end with the session
+    pthread_mutex_lock(&rows_mutex);
+    for (int i = 0; i < RBUS_PROVIDER_MAX_BUTTONS; i++) {
+        rows[i].subscribers = 0;
+    }
+    wildcard_subscribers = 0;
+    pthread_mutex_unlock(&rows_mutex);
+}
+
+static int session_open(void) {
+    rbusError_t err;
+    int count;
+
+    err = rbus_open(&handle, RBUS_PROVIDER_COMPONENT);
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_ERR, "Failed to open rbus provider session: %d", err);
+        handle = NULL;
+        reconnect = rbus_client_is_connection_error(err);
+        return -1;
+    }
+
+    err = rbus_regDataElements(handle, NUM_ELEMENTS, data_elements);
+    if (err != RBUS_ERROR_SUCCESS) {
+        log_message(LOG_ERR, "Failed to register %s: %d", RBUS_PROVIDER_TABLE, err);
+        rbus_close(handle);
+        handle = NULL;
+        reconnect = rbus_client_is_connection_error(err);
+        return -1;
+    }
+    reconnect = 0;
+
+    // Rows from an earlier session come back with their cached values
+    pthread_mutex_lock(&rows_mutex);
+    count = row_count;
+    pthread_mutex_unlock(&rows_mutex);
+    for (int i = 1; i <= count; i++) {
+        rbusTable_registerRow(handle, RBUS_PROVIDER_TABLE, (uint32_t)i, NULL);
+    }
+
+    log_message(LOG_INFO, "Button events registered on rbus as %s", EVENT_ELEMENT);
+    return 0;
+}
+
+// Row of a key code, added on its first event; 0 once the table is full
+static int find_row(int code) {
+    int instance = 0;
+    int added = 0;
+    rbusError_t err;
+
+    pthread_mutex_lock(&rows_mutex);
+    for (int i = 0; i < row_count && !instance; i++) {
+        if (rows[i].code == code) {
+            instance = i + 1;
+        }
+    }
+    if (!instance && row_count < RBUS_PROVIDER_MAX_BUTTONS) {
+        rows[row_count].code = code;
+        rows[row_count].value[0] = '\0';
+        instance = ++row_count;
+        added = 1;
+    }
+    pthread_mutex_unlock(&rows_mutex);
+
+    if (added && handle) {
+        err = rbusTable_registerRow(handle, RBUS_PROVIDER_TABLE, (uint32_t)instance, NULL);
+        if (err != RBUS_ERROR_SUCCESS) {
+            log_message(LOG_WARNING, "Failed to add row %d for button %d: %d", instance, code, err);
+        }
+    }
+    if (!instance && !table_full_logged) {
+        log_message(LOG_WARNING, "Too many buttons, button %d is not published on rbus", code);
+        table_full_logged = 1;
+    }
+
+    return instance;
+}
+
+static void set_string(rbusObject_t object, const char *name, const char *data) {
+    rbusValue_t value;
+
+    rbusValue_Init(&value);
+    rbusValue_SetString(value, data);
+    rbusObject_SetValue(object, name, value);
+    rbusValue_Release(value);
+}
+
+static void publish(int instance, const button_event_t *event, const char *value, const char *old_value) {
+    char name[sizeof(EVENT_FMT) + 12];
+    char time[32];
+    rbusEvent_t rbus_event;
+    rbusObject_t data;
+    rbusError_t err;
+
+    snprintf(name, sizeof(name), EVENT_FMT, instance);
+    snprintf(time, sizeof(time), "%ld.%06ld", (long)event->timestamp.tv_sec, (long)event->timestamp.tv_usec);
+
+    rbusObject_Init(&data, NULL);
+    set_string(data, "value", value);
+    set_string(data, "oldValue", old_value);
+    set_string(data, "device", event->device);
+    set_string(data, "time", time);
+
+    rbus_event.name = name;
+    rbus_event.type = RBUS_EVENT_VALUE_CHANGED;
+    rbus_event.data = data;
+    err = rbusEvent_Publish(handle, &rbus_event);
+    rbusObject_Release(data);
+
+    if (err == RBUS_ERROR_SUCCESS) {
+        published++;
+        return;
+    }
+
+    log_message(LOG_WARNING, "Failed to publish %s: %d", name, err);
+    if (rbus_client_is_connection_error(err)) {
+        // Registered again on the next press
+        session_close();
+        reconnect = 1;
+    }
+}
+
+// Runs on the subscriber's own thread
+static void bus_event(const button_event_t *event, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)ctx;
+    const char *value = NULL;
+    char old_value[16];
+    int instance;
+    int watched;
+
+    if (event->type == BUTTON_EVENT_GESTURE) {
+        if (event->value >= 0 && event->value < GESTURE_COUNT) {
+            value = gesture_values[event->value];
+        }
+    } else if (event->value == 0 || event->value == 1) {
+        value = event->value ? "pressed" : "released";
+    }
+
+    // Auto-repeat changes nothing a consumer cares about
+    if (!value) {
+        return;
+    }
+
+    // Like the rbus client, reconnect only after rbus itself failed, and
+    // once per press rather than again for its release and gestures
+    if (!handle && reconnect && event->type == BUTTON_EVENT_KEY && event->value == 1) {
+        session_open();
+    }
+
+    instance = find_row(event->code);
+    if (!instance) {
+        return;
+    }
+
+    pthread_mutex_lock(&rows_mutex);
+    snprintf(old_value, sizeof(old_value), "%s", rows[instance - 1].value);
+    snprintf(rows[instance - 1].value, sizeof(rows[instance - 1].value), "%s", value);
+    watched = rows[instance - 1].subscribers > 0 || wildcard_subscribers > 0;
+    pthread_mutex_unlock(&rows_mutex);
+
+    // The cache is kept either way; rbus is only called when someone listens
+    if (!handle || !watched) {
+        unwatched++;
+        return;
+    }
+
+    publish(instance, event, value, old_value);
+}
+
+int rbus_provider_init(void) {
+    if (session_open() < 0 && reconnect) {
+        log_message(LOG_WARNING, "rbus not available yet, button events will be registered on the next press");
+    }
+
+    subscriber = button_bus_subscribe("rbus", BUTTON_BUS_THREAD, 0, bus_event, NULL);
+    if (!subscriber) {
+        log_message(LOG_ERR, "Failed to subscribe rbus provider to key events");
+        session_close();
+        return -1;
+    }
+
+    return 0;
+}
+
+void rbus_provider_cleanup(void) {
+    if (!subscriber) {
+        return;
+    }
+
+    // Joins the thread, so the session is ours again
+    button_bus_unsubscribe(subscriber);
+    subscriber = NULL;
+    log_message(LOG_INFO, "rbus button events: published %lu, without subscribers %lu", published, unwatched);
+
+    session_close();
+    pthread_mutex_lock(&rows_mutex);
+    memset(rows, 0, sizeof(rows));
+    row_count = 0;
+    table_full_logged = 0;
+    pthread_mutex_unlock(&rows_mutex);
+}
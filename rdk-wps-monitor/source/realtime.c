@@ -0,0 +1,129 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file realtime.c
+ * @brief Implementation of the real-time mode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <syslog.h>
+#include <sys/mman.h>
+#include "../include/realtime.h"
+#include "../include/utils.h"
+
+int realtime_parse(const char *spec, realtime_config_t *config) {
+    char *end;
+    long value;
+
+    value = strtol(spec, &end, 10);
+    if (end == spec || value < sched_get_priority_min(SCHED_FIFO) ||
+        value > sched_get_priority_max(SCHED_FIFO)) {
+        return -1;
+    }
+    config->priority = (int)value;
+    config->cpu = -1;
+
+    if (*end == ':') {
+        spec = end + 1;
+        value = strtol(spec, &end, 10);
+        if (end == spec || value < 0 || value >= CPU_SETSIZE) {
+            return -1;
+        }
+        config->cpu = (int)value;
+    }
+
+    return *end == '\0' ? 0 : -1;
+}
+
+int realtime_prepare(void) {
+    pthread_attr_t attr;
+    int err;
+
+    pthread_attr_init(&attr);
+    err = pthread_attr_setstacksize(&attr, REALTIME_THREAD_STACK);
+    if (err == 0) {
+        err = pthread_setattr_default_np(&attr);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (err != 0) {
+        log_message(LOG_WARNING, "Failed to shrink thread stacks: %s", strerror(err));
+        return -1;
+    }
+    return 0;
+}
+
+// Touch the stack the loop will grow into while faults are still cheap
+static void prefault_stack(void) {
+    volatile unsigned char stack[REALTIME_STACK_PREFAULT];
+
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+int realtime_enter(const realtime_config_t *config) {
+    struct sched_param param;
+    cpu_set_t cpus;
+    int ret = 0;
+    int err;
+
+    if (config->cpu >= 0) {
+        CPU_ZERO(&cpus);
+        CPU_SET(config->cpu, &cpus);
+        err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0) {
+            log_message(LOG_WARNING, "Failed to pin event loop to CPU %d: %s", config->cpu, strerror(err));
+            ret = -1;
+        }
+    }
+
+    // Keep freed heap mapped so later allocations do not fault it in again
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        log_message(LOG_WARNING, "Failed to lock memory: %s", strerror(errno));
+        ret = -1;
+    }
+    prefault_stack();
+
+    // Reset on fork: threads and children started from here run normally
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = config->priority;
+    if (sched_setscheduler(0, SCHED_FIFO | SCHED_RESET_ON_FORK, &param) < 0) {
+        log_message(LOG_WARNING, "Failed to set SCHED_FIFO priority %d: %s", config->priority, strerror(errno));
+        ret = -1;
+    }
+
+    if (ret == 0 && config->cpu >= 0) {
+        log_message(LOG_INFO, "Event loop running SCHED_FIFO priority %d on CPU %d, memory locked",
+                    config->priority, config->cpu);
+    } else if (ret == 0) {
+        log_message(LOG_INFO, "Event loop running SCHED_FIFO priority %d, memory locked", config->priority);
+    }
+    return ret;
+}
@@ -0,0 +1,210 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uevent_parser.c
+ * @brief Implementation of the uevent parser
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include "../include/uevent_parser.h"
+
+// Big-endian values as loaded by BPF_LD | BPF_W/BPF_H | BPF_ABS/BPF_IND
+#define BPF_WORD(a, b, c, d) \
+    (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+#define BPF_HALF(a, b) (((uint32_t)(a) << 8) | (uint32_t)(b))
+
+#define FILTER_INSNS_PER_WORD 13
+#define FILTER_VERIFY_INSNS 16
+
+static uint64_t parse_u64(const char *ptr, size_t len) {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < len && ptr[i] >= '0' && ptr[i] <= '9'; i++) {
+        value = value * 10 + (uint64_t)(ptr[i] - '0');
+    }
+
+    return value;
+}
+
+// Dispatch on key length first, so each entry costs at most two memcmp()s
+static void store_field(uevent_t *event, const char *key, size_t klen,
+                        const char *value, size_t vlen) {
+    uevent_str_t str = { value, vlen };
+
+    switch (klen) {
+    case 5:
+        if (memcmp(key, "MAJOR", 5) == 0) {
+            event->major = (int)parse_u64(value, vlen);
+        } else if (memcmp(key, "MINOR", 5) == 0) {
+            event->minor = (int)parse_u64(value, vlen);
+        }
+        break;
+    case 6:
+        if (memcmp(key, "ACTION", 6) == 0) {
+            event->action = str;
+        } else if (memcmp(key, "SEQNUM", 6) == 0) {
+            event->seqnum = parse_u64(value, vlen);
+        }
+        break;
+    case 7:
+        if (memcmp(key, "DEVNAME", 7) == 0) {
+            event->devname = str;
+        } else if (memcmp(key, "DEVPATH", 7) == 0) {
+            event->devpath = str;
+        }
+        break;
+    case 9:
+        if (memcmp(key, "SUBSYSTEM", 9) == 0) {
+            event->subsystem = str;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int uevent_parse(const char *buffer, size_t len, uevent_t *event) {
+    const char *ptr = buffer;
+    const char *end = buffer + len;
+
+    memset(event, 0, sizeof(*event));
+    event->major = -1;
+    event->minor = -1;
+
+    while (ptr < end) {
+        const char *nul = memchr(ptr, '\0', (size_t)(end - ptr));
+        const char *line_end = nul ? nul : end;
+
+        // Keys are upper case; this skips the "action@devpath" header
+        if (*ptr >= 'A' && *ptr <= 'Z') {
+            // Keys are short, so this stops within the first few bytes
+            const char *eq = memchr(ptr, '=', (size_t)(line_end - ptr));
+            if (eq) {
+                store_field(event, ptr, (size_t)(eq - ptr), eq + 1, (size_t)(line_end - eq - 1));
+            }
+        }
+
+        ptr = line_end + 1;
+    }
+
+    return event->action.ptr ? 0 : -1;
+}
+
+int uevent_str_eq(uevent_str_t str, const char *literal) {
+    size_t len = strlen(literal);
+
+    return str.len == len && memcmp(str.ptr, literal, len) == 0;
+}
+
+int uevent_str_has_prefix(uevent_str_t str, const char *prefix) {
+    size_t len = strlen(prefix);
+
+    return str.len >= len && memcmp(str.ptr, prefix, len) == 0;
+}
+
+/*
+ * Classic BPF has no loops, so the search for "SUBSYSTEM=" is unrolled
+ * over the first UEVENT_FILTER_SCAN_LEN bytes. One aligned word is loaded
+ * per 4 bytes and compared against the four ways the start of "SUBSYSTEM"
+ * can straddle it; a hit loads the offset of the NUL before it into X and
+ * jumps to the shared tail. A head also matches inside other values
+ * (LNXSYSTM contains SYST), and a jump cannot go back to resume the
+ * search, so unless the tail finds the key "\0SUBSYSTEM=" at X it passes
+ * the message to user space. Only a real SUBSYSTEM key naming another
+ * subsystem drops it. Messages whose SUBSYSTEM lies beyond the window are
+ * passed too; loads past the end of a short message abort the program and
+ * drop it.
+ */
+int uevent_filter_attach(int sock) {
+    static const struct {
+        uint16_t size;
+        uint32_t offset;
+        uint32_t value;
+        int key;                /* Part of "\0SUBSYSTEM=", else of the value */
+    } checks[(FILTER_VERIFY_INSNS - 2) / 2] = {
+        { BPF_W, 0, BPF_WORD('\0', 'S', 'U', 'B'), 1 },
+        { BPF_W, 4, BPF_WORD('S', 'Y', 'S', 'T'), 1 },
+        { BPF_H, 8, BPF_HALF('E', 'M'), 1 },
+        { BPF_B, 10, '=', 1 },
+        { BPF_W, 8, BPF_WORD('E', 'M', '=', 'i'), 0 },
+        { BPF_W, 12, BPF_WORD('n', 'p', 'u', 't'), 0 },
+        { BPF_B, 16, '\0', 0 },
+    };
+    static const uint32_t heads[4] = {
+        BPF_WORD('S', 'U', 'B', 'S'),
+        BPF_WORD('U', 'B', 'S', 'Y'),
+        BPF_WORD('B', 'S', 'Y', 'S'),
+        BPF_WORD('S', 'Y', 'S', 'T'),
+    };
+    const unsigned int words = UEVENT_FILTER_SCAN_LEN / 4 - 1;
+    const unsigned int len = words * FILTER_INSNS_PER_WORD + 1 + FILTER_VERIFY_INSNS;
+    const unsigned int verify = words * FILTER_INSNS_PER_WORD + 1;
+    const unsigned int pass = len - 2;
+    const unsigned int drop = len - 1;
+    struct sock_filter *insns;
+    struct sock_fprog prog;
+    unsigned int pc = 0;
+    int ret;
+
+    insns = calloc(len, sizeof(*insns));
+    if (!insns) {
+        return -1;
+    }
+
+    // Offset 0 holds "ACTION@", so scanning starts at the second word
+    for (unsigned int k = 4; k < UEVENT_FILTER_SCAN_LEN; k += 4) {
+        insns[pc++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, k);
+        for (unsigned int o = 0; o < 4; o++) {
+            // Hit: jump to this head's ldx; last miss: jump to the next word
+            unsigned char jt = (unsigned char)(3 - o + 2 * o);
+            unsigned char jf = (o == 3) ? (unsigned char)(jt + 2) : 0;
+            insns[pc++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, heads[o], jt, jf);
+        }
+        for (unsigned int o = 0; o < 4; o++) {
+            insns[pc++] = (struct sock_filter)BPF_STMT(BPF_LDX | BPF_W | BPF_IMM, k - o - 1);
+            insns[pc] = (struct sock_filter)BPF_STMT(BPF_JMP | BPF_JA, verify - pc - 1);
+            pc++;
+        }
+    }
+
+    // SUBSYSTEM not within the window, let user space decide
+    insns[pc++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffffffff);
+
+    // Verify "\0SUBSYSTEM=input\0" at X
+    for (unsigned int i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        unsigned int target = checks[i].key ? pass : drop;
+
+        insns[pc++] = (struct sock_filter)BPF_STMT(BPF_LD | checks[i].size | BPF_IND, checks[i].offset);
+        insns[pc] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, checks[i].value,
+                                                 0, (unsigned char)(target - pc - 1));
+        pc++;
+    }
+    insns[pc++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffffffff);
+    insns[pc++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+
+    prog.len = (unsigned short)pc;
+    prog.filter = insns;
+    ret = setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog));
+    free(insns);
+    return ret;
+}
@@ -0,0 +1,220 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uevent_stream.c
+ * @brief Implementation of the uevent stream hotplug backend
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <syslog.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include "../include/uevent_stream.h"
+#include "../include/netlink_monitor.h"
+#include "../include/event_loop.h"
+#include "../include/utils.h"
+
+#define STREAM_LINE_MAX 1024
+#define STREAM_MESSAGE_MAX 8192
+
+static int stream_fd = -1;
+static int stream_is_fifo = 0;
+static char *stream_path = NULL;
+
+// Partial line and message carried across reads
+static char line[STREAM_LINE_MAX];
+static size_t line_len = 0;
+static int line_truncated = 0;
+static char message[STREAM_MESSAGE_MAX];
+static size_t message_len = 0;
+static int message_truncated = 0;
+
+static void flush_message(void) {
+    if (message_len > 0 && !message_truncated) {
+        parse_netlink_message(message, (int)message_len);
+    } else if (message_truncated) {
+        log_message(LOG_WARNING, "Discarding oversized uevent from %s", stream_path);
+    }
+
+    message_len = 0;
+    message_truncated = 0;
+}
+
+static void end_line(void) {
+    if (line_len == 0) {
+        flush_message();
+    } else if (line[0] != '#') {
+        // Entries are NUL separated, as on the uevent socket
+        if (line_truncated || message_len + line_len + 1 > sizeof(message)) {
+            message_truncated = 1;
+        } else {
+            memcpy(message + message_len, line, line_len);
+            message_len += line_len;
+            message[message_len++] = '\0';
+        }
+    }
+
+    line_len = 0;
+    line_truncated = 0;
+}
+
+static void feed(const char *data, size_t len) {
+    while (len > 0) {
+        const char *nl = memchr(data, '\n', len);
+        size_t n = nl ? (size_t)(nl - data) : len;
+
+        if (line_len + n > sizeof(line)) {
+            line_truncated = 1;
+        } else {
+            memcpy(line + line_len, data, n);
+            line_len += n;
+        }
+
+        if (!nl) {
+            break;
+        }
+
+        end_line();
+        data = nl + 1;
+        len -= n + 1;
+    }
+}
+
+// Returns 1 at end of stream, 0 when the descriptor would block, -1 on error
+static int drain(int fd) {
+    char buffer[4096];
+    ssize_t len;
+
+    for (;;) {
+        len = read(fd, buffer, sizeof(buffer));
+        if (len > 0) {
+            feed(buffer, (size_t)len);
+        } else if (len == 0) {
+            // A final message need not end with a blank line
+            if (line_len > 0) {
+                end_line();
+            }
+            flush_message();
+            return 1;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN) {
+            return 0;
+        } else {
+            log_message(LOG_ERR, "Error reading uevent stream %s: %s", stream_path, strerror(errno));
+            return -1;
+        }
+    }
+}
+
+static int open_stream(void) {
+    struct stat st;
+
+    stream_fd = open(stream_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (stream_fd < 0) {
+        log_message(LOG_ERR, "Failed to open uevent stream %s: %s", stream_path, strerror(errno));
+        return -1;
+    }
+
+    if (fstat(stream_fd, &st) < 0 || (!S_ISFIFO(st.st_mode) && !S_ISREG(st.st_mode))) {
+        log_message(LOG_ERR, "uevent stream %s is neither a FIFO nor a file", stream_path);
+        close(stream_fd);
+        stream_fd = -1;
+        return -1;
+    }
+
+    stream_is_fifo = S_ISFIFO(st.st_mode);
+    return 0;
+}
+
+int init_uevent_stream(const char *path) {
+    stream_path = strdup(path);
+    if (!stream_path) {
+        return -1;
+    }
+
+    if (open_stream() < 0) {
+        free(stream_path);
+        stream_path = NULL;
+        return -1;
+    }
+
+    line_len = 0;
+    message_len = 0;
+    log_message(LOG_INFO, "uevent stream initialized on %s", path);
+    return 0;
+}
+
+int start_uevent_stream(void) {
+    if (stream_fd < 0) {
+        return -1;
+    }
+
+    // Regular files cannot be polled; replay them in one go
+    if (!stream_is_fifo) {
+        int ret = drain(stream_fd);
+        log_message(LOG_INFO, "Replayed uevent file %s", stream_path);
+        return ret < 0 ? -1 : 0;
+    }
+
+    if (event_loop_add(stream_fd, EPOLLIN, uevent_stream_handle_event, NULL) < 0) {
+        log_message(LOG_ERR, "Failed to register uevent stream with event loop");
+        return -1;
+    }
+
+    log_message(LOG_INFO, "uevent stream monitoring started");
+    return 0;
+}
+
+void close_uevent_stream(void) {
+    if (stream_fd >= 0) {
+        if (stream_is_fifo) {
+            event_loop_remove(stream_fd);
+        }
+        close(stream_fd);
+        stream_fd = -1;
+    }
+
+    free(stream_path);
+    stream_path = NULL;
+}
+
+void uevent_stream_handle_event(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+
+    if (drain(fd) == 0) {
+        return;
+    }
+
+    // The writer went away; a fresh open waits quietly for the next one
+    event_loop_remove(fd);
+    close(fd);
+    stream_fd = -1;
+    if (open_stream() < 0 || event_loop_add(stream_fd, EPOLLIN, uevent_stream_handle_event, NULL) < 0) {
+        log_message(LOG_ERR, "Lost uevent stream %s", stream_path);
+    }
+}
@@ -0,0 +1,512 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uring_reader.c
+ * @brief Implementation of the io_uring read backend
+ *
+ * Uses the raw system calls, so there is no dependency on liburing. Only
+ * the event loop thread touches the ring.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <syslog.h>
+#include "../include/uring_reader.h"
+#include "../include/utils.h"
+
+#ifdef NO_IO_URING
+
+int uring_reader_init(void) {
+    log_message(LOG_WARNING, "Built without io_uring support");
+    return -1;
+}
+
+void uring_reader_cleanup(void) {
+}
+
+int uring_reader_enabled(void) {
+    return 0;
+}
+
+int uring_reader_add(int fd, uring_read_handler handler, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)fd;
+    (void)handler;
+    (void)ctx;
+    return -1;
+}
+
+void uring_reader_remove(int fd) {
+    /* Prevent unused parameter warning */
+    (void)fd;
+}
+
+void uring_reader_get_stats(uring_reader_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#else
+
+#include <stdint.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "../include/event_loop.h"
+
+// A poll and a read per reader can be queued between two submissions
+#define RING_ENTRIES (2 * URING_READER_MAX)
+#define BUFFER_GROUP 0
+
+// Not in uapi headers before Linux 6.7
+#define OP_READ_MULTISHOT 49
+
+// user_data is (generation << 32 | reader index) for reads
+#define POLL_TAG (1ULL << 63)
+#define CANCEL_TAG (1ULL << 62)
+
+typedef struct {
+    int fd;                     /* -1 once removed */
+    int armed;                  /* A read is outstanding; the slot is busy until it ends */
+    int multishot;
+    int is_socket;
+    unsigned int generation;
+    uring_read_handler handler;
+    void *ctx;
+} reader_t;
+
+static int ring_fd = -1;
+static void *ring_mem = NULL;
+static size_t ring_len = 0;
+static struct io_uring_sqe *sqes = NULL;
+static size_t sqes_len = 0;
+static unsigned int *sq_head = NULL, *sq_tail, *sq_mask, *sq_array;
+static unsigned int *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_cqe *cqes;
+static unsigned int sq_entries;
+static unsigned int sqe_tail;   /* Local SQ tail, published by submit() */
+
+// Buffer ring shared with the kernel; its tail overlays bufs[0].resv
+static struct io_uring_buf *buf_ring = NULL;
+static unsigned char *buffers = NULL;
+static unsigned short buf_tail = 0;
+
+static reader_t readers[URING_READER_MAX];
+static int multishot_supported = 1;
+static uring_reader_stats_t stats;
+
+static int sys_io_uring_setup(unsigned int entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_io_uring_enter(unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(unsigned int opcode, void *arg, unsigned int nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+static unsigned int sq_space(void) {
+    return sq_entries - (sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE));
+}
+
+static struct io_uring_sqe *get_sqe(void) {
+    struct io_uring_sqe *sqe;
+    unsigned int index;
+
+    if (sq_space() == 0) {
+        return NULL;
+    }
+
+    index = sqe_tail & *sq_mask;
+    sq_array[index] = index;
+    sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe_tail++;
+    return sqe;
+}
+
+static int submit(void) {
+    unsigned int pending;
+    int ret;
+
+    __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+    pending = sqe_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (pending == 0) {
+        return 0;
+    }
+
+    do {
+        ret = sys_io_uring_enter(pending, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        log_message(LOG_ERR, "io_uring submission failed: %s", strerror(errno));
+        return -1;
+    }
+
+    stats.submits++;
+    return 0;
+}
+
+static void recycle_buffer(unsigned short bid) {
+    struct io_uring_buf *buf = &buf_ring[buf_tail & (URING_READER_BUFFERS - 1)];
+
+    buf->addr = (uint64_t)(uintptr_t)(buffers + (size_t)bid * URING_READER_BUFFER_SIZE);
+    buf->len = URING_READER_BUFFER_SIZE;
+    buf->bid = bid;
+    buf_tail++;
+    __atomic_store_n(&buf_ring[0].resv, buf_tail, __ATOMIC_RELEASE);
+}
+
+static int arm(reader_t *r) {
+    uint64_t data = ((uint64_t)r->generation << 32) | (uint64_t)(r - readers);
+    struct io_uring_sqe *poll;
+    struct io_uring_sqe *read;
+
+    // The poll and its linked read must go into the queue together
+    if (sq_space() < 2 && (submit() < 0 || sq_space() < 2)) {
+        return -1;
+    }
+    poll = get_sqe();
+    read = get_sqe();
+
+    // Wait for readiness first as the event loop does; a read on a FIFO
+    // without a writer would report end of file straight away
+    poll->opcode = IORING_OP_POLL_ADD;
+    poll->fd = r->fd;
+    poll->poll32_events = POLLIN;
+    poll->flags = IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+    poll->user_data = data | POLL_TAG;
+
+    // A zero length reads up to the size of the selected buffer
+    if (r->is_socket) {
+        read->opcode = IORING_OP_RECV;
+        read->ioprio = r->multishot ? IORING_RECV_MULTISHOT : 0;
+    } else {
+        read->opcode = r->multishot ? OP_READ_MULTISHOT : IORING_OP_READ;
+    }
+    read->fd = r->fd;
+    read->flags = IOSQE_BUFFER_SELECT;
+    read->buf_group = BUFFER_GROUP;
+    read->user_data = data;
+
+    r->armed = 1;
+    return 0;
+}
+
+static int should_rearm(int res) {
+    return res > 0 || res == -ENOBUFS || res == -EAGAIN || res == -EINTR;
+}
+
+static void complete(const struct io_uring_cqe *cqe) {
+    reader_t *r = &readers[cqe->user_data & 0xffffffffU];
+    unsigned int generation = r->generation;
+    int more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    int has_buffer = (cqe->flags & IORING_CQE_F_BUFFER) != 0;
+    unsigned short bid = (unsigned short)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    int res = cqe->res;
+
+    // A failed poll ends its linked read with -ECANCELED
+    if (cqe->user_data & (POLL_TAG | CANCEL_TAG)) {
+        return;
+    }
+
+    stats.completions++;
+    if (!more) {
+        r->armed = 0;
+    }
+
+    if (r->fd >= 0 && res == -EINVAL && r->multishot) {
+        // Multishot reads need Linux 6.7 and multishot recv 6.0
+        log_message(LOG_INFO, "io_uring multishot %s unsupported, re-arming single reads",
+                    r->is_socket ? "recv" : "read");
+        multishot_supported = 0;
+        r->multishot = 0;
+        res = -EAGAIN;
+    } else if (r->fd >= 0) {
+        if (res == -ENOBUFS) {
+            stats.stalls++;
+        }
+        r->handler(r->fd, res > 0 && has_buffer ? buffers + (size_t)bid * URING_READER_BUFFER_SIZE : NULL,
+                   res, r->ctx);
+    }
+
+    if (has_buffer) {
+        recycle_buffer(bid);
+    }
+
+    // The handler may have removed the reader or even reused its slot
+    if (!more && !r->armed && r->fd >= 0 && r->generation == generation) {
+        if (!should_rearm(res) || arm(r) < 0) {
+            log_message(LOG_WARNING, "io_uring stopped reading fd %d: %s", r->fd,
+                        res < 0 ? strerror(-res) : "no submission space");
+        }
+    }
+}
+
+static void drain(void) {
+    unsigned int head = *cq_head;
+    unsigned int tail;
+    struct io_uring_cqe cqe;
+
+    while (head != (tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))) {
+        for (; head != tail; head++) {
+            // Release the entry before calling out; handlers may submit
+            cqe = cqes[head & *cq_mask];
+            __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+            complete(&cqe);
+        }
+    }
+}
+
+static void ring_event(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)fd;
+    (void)events;
+    (void)ctx;
+    unsigned long before = stats.completions;
+
+    drain();
+
+    // Readable with an empty queue means completions are still being posted
+    if (stats.completions == before && sys_io_uring_enter(0, 0, IORING_ENTER_GETEVENTS) == 0) {
+        drain();
+    }
+
+    // Re-arm the reads that ended in this batch
+    submit();
+}
+
+static void release_ring(void) {
+    struct io_uring_sqe *sqe;
+
+    // Reads still armed would complete into buffers that are about to go
+    if (ring_fd >= 0 && sq_head && (sqe = get_sqe()) != NULL) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = CANCEL_TAG;
+        submit();
+    }
+
+    if (ring_fd >= 0) {
+        close(ring_fd);
+        ring_fd = -1;
+    }
+    if (sqes) {
+        munmap(sqes, sqes_len);
+        sqes = NULL;
+    }
+    if (ring_mem) {
+        munmap(ring_mem, ring_len);
+        ring_mem = NULL;
+        sq_head = NULL;
+    }
+    if (buf_ring) {
+        munmap(buf_ring, URING_READER_BUFFERS * sizeof(*buf_ring));
+        buf_ring = NULL;
+    }
+    if (buffers) {
+        munmap(buffers, (size_t)URING_READER_BUFFERS * URING_READER_BUFFER_SIZE);
+        buffers = NULL;
+    }
+}
+
+static void *map(size_t len, int fd, off_t offset) {
+    void *p;
+
+    if (fd < 0) {
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    } else {
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    }
+
+    return p == MAP_FAILED ? NULL : p;
+}
+
+int uring_reader_init(void) {
+    struct io_uring_params params;
+    struct io_uring_buf_reg reg;
+    unsigned char *sq;
+    unsigned char *cq;
+
+    memset(&params, 0, sizeof(params));
+    ring_fd = sys_io_uring_setup(RING_ENTRIES, &params);
+    if (ring_fd < 0) {
+        log_message(LOG_WARNING, "io_uring unavailable: %s", strerror(errno));
+        return -1;
+    }
+
+    // Both rings share one mapping since Linux 5.4
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        log_message(LOG_WARNING, "io_uring too old, needs a single ring mapping");
+        release_ring();
+        return -1;
+    }
+
+    ring_len = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    if (params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe) > ring_len) {
+        ring_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    }
+    sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring_mem = map(ring_len, ring_fd, IORING_OFF_SQ_RING);
+    sqes = map(sqes_len, ring_fd, IORING_OFF_SQES);
+    buf_ring = map(URING_READER_BUFFERS * sizeof(*buf_ring), -1, 0);
+    buffers = map((size_t)URING_READER_BUFFERS * URING_READER_BUFFER_SIZE, -1, 0);
+    if (!ring_mem || !sqes || !buf_ring || !buffers) {
+        log_message(LOG_ERR, "Failed to map io_uring memory: %s", strerror(errno));
+        release_ring();
+        return -1;
+    }
+
+    sq = ring_mem;
+    cq = ring_mem;
+    sq_head = (unsigned int *)(sq + params.sq_off.head);
+    sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+    sq_array = (unsigned int *)(sq + params.sq_off.array);
+    cq_head = (unsigned int *)(cq + params.cq_off.head);
+    cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+    cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    sq_entries = params.sq_entries;
+    sqe_tail = *sq_tail;
+
+    // Provided buffer rings need Linux 5.19
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+    reg.ring_entries = URING_READER_BUFFERS;
+    reg.bgid = BUFFER_GROUP;
+    if (sys_io_uring_register(IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        log_message(LOG_WARNING, "io_uring buffer rings unavailable: %s", strerror(errno));
+        release_ring();
+        return -1;
+    }
+
+    buf_tail = 0;
+    for (unsigned short bid = 0; bid < URING_READER_BUFFERS; bid++) {
+        recycle_buffer(bid);
+    }
+
+    for (int i = 0; i < URING_READER_MAX; i++) {
+        memset(&readers[i], 0, sizeof(readers[i]));
+        readers[i].fd = -1;
+    }
+    memset(&stats, 0, sizeof(stats));
+    multishot_supported = 1;
+
+    if (event_loop_add(ring_fd, EPOLLIN, ring_event, NULL) < 0) {
+        release_ring();
+        return -1;
+    }
+
+    log_message(LOG_INFO, "io_uring reader ready: %u entries, %d x %d byte buffers",
+                sq_entries, URING_READER_BUFFERS, URING_READER_BUFFER_SIZE);
+    return 0;
+}
+
+void uring_reader_cleanup(void) {
+    if (ring_fd < 0) {
+        return;
+    }
+
+    event_loop_remove(ring_fd);
+    release_ring();
+}
+
+int uring_reader_enabled(void) {
+    return ring_fd >= 0;
+}
+
+int uring_reader_add(int fd, uring_read_handler handler, void *ctx) {
+    struct stat st;
+    reader_t *r = NULL;
+
+    if (ring_fd < 0 || fd < 0 || !handler) {
+        return -1;
+    }
+
+    for (int i = 0; i < URING_READER_MAX && !r; i++) {
+        if (readers[i].fd < 0 && !readers[i].armed) {
+            r = &readers[i];
+        }
+    }
+    if (!r) {
+        log_message(LOG_WARNING, "io_uring reader full, fd %d stays on the event loop", fd);
+        return -1;
+    }
+
+    r->generation++;
+    r->fd = fd;
+    r->handler = handler;
+    r->ctx = ctx;
+    r->multishot = multishot_supported;
+    r->is_socket = fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+
+    if (arm(r) < 0) {
+        r->fd = -1;
+        return -1;
+    }
+
+    // A failed submission leaves the read queued for the next one
+    submit();
+    return 0;
+}
+
+void uring_reader_remove(int fd) {
+    struct io_uring_sqe *sqe;
+
+    for (int i = 0; i < URING_READER_MAX; i++) {
+        reader_t *r = &readers[i];
+
+        if (r->fd != fd) {
+            continue;
+        }
+
+        r->fd = -1;
+        if (r->armed) {
+            // Cancels the poll, which fails the linked read, or the read itself
+            if (sq_space() == 0) {
+                submit();
+            }
+            sqe = get_sqe();
+            if (sqe) {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = fd;
+                sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+                sqe->user_data = CANCEL_TAG;
+            }
+            submit();
+        }
+        return;
+    }
+}
+
+void uring_reader_get_stats(uring_reader_stats_t *s) {
+    *s = stats;
+}
+
+#endif /* NO_IO_URING */
@@ -30,12 +30,33 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <syslog.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include <sys/stat.h>
 #include "../include/utils.h"
 
+typedef struct {
+    unsigned long seq;          /* Ring position the slot is ready for */
+    int level;
+    char text[LOG_LINE_MAX];
+} log_slot_t;
+
 // Global variables
 static volatile bool running = true;
 static bool debug_mode = false;
+static bool log_to_stdout = false;   /* stdout is still the terminal */
+
+// Log ring state
+static log_slot_t log_ring[LOG_RING_SIZE];
+static unsigned long log_enqueue_pos;
+static unsigned long log_dequeue_pos;
+static unsigned long log_dropped;
+static bool log_writer_running;
+static bool log_writer_stopping;
+static sem_t log_sem;
+static pthread_t log_thread;
 
 void log_init(bool daemon_mode, bool debug_mode) {
     /* Prevent unused parameter warning */
@@ -46,26 +67,217 @@ void log_init(bool daemon_mode, bool debug_mode) {
     if (!daemon_mode) {
         log_options |= LOG_PERROR;
     }
+    log_to_stdout = !daemon_mode;
     
     openlog("netlink-button-monitor", log_options, LOG_DAEMON);
 }
 
-void log_message(int level, const char *fmt, ...) {
+/*
+ * Bounded MPMC ring (Vyukov): a slot is free for the producer that owns
+ * position pos when seq == pos and holds a message once seq == pos + 1.
+ * Producers never wait; only the writer thread touches syslog and stdout.
+ */
+static void log_write(int level, const char *text) {
+    syslog(level, "%s", text);
+
+    // If in debug mode, also log to stdout; a daemon has closed it, and the
+    // descriptor may since belong to a device or socket
+    if (get_debug_mode() && log_to_stdout) {
+        printf("%s\n", text);
+    }
+}
+
+static int log_ring_push(int level, const char *fmt, va_list args) {
+    unsigned long pos = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+    log_slot_t *slot;
+
+    for (;;) {
+        slot = &log_ring[pos & (LOG_RING_SIZE - 1)];
+        unsigned long seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)(seq - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&log_enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring is full; the writer is behind
+            return -1;
+        } else {
+            pos = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->level = level;
+    vsnprintf(slot->text, sizeof(slot->text), fmt, args);
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    sem_post(&log_sem);
+    return 0;
+}
+
+// Only called by the writer thread, or once it has been joined
+static bool log_ring_pop(void) {
+    log_slot_t *slot = &log_ring[log_dequeue_pos & (LOG_RING_SIZE - 1)];
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != log_dequeue_pos + 1) {
+        return false;
+    }
+
+    log_write(slot->level, slot->text);
+    __atomic_store_n(&slot->seq, log_dequeue_pos + LOG_RING_SIZE, __ATOMIC_RELEASE);
+    log_dequeue_pos++;
+    return true;
+}
+
+static void *log_writer_thread(void *arg) {
+    /* Prevent unused parameter warning */
+    (void)arg;
+
+    for (;;) {
+        if (sem_wait(&log_sem) < 0) {
+            continue;
+        }
+
+        while (log_ring_pop()) {
+        }
+
+        if (__atomic_load_n(&log_writer_stopping, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+int log_start_writer(void) {
+    sigset_t all, old;
+
+    if (__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+
+    for (unsigned long i = 0; i < LOG_RING_SIZE; i++) {
+        log_ring[i].seq = i;
+    }
+    log_enqueue_pos = 0;
+    log_dequeue_pos = 0;
+    log_writer_stopping = false;
+
+    if (sem_init(&log_sem, 0, 0) < 0) {
+        syslog(LOG_ERR, "Failed to initialize log semaphore: %s", strerror(errno));
+        return -1;
+    }
+
+    // Signals are handled by the main thread
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int err = pthread_create(&log_thread, NULL, log_writer_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (err != 0) {
+        syslog(LOG_ERR, "Failed to start log writer: %s", strerror(err));
+        sem_destroy(&log_sem);
+        return -1;
+    }
+
+    __atomic_store_n(&log_writer_running, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Producers are not counted: one still logging could publish after the
+// final pass below, or post the semaphore once it is destroyed
+void log_stop_writer(void) {
+    if (!__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    // New messages go out synchronously from here on
+    __atomic_store_n(&log_writer_running, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&log_writer_stopping, true, __ATOMIC_RELEASE);
+    sem_post(&log_sem);
+    pthread_join(log_thread, NULL);
+
+    // Pick up anything published after the writer's last pass
+    while (log_ring_pop()) {
+    }
+
+    sem_destroy(&log_sem);
+}
+
+unsigned long log_get_dropped(void) {
+    return __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+}
+
+static void log_vmessage(int level, const char *fmt, va_list args) {
+    if (__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE)) {
+        if (log_ring_push(level, fmt, args) < 0) {
+            __atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+        }
+        return;
+    }
+
+    // No writer yet (or any more): format and write on the caller's thread
+    char text[LOG_LINE_MAX];
+    vsnprintf(text, sizeof(text), fmt, args);
+    log_write(level, text);
+}
+
+static void log_emit(int level, const char *fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    
-    // Always log to syslog
-    vsyslog(level, fmt, args);
-    
-    // If in debug mode, also log to stdout
-    if (get_debug_mode()) {
-        va_list args_copy;
-        va_copy(args_copy, args);
-        vprintf(fmt, args_copy);
-        printf("\n");
-        va_end(args_copy);
+    log_vmessage(level, fmt, args);
+    va_end(args);
+}
+
+void log_message_ratelimited(log_ratelimit_t *ratelimit, int level, const char *fmt, ...) {
+    struct timespec now;
+    va_list args;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    long window = (long)(now.tv_sec / LOG_RATELIMIT_INTERVAL);
+
+    // First caller in a new window resets the counters and reports the gap
+    long seen = __atomic_load_n(&ratelimit->window, __ATOMIC_RELAXED);
+    if (seen != window &&
+        __atomic_compare_exchange_n(&ratelimit->window, &seen, window, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        unsigned int suppressed = __atomic_exchange_n(&ratelimit->suppressed, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&ratelimit->count, 0, __ATOMIC_RELAXED);
+        if (suppressed > 0) {
+            log_emit(level, "%u similar messages suppressed", suppressed);
+        }
+    }
+
+    if (__atomic_add_fetch(&ratelimit->count, 1, __ATOMIC_RELAXED) > LOG_RATELIMIT_BURST) {
+        __atomic_add_fetch(&ratelimit->suppressed, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    va_start(args, fmt);
+    log_vmessage(level, fmt, args);
+    va_end(args);
+}
+
+void log_listing(int level, const char *fmt, ...) {
+    char text[LOG_LINE_MAX];
+    va_list args, copy;
+    int queued = 0;
+
+    va_start(args, fmt);
+    if (__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE)) {
+        va_copy(copy, args);
+        queued = log_ring_push(level, fmt, copy) == 0;
+        va_end(copy);
+    }
+
+    // Listings are never dropped; with the ring full the line is written here
+    if (!queued) {
+        vsnprintf(text, sizeof(text), fmt, args);
+        log_write(level, text);
     }
-    
     va_end(args);
 }
 
@@ -135,10 +347,11 @@ bool get_running_state(void) {
     return running;
 }
 
+// Switched from the loop thread (control socket) while the log writer reads it
 void set_debug_mode(bool debug) {
-    debug_mode = debug;
+    __atomic_store_n(&debug_mode, debug, __ATOMIC_RELAXED);
 }
 
 bool get_debug_mode(void) {
-    return debug_mode;
+    return __atomic_load_n(&debug_mode, __ATOMIC_RELAXED);
 }
@@ -0,0 +1,289 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wps_session.c
+ * @brief Implementation of the WPS session state machine
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <pthread.h>
+#include "../include/wps_session.h"
+#include "../include/journal.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+typedef struct {
+    unsigned int instance;
+    wps_session_state_t state;  /* Last status reported */
+    int joined;                 /* Reported active during this session */
+} ap_status_t;
+
+static const char *state_names[WPS_SESSION_STATE_COUNT] = {
+    "idle",
+    "active",
+    "success",
+    "timeout",
+    "failure",
+};
+
+static const char *press_names[] = {
+    "start",
+    "restart",
+    "extend",
+    "ignore",
+};
+
+static const struct {
+    const char *status;
+    wps_session_state_t state;
+} status_values[] = {
+    { "Idle", WPS_SESSION_IDLE },
+    { "Active", WPS_SESSION_ACTIVE },
+    { "InProgress", WPS_SESSION_ACTIVE },
+    { "Success", WPS_SESSION_SUCCESS },
+    { "Timeout", WPS_SESSION_TIMEOUT },
+    { "Failed", WPS_SESSION_FAILURE },
+    { "Error", WPS_SESSION_FAILURE },
+    { "Overlap", WPS_SESSION_FAILURE },
+};
+
+// Presses come from the action worker, status events from rbus threads
+static pthread_mutex_t session_mutex = PTHREAD_MUTEX_INITIALIZER;
+static wps_session_state_t session_state = WPS_SESSION_IDLE;
+static uint64_t state_since_ns = 0;
+static uint64_t triggered_ns = 0;
+static uint64_t deadline_ns = 0;
+static ap_status_t aps[WPS_SESSION_MAX_APS];
+static int ap_count = 0;
+static wps_session_stats_t counters;
+
+// Called with the mutex held; instance is 0 when no access point caused it
+static void enter(wps_session_state_t next, unsigned int instance, uint64_t now) {
+    uint64_t held = state_since_ns ? now - state_since_ns : 0;
+
+    switch (next) {
+    case WPS_SESSION_SUCCESS:
+        counters.succeeded++;
+        break;
+    case WPS_SESSION_TIMEOUT:
+        counters.timed_out++;
+        break;
+    case WPS_SESSION_FAILURE:
+        counters.failed++;
+        break;
+    default:
+        break;
+    }
+
+    if (instance) {
+        log_message(LOG_INFO, "WPS session %s -> %s (access point %u) after %.1f s", state_names[session_state],
+                    state_names[next], instance, held / 1e9);
+    } else {
+        log_message(LOG_INFO, "WPS session %s -> %s after %.1f s", state_names[session_state], state_names[next],
+                    held / 1e9);
+    }
+    journal_write(JOURNAL_WPS, 0, (int)instance, (int)next, JOURNAL_NO_ACTION, held);
+
+    session_state = next;
+    state_since_ns = now;
+}
+
+// Sessions nobody reports on end with the walk time
+static void check_deadline(uint64_t now) {
+    if (session_state == WPS_SESSION_ACTIVE && now >= deadline_ns) {
+        enter(WPS_SESSION_TIMEOUT, 0, now);
+    }
+}
+
+// Restarts the walk time; access points that joined stay in the session
+static void extend(uint64_t now) {
+    triggered_ns = now;
+    deadline_ns = now + (uint64_t)WPS_SESSION_WALK_MS * 1000000ULL;
+}
+
+static void begin(uint64_t now) {
+    extend(now);
+    ap_count = 0;
+}
+
+static ap_status_t *find_ap(unsigned int instance) {
+    static ap_status_t overflow;
+
+    for (int i = 0; i < ap_count; i++) {
+        if (aps[i].instance == instance) {
+            return &aps[i];
+        }
+    }
+    if (ap_count == WPS_SESSION_MAX_APS) {
+        // Still counts for this event, just not remembered
+        memset(&overflow, 0, sizeof(overflow));
+        overflow.instance = instance;
+        return &overflow;
+    }
+
+    memset(&aps[ap_count], 0, sizeof(aps[ap_count]));
+    aps[ap_count].instance = instance;
+    return &aps[ap_count++];
+}
+
+/*
+ * Result once every access point that joined the session has left it:
+ * the worst one reported, or idle if they were all cancelled. ACTIVE
+ * while one is still active or none has joined yet.
+ */
+static wps_session_state_t session_result(void) {
+    wps_session_state_t result = WPS_SESSION_IDLE;
+    int joined = 0;
+
+    for (int i = 0; i < ap_count; i++) {
+        if (!aps[i].joined) {
+            continue;
+        }
+        joined++;
+        if (aps[i].state == WPS_SESSION_ACTIVE) {
+            return WPS_SESSION_ACTIVE;
+        }
+        if (aps[i].state == WPS_SESSION_FAILURE ||
+            (aps[i].state == WPS_SESSION_TIMEOUT && result != WPS_SESSION_FAILURE)) {
+            result = aps[i].state;
+        }
+    }
+
+    return joined ? result : WPS_SESSION_ACTIVE;
+}
+
+wps_press_t wps_session_press(void) {
+    wps_press_t press;
+    uint64_t now;
+
+    pthread_mutex_lock(&session_mutex);
+    now = latency_now();
+    check_deadline(now);
+
+    switch (session_state) {
+    case WPS_SESSION_ACTIVE:
+        // The access points are still in push button mode from this press
+        press = now - triggered_ns < (uint64_t)WPS_SESSION_HOLDOFF_MS * 1000000ULL ?
+                WPS_PRESS_IGNORE : WPS_PRESS_EXTEND;
+        break;
+    case WPS_SESSION_TIMEOUT:
+    case WPS_SESSION_FAILURE:
+        press = WPS_PRESS_RESTART;
+        break;
+    default:
+        press = WPS_PRESS_START;
+        break;
+    }
+
+    if (press == WPS_PRESS_IGNORE) {
+        counters.ignored++;
+    } else {
+        if (press == WPS_PRESS_EXTEND) {
+            // Same session, so no state change to report either
+            counters.extended++;
+            extend(now);
+        } else {
+            counters.sessions++;
+            begin(now);
+            enter(WPS_SESSION_ACTIVE, 0, now);
+        }
+    }
+    pthread_mutex_unlock(&session_mutex);
+
+    return press;
+}
+
+void wps_session_trigger_failed(void) {
+    pthread_mutex_lock(&session_mutex);
+    if (session_state == WPS_SESSION_ACTIVE) {
+        enter(WPS_SESSION_FAILURE, 0, latency_now());
+    }
+    pthread_mutex_unlock(&session_mutex);
+}
+
+void wps_session_status(unsigned int instance, const char *status) {
+    wps_session_state_t reported = WPS_SESSION_STATE_COUNT;
+    wps_session_state_t result;
+    ap_status_t *ap;
+    uint64_t now;
+
+    if (!status) {
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(status_values) / sizeof(status_values[0]); i++) {
+        if (strcmp(status, status_values[i].status) == 0) {
+            reported = status_values[i].state;
+        }
+    }
+    if (reported == WPS_SESSION_STATE_COUNT) {
+        log_message(LOG_DEBUG, "Ignoring WPS status %s of access point %u", status, instance);
+        return;
+    }
+
+    pthread_mutex_lock(&session_mutex);
+    now = latency_now();
+    check_deadline(now);
+
+    ap = find_ap(instance);
+    ap->state = reported;
+
+    if (reported == WPS_SESSION_ACTIVE) {
+        ap->joined = 1;
+        if (session_state != WPS_SESSION_ACTIVE) {
+            // Started without a press, e.g. from the web UI
+            counters.sessions++;
+            begin(now);
+            ap = find_ap(instance);
+            ap->state = reported;
+            ap->joined = 1;
+            enter(WPS_SESSION_ACTIVE, instance, now);
+        }
+    } else if (session_state == WPS_SESSION_ACTIVE) {
+        // One success is enough, the other bands stop on their own
+        result = reported == WPS_SESSION_SUCCESS ? WPS_SESSION_SUCCESS : session_result();
+        if (result != WPS_SESSION_ACTIVE) {
+            enter(result, instance, now);
+        }
+    }
+    pthread_mutex_unlock(&session_mutex);
+}
+
+void wps_session_get_stats(wps_session_stats_t *stats) {
+    uint64_t now;
+
+    pthread_mutex_lock(&session_mutex);
+    now = latency_now();
+    check_deadline(now);
+    *stats = counters;
+    stats->state = session_state;
+    stats->state_ns = state_since_ns ? now - state_since_ns : 0;
+    pthread_mutex_unlock(&session_mutex);
+}
+
+const char *wps_session_state_name(wps_session_state_t state) {
+    return (unsigned int)state < WPS_SESSION_STATE_COUNT ? state_names[state] : "unknown";
+}
+
+const char *wps_press_name(wps_press_t press) {
+    return (unsigned int)press < sizeof(press_names) / sizeof(press_names[0]) ? press_names[press] : "unknown";
+}
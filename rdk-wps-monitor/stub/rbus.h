@@ -0,0 +1,263 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file rbus.h
+ * @brief Local stand-in for the subset of the rbus API used by the daemon
+ *
+ * Selected with `make RBUS_STUB=1`. Declarations match the RDK rbus
+ * headers so the daemon sources build unchanged against either. The
+ * stub's behaviour is configured through the environment:
+ *
+ *   RBUS_STUB_LATENCY_US   Added to every bus call (default 0)
+ *   RBUS_STUB_JITTER_US    Uniform random extra latency (default 0)
+ *   RBUS_STUB_ERROR_RATE   Fraction of bus calls that fail (default 0)
+ *   RBUS_STUB_ERROR        rbusError_t returned by failing calls (default 1, BUS_ERROR)
+ *   RBUS_STUB_HANG_RATE    Fraction of bus calls that hang (default 0)
+ *   RBUS_STUB_HANG_MS      Hang duration before RBUS_ERROR_TIMEOUT (default 15000, 0 = forever)
+ *   RBUS_STUB_ACCESS_POINTS Rows in Device.WiFi.AccessPoint. (default 2)
+ *   RBUS_STUB_SEED         Seed for the failure injection (default 1)
+ *   RBUS_STUB_TRACE        Print every call to stderr when set
+ *   RBUS_STUB_SUBSCRIBE    Comma-separated event names, '*' matching one
+ *                          instance, that an outside component subscribes
+ *                          to once a provider registers them; events
+ *                          published to them are printed to stderr
+ *   RBUS_STUB_WPS_RESULT   When set, activating the WPS push button of an
+ *                          access point makes its WPS status parameter
+ *                          report Active, then this value (e.g. Success,
+ *                          Timeout, Failed) to subscribers in this process,
+ *                          as an int32 if the value is a number;
+ *                          as on a real bus, an unchanged status is not
+ *                          sent again
+ *   RBUS_STUB_WPS_MS       Time from Active to the result (default 3000)
+ *   RBUS_STUB_WPS_STATUS   Parameter below WPS. the status is reported in
+ *                          (default X_RDK_SessionStatus)
+ *   RBUS_STUB_AP_CHANGE_MS When set, Device.WiFi.AccessPoint. reports a
+ *                          change this long after it is subscribed to
+ *
+ * rbus_get reaches data elements registered in the same process.
+ */
+
+#ifndef RBUS_H
+#define RBUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct _rbusHandle *rbusHandle_t;
+typedef struct _rbusValue *rbusValue_t;
+typedef struct _rbusProperty *rbusProperty_t;
+typedef struct _rbusObject *rbusObject_t;
+typedef struct _rbusFilter *rbusFilter_t;
+typedef struct _rbusMethodAsyncHandle *rbusMethodAsyncHandle_t;
+
+typedef enum _rbusError {
+    RBUS_ERROR_SUCCESS,
+    RBUS_ERROR_BUS_ERROR,
+    RBUS_ERROR_INVALID_INPUT,
+    RBUS_ERROR_NOT_INITIALIZED,
+    RBUS_ERROR_OUT_OF_RESOURCES,
+    RBUS_ERROR_DESTINATION_NOT_FOUND,
+    RBUS_ERROR_DESTINATION_NOT_REACHABLE,
+    RBUS_ERROR_DESTINATION_RESPONSE_FAILURE,
+    RBUS_ERROR_INVALID_RESPONSE_FROM_DESTINATION,
+    RBUS_ERROR_INVALID_OPERATION,
+    RBUS_ERROR_INVALID_EVENT,
+    RBUS_ERROR_INVALID_HANDLE,
+    RBUS_ERROR_SESSION_ALREADY_EXIST,
+    RBUS_ERROR_COMPONENT_NAME_DUPLICATE,
+    RBUS_ERROR_ELEMENT_NAME_DUPLICATE,
+    RBUS_ERROR_ELEMENT_NAME_MISSING,
+    RBUS_ERROR_COMPONENT_DOES_NOT_EXIST,
+    RBUS_ERROR_ELEMENT_DOES_NOT_EXIST,
+    RBUS_ERROR_ACCESS_NOT_ALLOWED,
+    RBUS_ERROR_INVALID_CONTEXT,
+    RBUS_ERROR_TIMEOUT,
+    RBUS_ERROR_ASYNC_RESPONSE
+} rbusError_t;
+
+typedef enum {
+    RBUS_BOOLEAN = 0x500,
+    RBUS_CHAR,
+    RBUS_BYTE,
+    RBUS_INT8,
+    RBUS_UINT8,
+    RBUS_INT16,
+    RBUS_UINT16,
+    RBUS_INT32,
+    RBUS_UINT32,
+    RBUS_INT64,
+    RBUS_UINT64,
+    RBUS_SINGLE,
+    RBUS_DOUBLE,
+    RBUS_DATETIME,
+    RBUS_STRING,
+    RBUS_BYTES,
+    RBUS_PROPERTY,
+    RBUS_OBJECT,
+    RBUS_NONE
+} rbusValueType_t;
+
+typedef enum {
+    RBUS_EVENT_OBJECT_CREATED,
+    RBUS_EVENT_OBJECT_DELETED,
+    RBUS_EVENT_VALUE_CHANGED,
+    RBUS_EVENT_GENERAL,
+    RBUS_EVENT_INITIAL_VALUE,
+    RBUS_EVENT_INTERVAL,
+    RBUS_EVENT_DURATION_COMPLETE
+} rbusEventType_t;
+
+typedef struct {
+    char const *name;
+    rbusEventType_t type;
+    rbusObject_t data;
+} rbusEvent_t;
+
+typedef struct _rbusEventSubscription {
+    char const *eventName;
+    void *filter;
+    uint32_t interval;
+    uint32_t duration;
+    void *handler;
+    void *userData;
+    rbusHandle_t handle;
+    void *asyncHandler;
+    bool publishOnSubscribe;
+} rbusEventSubscription_t;
+
+typedef void (*rbusEventHandler_t)(rbusHandle_t handle, rbusEvent_t const *eventData,
+                                   rbusEventSubscription_t *subscription);
+
+typedef struct _rbusRowName {
+    char const *name;
+    uint32_t instNum;
+    char const *alias;
+    bool inUse;
+    struct _rbusRowName *next;
+} rbusRowName_t;
+
+typedef struct _rbusSetOptions {
+    bool commit;
+    uint32_t sessionId;
+} rbusSetOptions_t;
+
+typedef enum {
+    RBUS_ELEMENT_TYPE_PROPERTY = 1,
+    RBUS_ELEMENT_TYPE_TABLE,
+    RBUS_ELEMENT_TYPE_EVENT,
+    RBUS_ELEMENT_TYPE_METHOD
+} rbusElementType_t;
+
+typedef enum {
+    RBUS_EVENT_ACTION_SUBSCRIBE = 0,
+    RBUS_EVENT_ACTION_UNSUBSCRIBE
+} rbusEventSubAction_t;
+
+typedef struct _rbusGetHandlerOptions {
+    char const *requestingComponent;
+} rbusGetHandlerOptions_t;
+
+typedef struct _rbusSetHandlerOptions {
+    bool commit;
+    uint32_t sessionId;
+    char const *requestingComponent;
+} rbusSetHandlerOptions_t;
+
+typedef rbusError_t (*rbusGetHandler_t)(rbusHandle_t handle, rbusProperty_t property,
+                                        rbusGetHandlerOptions_t *options);
+typedef rbusError_t (*rbusSetHandler_t)(rbusHandle_t handle, rbusProperty_t property,
+                                        rbusSetHandlerOptions_t *options);
+typedef rbusError_t (*rbusTableAddRowHandler_t)(rbusHandle_t handle, char const *tableName,
+                                                char const *aliasName, uint32_t *instNum);
+typedef rbusError_t (*rbusTableRemoveRowHandler_t)(rbusHandle_t handle, char const *rowName);
+typedef rbusError_t (*rbusEventSubHandler_t)(rbusHandle_t handle, rbusEventSubAction_t action,
+                                             char const *eventName, rbusFilter_t filter,
+                                             int32_t interval, bool *autoPublish);
+typedef rbusError_t (*rbusMethodHandler_t)(rbusHandle_t handle, char const *methodName,
+                                           rbusObject_t inParams, rbusObject_t outParams,
+                                           rbusMethodAsyncHandle_t asyncHandle);
+
+typedef struct rbusCallbackTable_t {
+    rbusGetHandler_t getHandler;
+    rbusSetHandler_t setHandler;
+    rbusTableAddRowHandler_t tableAddRowHandler;
+    rbusTableRemoveRowHandler_t tableRemoveRowHandler;
+    rbusEventSubHandler_t eventSubHandler;
+    rbusMethodHandler_t methodHandler;
+} rbusCallbackTable_t;
+
+typedef struct rbusDataElement_t {
+    char *name;
+    rbusElementType_t type;
+    rbusCallbackTable_t cbTable;
+} rbusDataElement_t;
+
+rbusError_t rbus_open(rbusHandle_t *handle, char const *componentName);
+rbusError_t rbus_close(rbusHandle_t handle);
+
+rbusError_t rbus_regDataElements(rbusHandle_t handle, int numDataElements, rbusDataElement_t *elements);
+rbusError_t rbus_unregDataElements(rbusHandle_t handle, int numDataElements, rbusDataElement_t *elements);
+
+rbusError_t rbus_get(rbusHandle_t handle, char const *name, rbusValue_t *value);
+rbusError_t rbus_getBoolean(rbusHandle_t handle, char const *paramName, bool *paramVal);
+rbusError_t rbus_setBoolean(rbusHandle_t handle, char const *paramName, bool paramVal);
+rbusError_t rbus_setStr(rbusHandle_t handle, char const *paramName, char const *paramVal);
+rbusError_t rbus_setMulti(rbusHandle_t handle, int numProps, rbusProperty_t properties,
+                          rbusSetOptions_t *opts);
+
+rbusError_t rbusTable_getRowNames(rbusHandle_t handle, char const *tableName, rbusRowName_t **rowNames);
+rbusError_t rbusTable_freeRowNames(rbusHandle_t handle, rbusRowName_t *rowNames);
+rbusError_t rbusTable_registerRow(rbusHandle_t handle, char const *tableName, uint32_t instNum,
+                                  char const *aliasName);
+rbusError_t rbusTable_unregisterRow(rbusHandle_t handle, char const *rowName);
+
+rbusError_t rbusEvent_Subscribe(rbusHandle_t handle, char const *eventName, rbusEventHandler_t handler,
+                                void *userData, int timeout);
+rbusError_t rbusEvent_Unsubscribe(rbusHandle_t handle, char const *eventName);
+rbusError_t rbusEvent_Publish(rbusHandle_t handle, rbusEvent_t *eventData);
+
+rbusValue_t rbusValue_Init(rbusValue_t *value);
+void rbusValue_Retain(rbusValue_t value);
+void rbusValue_Release(rbusValue_t value);
+rbusValueType_t rbusValue_GetType(rbusValue_t value);
+void rbusValue_SetBoolean(rbusValue_t value, bool data);
+bool rbusValue_GetBoolean(rbusValue_t value);
+void rbusValue_SetInt32(rbusValue_t value, int32_t data);
+int32_t rbusValue_GetInt32(rbusValue_t value);
+void rbusValue_SetString(rbusValue_t value, char const *data);
+char const *rbusValue_GetString(rbusValue_t value, int *len);
+
+rbusProperty_t rbusProperty_Init(rbusProperty_t *property, char const *name, rbusValue_t value);
+void rbusProperty_Retain(rbusProperty_t property);
+void rbusProperty_Release(rbusProperty_t property);
+char const *rbusProperty_GetName(rbusProperty_t property);
+rbusValue_t rbusProperty_GetValue(rbusProperty_t property);
+void rbusProperty_SetValue(rbusProperty_t property, rbusValue_t value);
+rbusProperty_t rbusProperty_GetNext(rbusProperty_t property);
+void rbusProperty_PushBack(rbusProperty_t property, rbusProperty_t back);
+
+rbusObject_t rbusObject_Init(rbusObject_t *object, char const *name);
+void rbusObject_Release(rbusObject_t object);
+rbusValue_t rbusObject_GetValue(rbusObject_t object, char const *name);
+void rbusObject_SetValue(rbusObject_t object, char const *name, rbusValue_t value);
+
+char const *rbusError_ToString(rbusError_t e);
+
+#endif /* RBUS_H */
@@ -0,0 +1,966 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file rbus_stub.c
+ * @brief In-process rbus stand-in with latency and failure injection
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "rbus.h"
+
+#define AP_TABLE "Device.WiFi.AccessPoint."
+#define AP_PUSH_BUTTON "WPS.X_CISCO_COM_ActivatePushButton"
+#define AP_WPS_STATUS "X_RDK_SessionStatus"
+#define MAX_ELEMENTS 64
+#define MAX_SUBSCRIPTIONS 8
+#define MAX_EVENT_SUBSCRIPTIONS 16
+#define MAX_WPS_STATUS 64
+
+struct _rbusHandle {
+    char *component;
+};
+
+typedef enum {
+    VALUE_NONE,
+    VALUE_BOOLEAN,
+    VALUE_INT32,
+    VALUE_STRING
+} value_type_t;
+
+struct _rbusValue {
+    int refs;
+    value_type_t type;
+    bool boolean;
+    int32_t int32;
+    char *string;
+};
+
+struct _rbusProperty {
+    int refs;
+    char *name;
+    rbusValue_t value;
+    rbusProperty_t next;
+};
+
+struct _rbusObject {
+    int refs;
+    char *name;
+    rbusProperty_t properties;
+};
+
+// A data element registered by a provider in this process
+typedef struct {
+    rbusHandle_t handle;
+    char *name;
+    rbusCallbackTable_t cb;
+} element_t;
+
+// An rbusEvent_Subscribe() made in this process
+typedef struct {
+    rbusHandle_t handle;
+    char *name;
+    rbusEventHandler_t handler;
+    void *userData;
+} subscription_t;
+
+typedef struct {
+    char name[96];
+    unsigned int instance;
+    long delay_ms;
+} wps_session_t;
+
+typedef struct {
+    long latency_us;
+    long jitter_us;
+    double error_rate;
+    rbusError_t error;
+    double hang_rate;
+    long hang_ms;
+    unsigned int access_points;
+    int trace;
+    char *subscribe;
+    char *subscriptions[MAX_SUBSCRIPTIONS];
+    int subscription_count;
+    const char *wps_result;
+    const char *wps_status;
+    long wps_ms;
+    long ap_change_ms;
+} stub_config_t;
+
+static stub_config_t config;
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t random_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t random_state;
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static element_t elements[MAX_ELEMENTS];
+static int element_count = 0;
+static subscription_t event_subscriptions[MAX_EVENT_SUBSCRIPTIONS];
+static int event_subscription_count = 0;
+static char wps_reported[MAX_WPS_STATUS][16];
+
+static long env_long(const char *name, long fallback) {
+    const char *value = getenv(name);
+
+    return value && *value ? strtol(value, NULL, 0) : fallback;
+}
+
+static double env_double(const char *name, double fallback) {
+    const char *value = getenv(name);
+
+    return value && *value ? strtod(value, NULL) : fallback;
+}
+
+static void load_config(void) {
+    config.latency_us = env_long("RBUS_STUB_LATENCY_US", 0);
+    config.jitter_us = env_long("RBUS_STUB_JITTER_US", 0);
+    config.error_rate = env_double("RBUS_STUB_ERROR_RATE", 0.0);
+    config.error = (rbusError_t)env_long("RBUS_STUB_ERROR", RBUS_ERROR_BUS_ERROR);
+    config.hang_rate = env_double("RBUS_STUB_HANG_RATE", 0.0);
+    config.hang_ms = env_long("RBUS_STUB_HANG_MS", 15000);
+    config.access_points = (unsigned int)env_long("RBUS_STUB_ACCESS_POINTS", 2);
+    config.trace = getenv("RBUS_STUB_TRACE") != NULL;
+    config.wps_result = getenv("RBUS_STUB_WPS_RESULT");
+    config.wps_ms = env_long("RBUS_STUB_WPS_MS", 3000);
+    config.ap_change_ms = env_long("RBUS_STUB_AP_CHANGE_MS", 0);
+    config.wps_status = getenv("RBUS_STUB_WPS_STATUS") ? getenv("RBUS_STUB_WPS_STATUS") : AP_WPS_STATUS;
+    random_state = (uint64_t)env_long("RBUS_STUB_SEED", 1) | 1;
+
+    // Kept for the life of the process; the list points into it
+    if (getenv("RBUS_STUB_SUBSCRIBE") && (config.subscribe = strdup(getenv("RBUS_STUB_SUBSCRIBE")))) {
+        char *save = NULL;
+
+        for (char *name = strtok_r(config.subscribe, ",", &save);
+             name && config.subscription_count < MAX_SUBSCRIPTIONS;
+             name = strtok_r(NULL, ",", &save)) {
+            config.subscriptions[config.subscription_count++] = name;
+        }
+    }
+}
+
+static int is_wildcard(const char *segment, size_t len) {
+    return (len == 1 && segment[0] == '*') || (len == 3 && strncmp(segment, "{i}", 3) == 0);
+}
+
+// Compare names segment by segment; '*' and '{i}' match any one segment
+static int names_match(const char *a, const char *b) {
+    while (*a && *b) {
+        size_t len_a = strcspn(a, ".");
+        size_t len_b = strcspn(b, ".");
+
+        if (!is_wildcard(a, len_a) && !is_wildcard(b, len_b) &&
+            (len_a != len_b || strncmp(a, b, len_a) != 0)) {
+            return 0;
+        }
+        a += len_a;
+        b += len_b;
+        if (*a != *b) {
+            return 0;
+        }
+        if (*a) {
+            a++;
+            b++;
+        }
+    }
+
+    return *a == *b;
+}
+
+static int is_subscribed(const char *name) {
+    for (int i = 0; i < config.subscription_count; i++) {
+        if (names_match(config.subscriptions[i], name)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void simulate_wps(const char *param);
+static void simulate_ap_change(void);
+
+static void remove_subscriptions(rbusHandle_t handle, const char *name) {
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < event_subscription_count;) {
+        if (event_subscriptions[i].handle == handle && (!name || strcmp(event_subscriptions[i].name, name) == 0)) {
+            free(event_subscriptions[i].name);
+            event_subscriptions[i] = event_subscriptions[--event_subscription_count];
+        } else {
+            i++;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+static void remove_elements(rbusHandle_t handle, const char *name) {
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < element_count;) {
+        if (elements[i].handle == handle && (!name || strcmp(elements[i].name, name) == 0)) {
+            free(elements[i].name);
+            elements[i] = elements[--element_count];
+        } else {
+            i++;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+// xorshift64*, uniform in [0, 1)
+static double next_random(void) {
+    uint64_t x;
+
+    pthread_mutex_lock(&random_mutex);
+    x = random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    random_state = x;
+    pthread_mutex_unlock(&random_mutex);
+
+    return (double)((x * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0;
+}
+
+static void sleep_us(long us) {
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+
+    while (us > 0 && nanosleep(&ts, &ts) < 0) {
+    }
+}
+
+/*
+ * Every call that would cross the bus goes through here: first the
+ * configured delay, then possibly a hang or an injected error.
+ */
+static rbusError_t bus_call(const char *call, const char *name) {
+    rbusError_t err = RBUS_ERROR_SUCCESS;
+    long delay;
+
+    pthread_once(&config_once, load_config);
+
+    delay = config.latency_us;
+    if (config.jitter_us > 0) {
+        delay += (long)(next_random() * (double)config.jitter_us);
+    }
+    sleep_us(delay);
+
+    if (config.hang_rate > 0 && next_random() < config.hang_rate) {
+        if (config.trace) {
+            fprintf(stderr, "rbus-stub: %s(%s) hangs\n", call, name ? name : "");
+        }
+        if (config.hang_ms == 0) {
+            for (;;) {
+                pause();
+            }
+        }
+        sleep_us(config.hang_ms * 1000);
+        err = RBUS_ERROR_TIMEOUT;
+    } else if (config.error_rate > 0 && next_random() < config.error_rate) {
+        err = config.error;
+    }
+
+    if (config.trace) {
+        fprintf(stderr, "rbus-stub: %s(%s) = %s\n", call, name ? name : "", rbusError_ToString(err));
+    }
+
+    return err;
+}
+
+rbusError_t rbus_open(rbusHandle_t *handle, char const *componentName) {
+    rbusError_t err = bus_call("rbus_open", componentName);
+
+    *handle = NULL;
+    if (err != RBUS_ERROR_SUCCESS) {
+        return err;
+    }
+
+    *handle = calloc(1, sizeof(**handle));
+    if (!*handle || !((*handle)->component = strdup(componentName))) {
+        free(*handle);
+        *handle = NULL;
+        return RBUS_ERROR_OUT_OF_RESOURCES;
+    }
+
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbus_close(rbusHandle_t handle) {
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    // Closing a handle takes its data elements and subscriptions off the bus
+    remove_elements(handle, NULL);
+    remove_subscriptions(handle, NULL);
+    free(handle->component);
+    free(handle);
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbus_regDataElements(rbusHandle_t handle, int numDataElements, rbusDataElement_t *elements_in) {
+    rbusError_t err;
+    int added = 0;
+
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+    if (numDataElements <= 0 || !elements_in) {
+        return RBUS_ERROR_INVALID_INPUT;
+    }
+
+    err = bus_call("rbus_regDataElements", elements_in[0].name);
+    if (err != RBUS_ERROR_SUCCESS) {
+        return err;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    for (; added < numDataElements && element_count < MAX_ELEMENTS; added++) {
+        element_t *e = &elements[element_count];
+
+        if (!(e->name = strdup(elements_in[added].name))) {
+            break;
+        }
+        e->handle = handle;
+        e->cb = elements_in[added].cbTable;
+        element_count++;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (added < numDataElements) {
+        for (int i = 0; i < added; i++) {
+            remove_elements(handle, elements_in[i].name);
+        }
+        return RBUS_ERROR_OUT_OF_RESOURCES;
+    }
+
+    // The outside subscribers arrive as soon as the events exist
+    for (int i = 0; i < numDataElements; i++) {
+        rbusEventSubHandler_t handler = elements_in[i].cbTable.eventSubHandler;
+
+        for (int j = 0; handler && j < config.subscription_count; j++) {
+            bool autoPublish = true;
+
+            if (!names_match(config.subscriptions[j], elements_in[i].name)) {
+                continue;
+            }
+            err = handler(handle, RBUS_EVENT_ACTION_SUBSCRIBE, config.subscriptions[j], NULL, 0, &autoPublish);
+            if (config.trace) {
+                fprintf(stderr, "rbus-stub: subscribe(%s) = %s\n", config.subscriptions[j], rbusError_ToString(err));
+            }
+        }
+    }
+
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbus_unregDataElements(rbusHandle_t handle, int numDataElements, rbusDataElement_t *elements_in) {
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    for (int i = 0; i < numDataElements; i++) {
+        remove_elements(handle, elements_in[i].name);
+    }
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbus_get(rbusHandle_t handle, char const *name, rbusValue_t *value) {
+    rbusGetHandlerOptions_t options;
+    rbusHandle_t provider = NULL;
+    rbusGetHandler_t handler = NULL;
+    rbusProperty_t property;
+    rbusError_t err;
+
+    *value = NULL;
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    err = bus_call("rbus_get", name);
+    if (err != RBUS_ERROR_SUCCESS) {
+        return err;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < element_count && !handler; i++) {
+        if (elements[i].cb.getHandler && names_match(elements[i].name, name)) {
+            provider = elements[i].handle;
+            handler = elements[i].cb.getHandler;
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (!handler) {
+        return RBUS_ERROR_ELEMENT_DOES_NOT_EXIST;
+    }
+    if (!rbusProperty_Init(&property, name, NULL)) {
+        return RBUS_ERROR_OUT_OF_RESOURCES;
+    }
+
+    options.requestingComponent = handle->component;
+    err = handler(provider, property, &options);
+    if (err == RBUS_ERROR_SUCCESS) {
+        if (property->value) {
+            *value = property->value;
+            rbusValue_Retain(*value);
+        } else {
+            err = RBUS_ERROR_INVALID_RESPONSE_FROM_DESTINATION;
+        }
+    }
+    rbusProperty_Release(property);
+
+    return err;
+}
+
+rbusError_t rbus_getBoolean(rbusHandle_t handle, char const *paramName, bool *paramVal) {
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    // Every parameter reads as true, e.g. WPS.Enable on each access point
+    *paramVal = true;
+    return bus_call("rbus_getBoolean", paramName);
+}
+
+rbusError_t rbus_setBoolean(rbusHandle_t handle, char const *paramName, bool paramVal) {
+    (void)paramVal;
+
+    return handle ? bus_call("rbus_setBoolean", paramName) : RBUS_ERROR_INVALID_HANDLE;
+}
+
+rbusError_t rbus_setStr(rbusHandle_t handle, char const *paramName, char const *paramVal) {
+    (void)paramVal;
+
+    return handle ? bus_call("rbus_setStr", paramName) : RBUS_ERROR_INVALID_HANDLE;
+}
+
+rbusError_t rbus_setMulti(rbusHandle_t handle, int numProps, rbusProperty_t properties,
+                          rbusSetOptions_t *opts) {
+    rbusError_t err;
+
+    (void)opts;
+
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+    if (numProps <= 0 || !properties) {
+        return RBUS_ERROR_INVALID_INPUT;
+    }
+
+    // One round trip for the whole batch, like the real bus
+    err = bus_call("rbus_setMulti", properties->name);
+    if (err == RBUS_ERROR_SUCCESS && config.wps_result) {
+        for (rbusProperty_t p = properties; p; p = p->next) {
+            simulate_wps(p->name);
+        }
+    }
+    return err;
+}
+
+rbusError_t rbusTable_getRowNames(rbusHandle_t handle, char const *tableName, rbusRowName_t **rowNames) {
+    rbusError_t err;
+    rbusRowName_t *head = NULL;
+
+    *rowNames = NULL;
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    err = bus_call("rbusTable_getRowNames", tableName);
+    if (err != RBUS_ERROR_SUCCESS) {
+        return err;
+    }
+    if (strcmp(tableName, AP_TABLE) != 0) {
+        return RBUS_ERROR_ELEMENT_DOES_NOT_EXIST;
+    }
+
+    // Build the list back to front so instances come out in order
+    for (unsigned int i = config.access_points; i > 0; i--) {
+        rbusRowName_t *row = calloc(1, sizeof(*row));
+        char *name = malloc(sizeof(AP_TABLE) + 12);
+
+        if (!row || !name) {
+            free(row);
+            free(name);
+            rbusTable_freeRowNames(handle, head);
+            return RBUS_ERROR_OUT_OF_RESOURCES;
+        }
+
+        snprintf(name, sizeof(AP_TABLE) + 12, AP_TABLE "%u.", i);
+        row->name = name;
+        row->instNum = i;
+        row->inUse = true;
+        row->next = head;
+        head = row;
+    }
+
+    *rowNames = head;
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbusTable_freeRowNames(rbusHandle_t handle, rbusRowName_t *rowNames) {
+    (void)handle;
+
+    while (rowNames) {
+        rbusRowName_t *next = rowNames->next;
+        free((char *)rowNames->name);
+        free(rowNames);
+        rowNames = next;
+    }
+
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbusTable_registerRow(rbusHandle_t handle, char const *tableName, uint32_t instNum,
+                                  char const *aliasName) {
+    (void)instNum;
+    (void)aliasName;
+
+    return handle ? bus_call("rbusTable_registerRow", tableName) : RBUS_ERROR_INVALID_HANDLE;
+}
+
+rbusError_t rbusTable_unregisterRow(rbusHandle_t handle, char const *rowName) {
+    return handle ? bus_call("rbusTable_unregisterRow", rowName) : RBUS_ERROR_INVALID_HANDLE;
+}
+
+rbusError_t rbusEvent_Subscribe(rbusHandle_t handle, char const *eventName, rbusEventHandler_t handler,
+                                void *userData, int timeout) {
+    rbusError_t err;
+    char *name;
+
+    (void)timeout;
+
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    err = bus_call("rbusEvent_Subscribe", eventName);
+    if (err != RBUS_ERROR_SUCCESS) {
+        return err;
+    }
+
+    // Only the stub's own events (see RBUS_STUB_WPS_RESULT) are ever delivered
+    name = strdup(eventName);
+    pthread_mutex_lock(&registry_mutex);
+    if (name && event_subscription_count < MAX_EVENT_SUBSCRIPTIONS) {
+        subscription_t *sub = &event_subscriptions[event_subscription_count++];
+
+        sub->handle = handle;
+        sub->name = name;
+        sub->handler = handler;
+        sub->userData = userData;
+        name = NULL;
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (name) {
+        free(name);
+        return RBUS_ERROR_OUT_OF_RESOURCES;
+    }
+
+    if (config.ap_change_ms > 0 && strcmp(eventName, AP_TABLE) == 0) {
+        simulate_ap_change();
+    }
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusError_t rbusEvent_Unsubscribe(rbusHandle_t handle, char const *eventName) {
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    remove_subscriptions(handle, eventName);
+    return RBUS_ERROR_SUCCESS;
+}
+
+// Send a value-change event to the subscribers in this process
+static void deliver(const char *name, const char *data) {
+    subscription_t matched[MAX_EVENT_SUBSCRIPTIONS];
+    int count = 0;
+    rbusEvent_t event;
+    rbusObject_t object;
+    rbusValue_t value;
+    char *end;
+    long number;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (int i = 0; i < event_subscription_count; i++) {
+        if (names_match(event_subscriptions[i].name, name)) {
+            matched[count++] = event_subscriptions[i];
+        }
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    if (count == 0 || !rbusObject_Init(&object, NULL)) {
+        return;
+    }
+    // Agents that publish an enum send a number, not a string
+    rbusValue_Init(&value);
+    number = strtol(data, &end, 10);
+    if (*data && *end == '\0') {
+        rbusValue_SetInt32(value, (int32_t)number);
+    } else {
+        rbusValue_SetString(value, data);
+    }
+    rbusObject_SetValue(object, "value", value);
+    rbusValue_Release(value);
+
+    event.name = name;
+    event.type = RBUS_EVENT_VALUE_CHANGED;
+    event.data = object;
+    for (int i = 0; i < count; i++) {
+        rbusEventSubscription_t subscription;
+
+        memset(&subscription, 0, sizeof(subscription));
+        subscription.eventName = name;
+        subscription.userData = matched[i].userData;
+        subscription.handle = matched[i].handle;
+        if (config.trace) {
+            fprintf(stderr, "rbus-stub: deliver %s = %s\n", name, data);
+        }
+        matched[i].handler(matched[i].handle, &event, &subscription);
+    }
+    rbusObject_Release(object);
+}
+
+// A value-change event is only sent when the status really changes
+static void report_wps(const wps_session_t *session, const char *status) {
+    int changed = 1;
+
+    if (session->instance < MAX_WPS_STATUS) {
+        pthread_mutex_lock(&registry_mutex);
+        changed = strcmp(wps_reported[session->instance], status) != 0;
+        snprintf(wps_reported[session->instance], sizeof(wps_reported[0]), "%s", status);
+        pthread_mutex_unlock(&registry_mutex);
+    }
+
+    if (changed) {
+        deliver(session->name, status);
+    }
+}
+
+// The WiFi agent side of a push button session
+static void *wps_session_thread(void *arg) {
+    wps_session_t *session = (wps_session_t *)arg;
+
+    report_wps(session, "Active");
+    sleep_us(session->delay_ms * 1000);
+    report_wps(session, config.wps_result);
+
+    free(session);
+    return NULL;
+}
+
+// A row of the AccessPoint table changing once, e.g. on a Wi-Fi restart
+static void *ap_change_thread(void *arg) {
+    (void)arg;
+
+    sleep_us(config.ap_change_ms * 1000);
+    deliver(AP_TABLE, "changed");
+    return NULL;
+}
+
+static void simulate_ap_change(void) {
+    pthread_t thread;
+
+    if (pthread_create(&thread, NULL, ap_change_thread, NULL) == 0) {
+        pthread_detach(thread);
+    }
+}
+
+static void simulate_wps(const char *param) {
+    wps_session_t *session;
+    unsigned int instance;
+    pthread_t thread;
+    int offset = 0;
+
+    if (sscanf(param, AP_TABLE "%u.%n", &instance, &offset) != 1 || offset == 0 ||
+        strcmp(param + offset, AP_PUSH_BUTTON) != 0) {
+        return;
+    }
+
+    session = malloc(sizeof(*session));
+    if (!session) {
+        return;
+    }
+    snprintf(session->name, sizeof(session->name), AP_TABLE "%u.WPS.%s", instance,
+             config.wps_status);
+    session->instance = instance;
+    session->delay_ms = config.wps_ms;
+
+    if (pthread_create(&thread, NULL, wps_session_thread, session) != 0) {
+        free(session);
+        return;
+    }
+    pthread_detach(thread);
+}
+
+static void print_value(rbusValue_t value) {
+    switch (value ? value->type : VALUE_NONE) {
+    case VALUE_BOOLEAN:
+        fprintf(stderr, "%s", value->boolean ? "true" : "false");
+        break;
+    case VALUE_INT32:
+        fprintf(stderr, "%d", (int)value->int32);
+        break;
+    case VALUE_STRING:
+        fprintf(stderr, "\"%s\"", value->string);
+        break;
+    default:
+        fprintf(stderr, "(none)");
+        break;
+    }
+}
+
+rbusError_t rbusEvent_Publish(rbusHandle_t handle, rbusEvent_t *eventData) {
+    rbusError_t err;
+
+    if (!handle) {
+        return RBUS_ERROR_INVALID_HANDLE;
+    }
+
+    err = bus_call("rbusEvent_Publish", eventData->name);
+    if (err != RBUS_ERROR_SUCCESS || !is_subscribed(eventData->name)) {
+        return err;
+    }
+
+    // What the outside subscriber receives, one line per event
+    flockfile(stderr);
+    fprintf(stderr, "rbus-stub: event %s", eventData->name);
+    for (rbusProperty_t p = eventData->data ? eventData->data->properties : NULL; p; p = p->next) {
+        fprintf(stderr, " %s=", p->name);
+        print_value(p->value);
+    }
+    fprintf(stderr, "\n");
+    funlockfile(stderr);
+
+    return RBUS_ERROR_SUCCESS;
+}
+
+rbusValue_t rbusValue_Init(rbusValue_t *value) {
+    rbusValue_t v = calloc(1, sizeof(*v));
+
+    if (v) {
+        v->refs = 1;
+    }
+    if (value) {
+        *value = v;
+    }
+    return v;
+}
+
+void rbusValue_Retain(rbusValue_t value) {
+    __atomic_add_fetch(&value->refs, 1, __ATOMIC_RELAXED);
+}
+
+void rbusValue_Release(rbusValue_t value) {
+    if (value && __atomic_sub_fetch(&value->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(value->string);
+        free(value);
+    }
+}
+
+static void set_type(rbusValue_t value, value_type_t type) {
+    free(value->string);
+    value->string = NULL;
+    value->type = type;
+}
+
+rbusValueType_t rbusValue_GetType(rbusValue_t value) {
+    switch (value->type) {
+    case VALUE_BOOLEAN:
+        return RBUS_BOOLEAN;
+    case VALUE_INT32:
+        return RBUS_INT32;
+    case VALUE_STRING:
+        return RBUS_STRING;
+    default:
+        return RBUS_NONE;
+    }
+}
+
+void rbusValue_SetBoolean(rbusValue_t value, bool data) {
+    set_type(value, VALUE_BOOLEAN);
+    value->boolean = data;
+}
+
+bool rbusValue_GetBoolean(rbusValue_t value) {
+    return value->boolean;
+}
+
+void rbusValue_SetInt32(rbusValue_t value, int32_t data) {
+    set_type(value, VALUE_INT32);
+    value->int32 = data;
+}
+
+int32_t rbusValue_GetInt32(rbusValue_t value) {
+    return value->int32;
+}
+
+void rbusValue_SetString(rbusValue_t value, char const *data) {
+    set_type(value, VALUE_STRING);
+    value->string = strdup(data ? data : "");
+}
+
+// Like the real bus, only a string value has a string
+char const *rbusValue_GetString(rbusValue_t value, int *len) {
+    const char *data = value->type == VALUE_STRING ? value->string : NULL;
+
+    if (len) {
+        *len = data ? (int)strlen(data) : 0;
+    }
+    return data;
+}
+
+rbusProperty_t rbusProperty_Init(rbusProperty_t *property, char const *name, rbusValue_t value) {
+    rbusProperty_t p = calloc(1, sizeof(*p));
+
+    if (p && name && !(p->name = strdup(name))) {
+        free(p);
+        p = NULL;
+    }
+    if (p) {
+        p->refs = 1;
+        p->value = value;
+        if (value) {
+            rbusValue_Retain(value);
+        }
+    }
+    if (property) {
+        *property = p;
+    }
+    return p;
+}
+
+void rbusProperty_Retain(rbusProperty_t property) {
+    __atomic_add_fetch(&property->refs, 1, __ATOMIC_RELAXED);
+}
+
+void rbusProperty_Release(rbusProperty_t property) {
+    while (property && __atomic_sub_fetch(&property->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        rbusProperty_t next = property->next;
+        rbusValue_Release(property->value);
+        free(property->name);
+        free(property);
+        property = next;
+    }
+}
+
+char const *rbusProperty_GetName(rbusProperty_t property) {
+    return property->name;
+}
+
+rbusValue_t rbusProperty_GetValue(rbusProperty_t property) {
+    return property->value;
+}
+
+void rbusProperty_SetValue(rbusProperty_t property, rbusValue_t value) {
+    if (value) {
+        rbusValue_Retain(value);
+    }
+    rbusValue_Release(property->value);
+    property->value = value;
+}
+
+rbusProperty_t rbusProperty_GetNext(rbusProperty_t property) {
+    return property->next;
+}
+
+void rbusProperty_PushBack(rbusProperty_t property, rbusProperty_t back) {
+    while (property->next) {
+        property = property->next;
+    }
+
+    // The list holds its own reference, as in rbus
+    rbusProperty_Retain(back);
+    property->next = back;
+}
+
+rbusObject_t rbusObject_Init(rbusObject_t *object, char const *name) {
+    rbusObject_t o = calloc(1, sizeof(*o));
+
+    if (o && name && !(o->name = strdup(name))) {
+        free(o);
+        o = NULL;
+    }
+    if (o) {
+        o->refs = 1;
+    }
+    if (object) {
+        *object = o;
+    }
+    return o;
+}
+
+void rbusObject_Release(rbusObject_t object) {
+    if (object && __atomic_sub_fetch(&object->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        rbusProperty_Release(object->properties);
+        free(object->name);
+        free(object);
+    }
+}
+
+rbusValue_t rbusObject_GetValue(rbusObject_t object, char const *name) {
+    for (rbusProperty_t p = object->properties; p; p = p->next) {
+        if (strcmp(p->name, name) == 0) {
+            return p->value;
+        }
+    }
+
+    return NULL;
+}
+
+void rbusObject_SetValue(rbusObject_t object, char const *name, rbusValue_t value) {
+    rbusProperty_t property;
+
+    for (property = object->properties; property; property = property->next) {
+        if (strcmp(property->name, name) == 0) {
+            rbusProperty_SetValue(property, value);
+            return;
+        }
+    }
+
+    if (!rbusProperty_Init(&property, name, value)) {
+        return;
+    }
+    if (!object->properties) {
+        object->properties = property;
+        return;
+    }
+    rbusProperty_PushBack(object->properties, property);
+    rbusProperty_Release(property);
+}
+
+char const *rbusError_ToString(rbusError_t e) {
+    static const char *names[] = {
+        "SUCCESS", "BUS_ERROR", "INVALID_INPUT", "NOT_INITIALIZED", "OUT_OF_RESOURCES",
+        "DESTINATION_NOT_FOUND", "DESTINATION_NOT_REACHABLE", "DESTINATION_RESPONSE_FAILURE",
+        "INVALID_RESPONSE_FROM_DESTINATION", "INVALID_OPERATION", "INVALID_EVENT",
+        "INVALID_HANDLE", "SESSION_ALREADY_EXIST", "COMPONENT_NAME_DUPLICATE",
+        "ELEMENT_NAME_DUPLICATE", "ELEMENT_NAME_MISSING", "COMPONENT_DOES_NOT_EXIST",
+        "ELEMENT_DOES_NOT_EXIST", "ACCESS_NOT_ALLOWED", "INVALID_CONTEXT", "TIMEOUT",
+        "ASYNC_RESPONSE",
+    };
+
+    return (unsigned int)e < sizeof(names) / sizeof(names[0]) ? names[e] : "UNKNOWN";
+}
@@ -0,0 +1,463 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file input_check.c
+ * @brief Feeds scripted key events through the debounce and dedupe filter
+ *        and the gesture engine and checks what comes out
+ *
+ * Filter events carry kernel timestamps relative to the current
+ * CLOCK_MONOTONIC time, so the filter's windows are exercised without
+ * waiting for them; only the settle timer needs the event loop to run for
+ * real. Gesture deadlines are relative timers, so those cases run the
+ * loop through them; the Makefile builds the check with a shorter
+ * GESTURE_LONG_PRESS_MS. Each case starts from freshly initialised state,
+ * and the exit status says whether every case passed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "../include/button_callback.h"
+#include "../include/event_filter.h"
+#include "../include/event_loop.h"
+#include "../include/gesture.h"
+#include "../include/latency.h"
+#include "../include/utils.h"
+
+#define MAX_RECORDED 256
+
+typedef struct {
+    int code;
+    int value;
+    uint64_t time_ns;       /* Kernel timestamp the event was passed on with */
+} recorded_t;
+
+typedef struct {
+    gesture_t gesture;
+    uint64_t elapsed_ns;    /* From the start of the case to recognition */
+} recognised_t;
+
+static recorded_t recorded[MAX_RECORDED];
+static int num_recorded;
+static recognised_t recognised[MAX_RECORDED];
+static int num_recognised;
+static uint64_t gesture_base;
+static int failures;
+
+static void record_callback(const char *device, int button_code, int value,
+                            const struct timeval *timestamp) {
+    /* Prevent unused parameter warning */
+    (void)device;
+
+    if (num_recorded < MAX_RECORDED) {
+        recorded[num_recorded].code = button_code;
+        recorded[num_recorded].value = value;
+        recorded[num_recorded].time_ns = latency_from_timeval(timestamp);
+        num_recorded++;
+    }
+}
+
+static void record_gesture(const char *device, int button_code, gesture_t gesture,
+                           const struct timeval *timestamp) {
+    /* Prevent unused parameter warning */
+    (void)device;
+    (void)button_code;
+    (void)timestamp;
+
+    if (num_recognised < MAX_RECORDED) {
+        recognised[num_recognised].gesture = gesture;
+        recognised[num_recognised].elapsed_ns = latency_now() - gesture_base;
+        num_recognised++;
+    }
+}
+
+/*
+ * event_filter.c fetches its callback through get_button_callback();
+ * providing it here keeps button_callback.c and rbus out of the check.
+ */
+button_callback get_button_callback(void) {
+    return record_callback;
+}
+
+static void fail(const char *name, const char *fmt, ...) {
+    va_list args;
+
+    fprintf(stderr, "%s: ", name);
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+    failures++;
+}
+
+// Send one event, ms after base, from /dev/input/event<devt>
+static void feed(uint64_t base_ns, unsigned int ms, dev_t devt, int code, int value) {
+    uint64_t t = base_ns + (uint64_t)ms * 1000000ULL;
+    struct timeval tv;
+    char device[64];
+
+    tv.tv_sec = (time_t)(t / 1000000000ULL);
+    tv.tv_usec = (suseconds_t)(t % 1000000000ULL / 1000);
+    snprintf(device, sizeof(device), "/dev/input/event%u", (unsigned int)devt);
+    event_filter_event(devt, device, code, value, &tv);
+}
+
+static void stop_loop(int fd, uint32_t events, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)events;
+    (void)ctx;
+    uint64_t expirations;
+
+    if (read(fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+        return;
+    }
+
+    // event_loop_stop() would leave its eventfd set for the next run
+    set_running_state(false);
+}
+
+// Let the loop dispatch timers for ms
+static int run_loop(unsigned int ms) {
+    struct itimerspec its;
+    int fd, ret;
+
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot create timer: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = ms / 1000;
+    its.it_value.tv_nsec = (long)(ms % 1000) * 1000000L;
+    if (timerfd_settime(fd, 0, &its, NULL) < 0 || event_loop_add(fd, EPOLLIN, stop_loop, NULL) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    set_running_state(true);
+    ret = event_loop_run();
+    event_loop_remove(fd);
+    close(fd);
+    return ret;
+}
+
+// Start a case on a filter without key state, counters or recorded events
+static uint64_t reset(void) {
+    event_filter_config_t config = { EVENT_FILTER_DEBOUNCE_MS, EVENT_FILTER_DEDUPE_MS };
+
+    event_filter_cleanup();
+    if (event_filter_init() < 0) {
+        fprintf(stderr, "Cannot set up the debounce timer\n");
+        exit(1);
+    }
+    event_filter_set_config(&config);
+    num_recorded = 0;
+    return latency_now();
+}
+
+// The callback saw exactly the listed events; want holds code, value, ms triples
+static void expect(const char *name, uint64_t base_ns, const int *want, int count) {
+    if (num_recorded != count) {
+        fail(name, "%d events passed on, expected %d", num_recorded, count);
+    }
+
+    for (int i = 0; i < num_recorded && i < count; i++) {
+        const int *w = &want[i * 3];
+        uint64_t t = base_ns + (uint64_t)w[2] * 1000000ULL;
+
+        // Timestamps went through a timeval and lost the nanoseconds
+        if (recorded[i].code != w[0] || recorded[i].value != w[1] || recorded[i].time_ns / 1000 != t / 1000) {
+            fail(name, "event %d is code 0x%x value %d at %+.3f ms, expected code 0x%x value %d at %d ms",
+                 i, recorded[i].code, recorded[i].value,
+                 ((double)recorded[i].time_ns - (double)base_ns) / 1e6, w[0], w[1], w[2]);
+        }
+    }
+}
+
+static void expect_count(const char *name, const char *counter, unsigned long got, unsigned long want) {
+    if (got != want) {
+        fail(name, "%s is %lu, expected %lu", counter, got, want);
+    }
+}
+
+// A release and press inside the window after a press are chatter
+static void check_bounce(const char *name) {
+    const int want[] = { 0x211, 1, 0 };
+    event_filter_stats_t stats;
+    uint64_t base = reset();
+
+    feed(base, 0, 1, 0x211, 1);
+    feed(base, 5, 1, 0x211, 0);
+    feed(base, 8, 1, 0x211, 1);
+    if (run_loop(EVENT_FILTER_DEBOUNCE_MS * 2) < 0) {
+        fail(name, "event loop failed");
+    }
+
+    event_filter_get_stats(&stats);
+    expect_count(name, "debounced", stats.debounced, 2);
+    expect_count(name, "settled", stats.settled, 0);
+    expect(name, base, want, 1);
+}
+
+// A release inside the window is passed on, with its own timestamp, once
+// the window closes
+static void check_settle(const char *name) {
+    const int want[] = { 0x211, 1, 0, 0x211, 0, 5 };
+    event_filter_stats_t stats;
+    uint64_t base = reset();
+
+    feed(base, 0, 1, 0x211, 1);
+    feed(base, 5, 1, 0x211, 0);
+    if (num_recorded != 1) {
+        fail(name, "release passed on before the window closed");
+    }
+    if (run_loop(EVENT_FILTER_DEBOUNCE_MS * 2) < 0) {
+        fail(name, "event loop failed");
+    }
+
+    event_filter_get_stats(&stats);
+    expect_count(name, "settled", stats.settled, 1);
+    expect(name, base, want, 2);
+}
+
+// A second device pressing the same key inside the dedupe window is
+// dropped until it releases, even after the first device has released
+static void check_dedupe(const char *name) {
+    const int want[] = { 0x211, 1, 0, 0x211, 0, 400, 0x211, 1, 1000 };
+    event_filter_stats_t stats;
+    uint64_t base = reset();
+
+    feed(base, 0, 1, 0x211, 1);
+    feed(base, 10, 2, 0x211, 1);
+    feed(base, 300, 2, 0x211, 2);
+    feed(base, 400, 1, 0x211, 0);
+    feed(base, 450, 2, 0x211, 2);
+    feed(base, 500, 2, 0x211, 0);
+    feed(base, 1000, 2, 0x211, 1);
+
+    event_filter_get_stats(&stats);
+    expect_count(name, "deduplicated", stats.deduplicated, 4);
+    expect(name, base, want, 3);
+}
+
+// With every slot taken, a new key replaces the released key with the
+// oldest edge, and keys held down are never replaced
+static void check_eviction(const char *name) {
+    const int want[] = { 0x300, 1, 300, 0x101, 1, 36 };
+    event_filter_stats_t stats;
+    uint64_t base = reset();
+
+    // Key i on device i; key 0 is pressed again so its edge is the newest
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        feed(base, (unsigned int)i, (dev_t)i, 0x100 + i, 1);
+        feed(base, (unsigned int)i + 30, (dev_t)i, 0x100 + i, 0);
+    }
+    feed(base, 200, 0, 0x100, 1);
+    feed(base, 230, 0, 0x100, 0);
+    num_recorded = 0;
+
+    // Replaces key 1, so its press 5 ms after its release is not chatter
+    // any more, while key 0 still debounces
+    feed(base, 300, EVENT_FILTER_MAX_KEYS, 0x300, 1);
+    feed(base, 36, 1, 0x101, 1);
+    feed(base, 235, 0, 0x100, 1);
+    expect(name, base, want, 2);
+
+    // Held keys keep their slots; the key that finds none goes unfiltered
+    base = reset();
+    for (int i = 0; i < EVENT_FILTER_MAX_KEYS; i++) {
+        feed(base, 0, (dev_t)i, 0x100 + i, 1);
+    }
+    feed(base, 0, EVENT_FILTER_MAX_KEYS, 0x300, 1);
+    event_filter_get_stats(&stats);
+    expect_count(name, "untracked", stats.untracked, 1);
+    if (num_recorded != EVENT_FILTER_MAX_KEYS + 1) {
+        fail(name, "%d of %d held keys passed on", num_recorded, EVENT_FILTER_MAX_KEYS + 1);
+    }
+}
+
+// Start a gesture case with every button idle
+static void gesture_reset(void) {
+    gesture_cleanup();
+    gesture_init(record_gesture);
+    num_recognised = 0;
+    gesture_base = latency_now();
+}
+
+// Press (1) or release (0) the WPS button with every gesture bound
+static void tap(int value, unsigned int gestures) {
+    struct timeval tv;
+    uint64_t now = latency_now();
+
+    tv.tv_sec = (time_t)(now / 1000000000ULL);
+    tv.tv_usec = (suseconds_t)(now % 1000000000ULL / 1000);
+    gesture_handle_event("/dev/input/event0", 0x211, value, &tv, gestures);
+}
+
+static void run_gesture_loop(const char *name, unsigned int ms) {
+    if (run_loop(ms) < 0) {
+        fail(name, "event loop failed");
+    }
+}
+
+// Exactly the listed gestures were recognised, none of them before its
+// earliest time in ms from the start of the case
+static void expect_gestures(const char *name, const gesture_t *want, const unsigned int *earliest_ms, int count) {
+    if (num_recognised != count) {
+        fail(name, "%d gestures recognised, expected %d", num_recognised, count);
+    }
+
+    for (int i = 0; i < num_recognised && i < count; i++) {
+        if (recognised[i].gesture != want[i] || recognised[i].elapsed_ns < (uint64_t)earliest_ms[i] * 1000000ULL) {
+            fail(name, "gesture %d is %s after %.1f ms, expected %s after %u ms or later", i,
+                 gesture_name(recognised[i].gesture), recognised[i].elapsed_ns / 1e6,
+                 gesture_name(want[i]), earliest_ms[i]);
+        }
+    }
+}
+
+#define ALL_GESTURES (GESTURE_BIT(GESTURE_SHORT_PRESS) | GESTURE_BIT(GESTURE_LONG_PRESS) | \
+                      GESTURE_BIT(GESTURE_DOUBLE_TAP))
+
+// A tap is only a short press once no second tap came within the
+// multi-tap window; without a double tap bound it is one at release
+static void check_multi_tap(const char *name) {
+    const gesture_t want[] = { GESTURE_SHORT_PRESS };
+    const unsigned int earliest[] = { GESTURE_MULTI_TAP_MS };
+
+    gesture_reset();
+    tap(1, ALL_GESTURES);
+    tap(0, ALL_GESTURES);
+    run_gesture_loop(name, GESTURE_MULTI_TAP_MS - 100);
+    if (num_recognised != 0) {
+        fail(name, "short press recognised before the multi-tap window closed");
+    }
+    run_gesture_loop(name, 200);
+    expect_gestures(name, want, earliest, 1);
+
+    gesture_reset();
+    tap(1, GESTURE_BIT(GESTURE_SHORT_PRESS));
+    tap(0, GESTURE_BIT(GESTURE_SHORT_PRESS));
+    if (num_recognised != 1 || recognised[0].gesture != GESTURE_SHORT_PRESS) {
+        fail(name, "short press without a double tap bound not recognised at release");
+    }
+}
+
+// A second tap inside the window is a double tap and nothing else
+static void check_double_tap(const char *name) {
+    const gesture_t want[] = { GESTURE_DOUBLE_TAP };
+    const unsigned int earliest[] = { 100 };
+
+    gesture_reset();
+    tap(1, ALL_GESTURES);
+    tap(0, ALL_GESTURES);
+    run_gesture_loop(name, 100);
+    tap(1, ALL_GESTURES);
+    tap(0, ALL_GESTURES);
+    run_gesture_loop(name, GESTURE_MULTI_TAP_MS + 100);
+    expect_gestures(name, want, earliest, 1);
+}
+
+// The long press is recognised while the button is still down, and the
+// release that follows adds nothing
+static void check_long_press(const char *name) {
+    const gesture_t want[] = { GESTURE_LONG_PRESS };
+    const unsigned int earliest[] = { GESTURE_LONG_PRESS_MS };
+
+    gesture_reset();
+    tap(1, ALL_GESTURES);
+    run_gesture_loop(name, GESTURE_LONG_PRESS_MS + 100);
+    if (num_recognised != 1) {
+        fail(name, "long press not recognised while the button was held");
+    }
+    tap(0, ALL_GESTURES);
+    run_gesture_loop(name, GESTURE_MULTI_TAP_MS + 100);
+    expect_gestures(name, want, earliest, 1);
+}
+
+// A second tap that is held becomes a long press, timed from that press,
+// instead of a double tap
+static void check_tap_then_hold(const char *name) {
+    const gesture_t want[] = { GESTURE_LONG_PRESS };
+    const unsigned int earliest[] = { 100 + GESTURE_LONG_PRESS_MS };
+
+    gesture_reset();
+    tap(1, ALL_GESTURES);
+    tap(0, ALL_GESTURES);
+    run_gesture_loop(name, 100);
+    tap(1, ALL_GESTURES);
+    run_gesture_loop(name, GESTURE_LONG_PRESS_MS + 100);
+    tap(0, ALL_GESTURES);
+    run_gesture_loop(name, GESTURE_MULTI_TAP_MS + 100);
+    expect_gestures(name, want, earliest, 1);
+}
+
+static void run_case(const char *section, const char *name, void (*check)(const char *name)) {
+    int before = failures;
+
+    check(name);
+    if (failures == before) {
+        printf("%-11s %s ok\n", section, name);
+    }
+}
+
+static void show_usage(const char *prog_name) {
+    printf("Usage: %s [options]\n", prog_name);
+    printf("Options:\n");
+    printf("  -v, --verbose        Log daemon messages to stderr\n");
+    printf("  -h, --help           Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            log_init(false, false);
+        } else {
+            show_usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (event_loop_init() < 0) {
+        fprintf(stderr, "Cannot create the event loop\n");
+        return 1;
+    }
+
+    run_case("filter:", "bounce inside the window", check_bounce);
+    run_case("filter:", "settle on timer expiry", check_settle);
+    run_case("filter:", "cross-device duplicate", check_dedupe);
+    run_case("filter:", "slot eviction", check_eviction);
+    run_case("gesture:", "multi-tap wait", check_multi_tap);
+    run_case("gesture:", "double tap", check_double_tap);
+    run_case("gesture:", "long press while held", check_long_press);
+    run_case("gesture:", "double tap turning into a hold", check_tap_then_hold);
+
+    event_filter_cleanup();
+    gesture_cleanup();
+    event_loop_cleanup();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,386 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file uevent_bench.c
+ * @brief Replays a recorded uevent corpus through the legacy and the
+ *        zero-copy parser and reports the cost per message
+ *
+ * Before measuring, every message of the corpus and a set of built-in
+ * ones is sent through the uevent socket filter on a socketpair; an input
+ * uevent the filter drops fails the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include "../include/uevent_parser.h"
+
+#define DEFAULT_CORPUS "tools/uevent_corpus.txt"
+#define DEFAULT_ITERATIONS 20000
+#define MAX_MESSAGES 4096
+
+/*
+ * Messages the filter has to get right whatever the corpus holds, as
+ * corpus blocks. Each is also sent with 1-3 extra bytes in the header so
+ * every alignment of SUBSYSTEM against the filter's word loads is tried.
+ */
+static const char *filter_cases[] = {
+    // LNXSYSTM holds SYST, a false start of SUBSYSTEM before the real one
+    "add@/devices/LNXSYSTM:00/LNXPWRBN:00/input/input3\n"
+    "ACTION=add\n"
+    "DEVPATH=/devices/LNXSYSTM:00/LNXPWRBN:00/input/input3\n"
+    "SUBSYSTEM=input\n"
+    "PRODUCT=19/0/1/0\n"
+    "NAME=\"Power Button\"\n"
+    "SEQNUM=2011\n",
+    "add@/devices/platform/soc/soc:gpio-keys/input/input0/event0\n"
+    "ACTION=add\n"
+    "DEVPATH=/devices/platform/soc/soc:gpio-keys/input/input0/event0\n"
+    "SUBSYSTEM=input\n"
+    "MAJOR=13\n"
+    "MINOR=64\n"
+    "DEVNAME=input/event0\n"
+    "SEQNUM=2012\n",
+    "add@/devices/virtual/net/brlan0\n"
+    "ACTION=add\n"
+    "DEVPATH=/devices/virtual/net/brlan0\n"
+    "SUBSYSTEM=net\n"
+    "INTERFACE=brlan0\n"
+    "IFINDEX=7\n"
+    "SEQNUM=2013\n",
+};
+
+typedef struct {
+    char *data;
+    size_t len;
+} message_t;
+
+static message_t messages[MAX_MESSAGES];
+static int num_messages = 0;
+
+// Defeats dead-code elimination of the parse results
+static volatile unsigned long sink;
+
+/*
+ * Parsing half of the original parse_netlink_message(): strncmp/strstr on
+ * every line and copies into fixed buffers.
+ */
+static void legacy_parse(const char *buffer, int len) {
+    char device_path[256] = {0};
+    char action[32] = {0};
+    int is_input_device = 0;
+    const char *ptr = buffer;
+    const char *end = buffer + len;
+
+    while (ptr < end && *ptr) {
+        if (strncmp(ptr, "ACTION=", 7) == 0) {
+            strncpy(action, ptr + 7, sizeof(action) - 1);
+        }
+        else if (strncmp(ptr, "DEVNAME=", 8) == 0) {
+            if (strstr(ptr + 8, "input/event") != NULL) {
+                is_input_device = 1;
+                snprintf(device_path, sizeof(device_path), "/dev/%s", ptr + 8);
+            }
+        }
+
+        while (ptr < end && *ptr) ptr++;
+        ptr++;
+    }
+
+    sink += (unsigned long)is_input_device + (unsigned char)action[0] + (unsigned char)device_path[5];
+}
+
+static void zero_copy_parse(const char *buffer, int len) {
+    uevent_t ev;
+
+    if (uevent_parse(buffer, (size_t)len, &ev) == 0) {
+        sink += ev.action.len + ev.devname.len + (unsigned long)ev.seqnum;
+    }
+}
+
+// Lines become the NUL separated entries the kernel sends
+static size_t to_message(const char *text, size_t len, char *out, size_t size) {
+    if (len + 1 > size) {
+        return 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (text[i] == '\n') ? '\0' : text[i];
+    }
+    out[len] = '\0';
+    return len + 1;
+}
+
+static void add_message(const char *text, size_t len) {
+    char *data;
+
+    if (len == 0 || num_messages == MAX_MESSAGES) {
+        return;
+    }
+
+    data = malloc(len + 1);
+    if (!data) {
+        return;
+    }
+
+    messages[num_messages].data = data;
+    messages[num_messages].len = to_message(text, len, data, len + 1);
+    num_messages++;
+}
+
+static int load_corpus(const char *path) {
+    FILE *f = fopen(path, "r");
+    char line[4096];
+    char block[8192];
+    size_t block_len = 0;
+
+    if (!f) {
+        fprintf(stderr, "Cannot open corpus %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        size_t line_len = strlen(line);
+
+        if (line[0] == '#') {
+            continue;
+        }
+
+        if (line[0] == '\n') {
+            add_message(block, block_len);
+            block_len = 0;
+            continue;
+        }
+
+        if (block_len + line_len < sizeof(block)) {
+            memcpy(block + block_len, line, line_len);
+            block_len += line_len;
+        }
+    }
+
+    add_message(block, block_len);
+
+    fclose(f);
+    return num_messages > 0 ? 0 : -1;
+}
+
+static double run(void (*parse)(const char *, int), long iterations) {
+    struct timespec start, stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long it = 0; it < iterations; it++) {
+        for (int i = 0; i < num_messages; i++) {
+            parse(messages[i].data, (int)messages[i].len);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    return ((double)(stop.tv_sec - start.tv_sec) * 1e9 + (double)(stop.tv_nsec - start.tv_nsec)) /
+           ((double)iterations * num_messages);
+}
+
+// 1 if the filter lets the message through, -1 on a socket error
+static int filter_passes(int sv[2], const char *data, size_t len) {
+    char buffer[8192];
+
+    if (send(sv[0], data, len, 0) != (ssize_t)len) {
+        return -1;
+    }
+    return recv(sv[1], buffer, sizeof(buffer), MSG_DONTWAIT) > 0;
+}
+
+static int is_input(const char *data, size_t len) {
+    uevent_t ev;
+
+    return uevent_parse(data, len, &ev) == 0 && uevent_str_eq(ev.subsystem, "input");
+}
+
+/*
+ * The filter may pass anything to user space, the parser sorts it out
+ * there, but an input uevent it drops is lost for good.
+ */
+static int check_filter(void) {
+    unsigned long inputs = 0, others = 0, lost = 0, passed = 0;
+    char text[8192];
+    char data[8192];
+    int sv[2];
+    int ret = 0;
+
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, sv) < 0 || uevent_filter_attach(sv[1]) < 0) {
+        fprintf(stderr, "Cannot attach uevent filter: %s\n", strerror(errno));
+        return -1;
+    }
+
+    for (size_t c = 0; c < sizeof(filter_cases) / sizeof(filter_cases[0]) + (size_t)num_messages; c++) {
+        for (int shift = 0; shift < 4; shift++) {
+            size_t len;
+            int input, pass;
+
+            if (c < sizeof(filter_cases) / sizeof(filter_cases[0])) {
+                const char *at = strchr(filter_cases[c], '@');
+
+                // Pad the devpath in the header, which nothing parses
+                snprintf(text, sizeof(text), "%.*s%.*s%s", (int)(at - filter_cases[c] + 1),
+                         filter_cases[c], shift, "///", at + 1);
+                len = to_message(text, strlen(text), data, sizeof(data));
+            } else if (shift == 0) {
+                const message_t *m = &messages[c - sizeof(filter_cases) / sizeof(filter_cases[0])];
+
+                len = m->len;
+                memcpy(data, m->data, len);
+            } else {
+                continue;
+            }
+
+            input = is_input(data, len);
+            pass = filter_passes(sv, data, len);
+            if (pass < 0) {
+                fprintf(stderr, "Cannot send through the filter: %s\n", strerror(errno));
+                ret = -1;
+                break;
+            }
+
+            if (input) {
+                inputs++;
+                if (!pass) {
+                    lost++;
+                    fprintf(stderr, "filter dropped input uevent: %s\n", data);
+                }
+            } else {
+                others++;
+                passed += (unsigned long)pass;
+            }
+        }
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+
+    printf("filter:     %lu input uevents, %lu dropped; %lu others, %lu passed to the parser\n",
+           inputs, lost, others, passed);
+    return ret < 0 || lost > 0 ? -1 : 0;
+}
+
+// Record live uevents in corpus format on stdout
+static int capture(int count) {
+    struct sockaddr_nl addr;
+    char buffer[8192];
+    int sock;
+
+    sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_KOBJECT_UEVENT);
+    if (sock < 0) {
+        fprintf(stderr, "Cannot create uevent socket: %s\n", strerror(errno));
+        return 1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1;
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "Cannot bind uevent socket: %s\n", strerror(errno));
+        close(sock);
+        return 1;
+    }
+
+    for (int n = 0; n < count; n++) {
+        ssize_t len = recv(sock, buffer, sizeof(buffer) - 1, 0);
+        if (len <= 0) {
+            break;
+        }
+        buffer[len] = '\0';
+
+        for (ssize_t i = 0; i < len; i += (ssize_t)strlen(buffer + i) + 1) {
+            printf("%s\n", buffer + i);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    close(sock);
+    return 0;
+}
+
+static void show_usage(const char *prog_name) {
+    printf("Usage: %s [options]\n", prog_name);
+    printf("Options:\n");
+    printf("  -f, --corpus <file>  Corpus to replay (default %s)\n", DEFAULT_CORPUS);
+    printf("  -n, --iterations <n> Replays of the corpus (default %d)\n", DEFAULT_ITERATIONS);
+    printf("  -c, --capture <n>    Record n live uevents to stdout and exit\n");
+    printf("  -F, --filter-only    Only check the uevent socket filter against the corpus\n");
+    printf("  -h, --help           Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *corpus = DEFAULT_CORPUS;
+    long iterations = DEFAULT_ITERATIONS;
+    double legacy_ns, zero_copy_ns;
+    int filter_only = 0;
+    int filter_ok;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--corpus") == 0) && i + 1 < argc) {
+            corpus = argv[++i];
+        } else if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--iterations") == 0) && i + 1 < argc) {
+            iterations = atol(argv[++i]);
+        } else if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--capture") == 0) && i + 1 < argc) {
+            return capture(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-F") == 0 || strcmp(argv[i], "--filter-only") == 0) {
+            filter_only = 1;
+        } else {
+            show_usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (iterations <= 0 || load_corpus(corpus) < 0) {
+        fprintf(stderr, "Nothing to replay\n");
+        return 1;
+    }
+
+    filter_ok = check_filter() == 0;
+    if (!filter_ok || filter_only) {
+        for (int i = 0; i < num_messages; i++) {
+            free(messages[i].data);
+        }
+        return filter_ok ? 0 : 1;
+    }
+
+    // Warm caches and branch predictors before measuring
+    run(legacy_parse, iterations / 10 + 1);
+    run(zero_copy_parse, iterations / 10 + 1);
+
+    legacy_ns = run(legacy_parse, iterations);
+    zero_copy_ns = run(zero_copy_parse, iterations);
+
+    printf("corpus:     %s (%d messages x %ld iterations)\n", corpus, num_messages, iterations);
+    printf("legacy:     %8.1f ns/message\n", legacy_ns);
+    printf("zero-copy:  %8.1f ns/message\n", zero_copy_ns);
+    printf("speedup:    %8.2fx\n", zero_copy_ns > 0 ? legacy_ns / zero_copy_ns : 0.0);
+
+    for (int i = 0; i < num_messages; i++) {
+        free(messages[i].data);
+    }
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wps_journal.c
+ * @brief Decodes the daemon's binary event journal, oldest record first
+ *
+ * Works on the journal of a running daemon as well as one left behind by
+ * a crash; records that are being overwritten while they are read are
+ * skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/journal.h"
+
+#define JOURNAL_SIZE (JOURNAL_HEADER_SIZE + JOURNAL_RECORDS * sizeof(journal_record_t))
+
+static const char *type_names[] = {
+    "?", "start", "key", "gesture", "submit", "action", "add", "remove", "resync", "config", "wps"
+};
+
+// Same order as gesture_t
+static const char *gesture_names[] = { "short press", "long press", "double tap" };
+
+static const char *submit_names[] = { "queued", "coalesced", "dropped" };
+
+// Same order as wps_session_state_t
+static const char *wps_names[] = { "idle", "active", "success", "timeout", "failure" };
+
+static const char *type_name(unsigned int type) {
+    return type < sizeof(type_names) / sizeof(type_names[0]) ? type_names[type] : "?";
+}
+
+static void format_value(const journal_record_t *r, char *buf, size_t len) {
+    switch (r->type) {
+    case JOURNAL_GESTURE:
+        if (r->value >= 0 && (size_t)r->value < sizeof(gesture_names) / sizeof(gesture_names[0])) {
+            snprintf(buf, len, "%s", gesture_names[r->value]);
+            return;
+        }
+        break;
+    case JOURNAL_SUBMIT:
+        if (r->value >= 0 && (size_t)r->value < sizeof(submit_names) / sizeof(submit_names[0])) {
+            snprintf(buf, len, "%s", submit_names[r->value]);
+            return;
+        }
+        break;
+    case JOURNAL_WPS:
+        if (r->value >= 0 && (size_t)r->value < sizeof(wps_names) / sizeof(wps_names[0])) {
+            snprintf(buf, len, "%s", wps_names[r->value]);
+            return;
+        }
+        break;
+    case JOURNAL_ACTION:
+        snprintf(buf, len, "%s", r->value == 0 ? "ok" : "failed");
+        return;
+    case JOURNAL_START:
+        snprintf(buf, len, "pid %d", r->value);
+        return;
+    case JOURNAL_RESYNC:
+        snprintf(buf, len, "%d devices", r->value);
+        return;
+    case JOURNAL_CONFIG:
+        snprintf(buf, len, "generation %d", r->value);
+        return;
+    default:
+        break;
+    }
+    snprintf(buf, len, "%d", r->value);
+}
+
+static void print_record(const journal_header_t *header, const journal_record_t *r) {
+    int64_t wall_ns = (int64_t)r->time_ns + header->realtime_offset_ns;
+    time_t wall = (time_t)(wall_ns / 1000000000LL);
+    char when[32], dev[24], value[32];
+    const char *action = "-";
+    struct tm tm;
+
+    localtime_r(&wall, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+
+    if (r->dev) {
+        snprintf(dev, sizeof(dev), "%u:%u", r->dev >> 20, r->dev & 0xfffff);
+    } else {
+        snprintf(dev, sizeof(dev), "-");
+    }
+
+    if (r->action < header->action_count) {
+        action = header->actions[r->action];
+    }
+
+    format_value(r, value, sizeof(value));
+
+    printf("%10u %10llu.%06llu %s.%06lld %-8s %-9s %5u %-16s %10u %s\n",
+           r->seq,
+           (unsigned long long)(r->time_ns / 1000000000ULL),
+           (unsigned long long)(r->time_ns % 1000000000ULL / 1000),
+           when, (long long)(wall_ns % 1000000000LL / 1000),
+           type_name(r->type), dev, r->code, value, r->latency_us, action);
+}
+
+static void show_usage(const char *prog_name) {
+    printf("Usage: %s [options] [journal]\n", prog_name);
+    printf("Decodes %s unless another journal is given\n", JOURNAL_FILE);
+    printf("Options:\n");
+    printf("  -n, --records <n>    Only the newest n records\n");
+    printf("  -h, --help           Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = JOURNAL_FILE;
+    const journal_header_t *header;
+    const journal_record_t *records;
+    uint32_t next, first, count = JOURNAL_RECORDS;
+    unsigned long printed = 0, skipped = 0;
+    struct stat st;
+    void *map;
+    int fd;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--records") == 0) && i + 1 < argc) {
+            count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            show_usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    if (fstat(fd, &st) < 0 || st.st_size != (off_t)JOURNAL_SIZE) {
+        fprintf(stderr, "%s is not a journal of this version\n", path);
+        close(fd);
+        return 1;
+    }
+
+    map = mmap(NULL, JOURNAL_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    header = (const journal_header_t *)map;
+    records = (const journal_record_t *)((const char *)map + JOURNAL_HEADER_SIZE);
+
+    if (memcmp(header->magic, JOURNAL_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != JOURNAL_VERSION || header->record_size != sizeof(journal_record_t) ||
+        header->records != JOURNAL_RECORDS) {
+        fprintf(stderr, "%s is not a journal of this version\n", path);
+        munmap(map, JOURNAL_SIZE);
+        return 1;
+    }
+
+    // Records seq - 1 are in slot (seq - 1) % JOURNAL_RECORDS
+    next = __atomic_load_n(&header->next_seq, __ATOMIC_ACQUIRE);
+    if (count > JOURNAL_RECORDS) {
+        count = JOURNAL_RECORDS;
+    }
+    first = next > count ? next - count : 0;
+
+    printf("%10s %17s %26s %-8s %-9s %5s %-16s %10s %s\n",
+           "seq", "monotonic", "wall time", "type", "dev", "code", "value", "latency_us", "action");
+
+    for (uint32_t seq = first; seq != next; seq++) {
+        const journal_record_t *slot = &records[seq & (JOURNAL_RECORDS - 1)];
+        journal_record_t r;
+
+        // Copy, then check the writer did not reuse the slot meanwhile
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq + 1) {
+            skipped++;
+            continue;
+        }
+        memcpy(&r, slot, sizeof(r));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq + 1) {
+            skipped++;
+            continue;
+        }
+
+        print_record(header, &r);
+        printed++;
+    }
+
+    printf("%lu records, %lu skipped, %u written in total\n", printed, skipped, next);
+    munmap(map, JOURNAL_SIZE);
+    return 0;
+}
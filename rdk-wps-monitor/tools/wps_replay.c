@@ -0,0 +1,492 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2025 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wps_replay.c
+ * @brief Drives the daemon's event loop, device registry and hotplug path
+ *        with scripted hotplug storms and button presses delivered through
+ *        FIFOs, and reports throughput, latency and CPU cost
+ *
+ * Each cycle announces every device with an "add" uevent on a FIFO read
+ * by the stream hotplug backend, waits for the daemon to open the device
+ * FIFOs, sends the presses, then removes the devices again. The loop runs
+ * on the main thread exactly as in the daemon; a generator thread plays
+ * the kernel.
+ *
+ * With -i the first cycle also holds the devices plugged and silent for
+ * a while; the loop must not wake up once in that time, and the exit
+ * status says whether it did.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <linux/input.h>
+#include "../include/button_bus.h"
+#include "../include/button_callback.h"
+#include "../include/device_monitor.h"
+#include "../include/event_filter.h"
+#include "../include/event_loop.h"
+#include "../include/hotplug_monitor.h"
+#include "../include/latency.h"
+#include "../include/realtime.h"
+#include "../include/uring_reader.h"
+#include "../include/utils.h"
+
+#define DEFAULT_DEVICES 4
+#define DEFAULT_PRESSES 1000
+#define DEFAULT_CYCLES 10
+#define FIRST_EVENT_NUMBER 1000
+#define SETTLE_TIMEOUT_MS 5000
+
+typedef struct {
+    int devices;
+    long presses;           /* Per device and cycle */
+    long rate;              /* Presses per second over all devices, 0 = unpaced */
+    int cycles;
+    int io_uring;           /* Read devices through uring_reader */
+    int realtime;           /* Run the loop in real-time mode */
+    realtime_config_t rt;
+    int subscribers;        /* Bus subscribers on threads of their own */
+    int idle_s;             /* Seconds of silence to check for wakeups, 0 = no check */
+} replay_config_t;
+
+static replay_config_t config = { DEFAULT_DEVICES, DEFAULT_PRESSES, 0, DEFAULT_CYCLES, 0, 0, { 0, -1 }, 0, 0 };
+static button_bus_subscriber_t *subscribers[BUTTON_BUS_MAX_SUBSCRIBERS];
+static char dir[64];
+static char stream_path[128];
+
+// Written by the loop thread, read by the generator
+static uint64_t *samples = NULL;
+static long max_samples = 0;
+static long num_samples = 0;
+static long key_events = 0;
+
+// Written by the generator before it stops the loop
+static unsigned long idle_wakeups = 0;
+
+static uint64_t now_ns(void) {
+    return latency_now();
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+
+    nanosleep(&ts, NULL);
+}
+
+// Press to callback latency, taken from the timestamp the generator wrote
+static void replay_callback(const char *device, int button_code, int value,
+                            const struct timeval *timestamp) {
+    /* Prevent unused parameter warning */
+    (void)device;
+    (void)button_code;
+    uint64_t latency = now_ns() - latency_from_timeval(timestamp);
+
+    if (value == 1 && num_samples < max_samples) {
+        samples[num_samples] = latency;
+        __atomic_store_n(&num_samples, num_samples + 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&key_events, key_events + 1, __ATOMIC_RELEASE);
+}
+
+// Bus subscribers only count what they get
+static void subscriber_event(const button_event_t *event, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)event;
+    (void)ctx;
+}
+
+static void print_subscriber(const button_bus_stats_t *stats, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)ctx;
+
+    printf("bus %-13s %lu delivered, %lu dropped, max depth %u/%u, lag max %.1f us\n",
+           stats->name, stats->delivered, stats->dropped, stats->max_depth, stats->capacity,
+           stats->max_lag_ns / 1000.0);
+}
+
+/*
+ * device_monitor.c fetches its callback through get_button_callback();
+ * providing it here keeps button_callback.c and rbus out of the harness.
+ */
+button_callback get_button_callback(void) {
+    return replay_callback;
+}
+
+static void write_uevent(int fd, const char *action, int number, unsigned long seqnum) {
+    char msg[512];
+    int len = snprintf(msg, sizeof(msg),
+                       "%s@/devices/virtual/input/input%d/event%d\n"
+                       "ACTION=%s\n"
+                       "DEVPATH=/devices/virtual/input/input%d/event%d\n"
+                       "SUBSYSTEM=input\n"
+                       "DEVNAME=input/event%d\n"
+                       "SEQNUM=%lu\n\n",
+                       action, number, number, action, number, number, number, seqnum);
+
+    if (write(fd, msg, (size_t)len) != len) {
+        fprintf(stderr, "Short write to uevent stream: %s\n", strerror(errno));
+    }
+}
+
+// Opening the write side fails with ENXIO until the daemon has opened it
+static int wait_for_reader(const char *path) {
+    uint64_t deadline = now_ns() + SETTLE_TIMEOUT_MS * 1000000ULL;
+    int fd;
+
+    while ((fd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        if (errno != ENXIO || now_ns() > deadline) {
+            return -1;
+        }
+        sleep_ns(100000);
+    }
+
+    // Block rather than fail when the daemon falls behind
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    return fd;
+}
+
+static void count_device(const input_device_t *dev, void *ctx) {
+    /* Prevent unused parameter warning */
+    (void)dev;
+    (*(int *)ctx)++;
+}
+
+static int monitored_devices(void) {
+    int count = 0;
+
+    device_monitor_foreach(count_device, &count);
+    return count;
+}
+
+static int send_press(int fd) {
+    struct input_event ev[4];
+    struct timeval tv;
+    uint64_t t = now_ns();
+
+    tv.tv_sec = (time_t)(t / 1000000000ULL);
+    tv.tv_usec = (suseconds_t)((t % 1000000000ULL) / 1000);
+
+    memset(ev, 0, sizeof(ev));
+    for (int i = 0; i < 4; i++) {
+        ev[i].time = tv;
+    }
+    ev[0].type = EV_KEY;
+    ev[0].code = KEY_WPS_BUTTON;
+    ev[0].value = 1;
+    ev[1].type = EV_SYN;
+    ev[1].code = SYN_REPORT;
+    ev[2].type = EV_KEY;
+    ev[2].code = KEY_WPS_BUTTON;
+    ev[2].value = 0;
+    ev[3].type = EV_SYN;
+    ev[3].code = SYN_REPORT;
+
+    // Under PIPE_BUF, so the frame arrives in one piece
+    return write(fd, ev, sizeof(ev)) == (ssize_t)sizeof(ev) ? 0 : -1;
+}
+
+static void *generator_thread(void *arg) {
+    /* Prevent unused parameter warning */
+    (void)arg;
+    int *fds = calloc((size_t)config.devices, sizeof(int));
+    unsigned long seqnum = 1;
+    uint64_t interval = config.rate > 0 ? 1000000000ULL / (uint64_t)config.rate : 0;
+    uint64_t next = now_ns();
+    long expected = 0;
+    int stream_fd;
+
+    stream_fd = open(stream_path, O_WRONLY | O_CLOEXEC);
+    if (!fds || stream_fd < 0) {
+        fprintf(stderr, "Cannot open uevent stream %s\n", stream_path);
+        free(fds);
+        event_loop_stop();
+        return NULL;
+    }
+
+    for (int cycle = 0; cycle < config.cycles; cycle++) {
+        char path[128];
+        int ready = 1;
+
+        // Hotplug storm: every device appears at once
+        for (int d = 0; d < config.devices; d++) {
+            snprintf(path, sizeof(path), "%s/event%d", dir, FIRST_EVENT_NUMBER + d);
+            if (mkfifo(path, 0600) < 0 && errno != EEXIST) {
+                fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+            }
+            write_uevent(stream_fd, "add", FIRST_EVENT_NUMBER + d, seqnum++);
+        }
+
+        for (int d = 0; d < config.devices; d++) {
+            snprintf(path, sizeof(path), "%s/event%d", dir, FIRST_EVENT_NUMBER + d);
+            fds[d] = wait_for_reader(path);
+            if (fds[d] < 0) {
+                fprintf(stderr, "Daemon never opened %s\n", path);
+                ready = 0;
+            }
+        }
+
+        // Every device is open and silent; the loop has no reason to wake
+        if (ready && cycle == 0 && config.idle_s > 0) {
+            unsigned long before;
+
+            // Let the loop finish handling the hotplug burst first
+            sleep_ns(100000000ULL);
+            before = event_loop_get_wakeups();
+            sleep_ns((uint64_t)config.idle_s * 1000000000ULL);
+            idle_wakeups = event_loop_get_wakeups() - before;
+        }
+
+        // Presses round-robin over the devices at the configured rate
+        for (long p = 0; ready && p < config.presses * config.devices; p++) {
+            if (interval) {
+                next += interval;
+                while (now_ns() < next) {
+                    sleep_ns(next - now_ns());
+                }
+            }
+            if (send_press(fds[p % config.devices]) == 0) {
+                expected += 2;
+            }
+        }
+
+        // Let the loop drain before the devices go away
+        uint64_t deadline = now_ns() + SETTLE_TIMEOUT_MS * 1000000ULL;
+        while (__atomic_load_n(&key_events, __ATOMIC_ACQUIRE) < expected && now_ns() < deadline) {
+            sleep_ns(100000);
+        }
+
+        for (int d = 0; d < config.devices; d++) {
+            write_uevent(stream_fd, "remove", FIRST_EVENT_NUMBER + d, seqnum++);
+            if (fds[d] >= 0) {
+                close(fds[d]);
+            }
+            snprintf(path, sizeof(path), "%s/event%d", dir, FIRST_EVENT_NUMBER + d);
+            unlink(path);
+        }
+
+        deadline = now_ns() + SETTLE_TIMEOUT_MS * 1000000ULL;
+        while (monitored_devices() > 0 && now_ns() < deadline) {
+            sleep_ns(100000);
+        }
+    }
+
+    close(stream_fd);
+    free(fds);
+    event_loop_stop();
+    return NULL;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t *sorted, long n, double q) {
+    long index = (long)(q * (double)(n - 1) + 0.5);
+
+    return n > 0 ? (double)sorted[index] / 1000.0 : 0.0;
+}
+
+static double cpu_ns(const struct rusage *ru) {
+    return ((double)ru->ru_utime.tv_sec + (double)ru->ru_stime.tv_sec) * 1e9 +
+           ((double)ru->ru_utime.tv_usec + (double)ru->ru_stime.tv_usec) * 1e3;
+}
+
+static void report(uint64_t wall_ns, const struct rusage *start, const struct rusage *stop) {
+    long sent = config.presses * config.devices * config.cycles;
+    latency_summary_t hotplug;
+    double seconds = (double)wall_ns / 1e9;
+    double loop_cpu = cpu_ns(stop) - cpu_ns(start);
+
+    qsort(samples, (size_t)num_samples, sizeof(samples[0]), compare_u64);
+    latency_get_summary(LATENCY_UEVENT_TO_MONITORED, &hotplug);
+
+    printf("devices:          %d x %d cycles (%ld hotplugs), %s reads\n", config.devices, config.cycles,
+           2L * config.devices * config.cycles, uring_reader_enabled() ? "io_uring" : "read()");
+    printf("presses:          %ld sent, %ld delivered", sent, num_samples);
+    if (config.rate > 0) {
+        printf(" at %ld/s", config.rate);
+    }
+    printf("\n");
+    printf("throughput:       %.0f key events/s over %.3f s\n", (double)key_events / seconds, seconds);
+    printf("press->callback:  p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f us\n",
+           percentile_us(samples, num_samples, 0.50), percentile_us(samples, num_samples, 0.90),
+           percentile_us(samples, num_samples, 0.99), percentile_us(samples, num_samples, 0.999),
+           percentile_us(samples, num_samples, 1.0));
+    printf("uevent->monitored: p50 %.1f  p99 %.1f  max %.1f us (%llu devices)\n",
+           hotplug.p50_ns / 1000.0, hotplug.p99_ns / 1000.0, hotplug.max_ns / 1000.0,
+           (unsigned long long)hotplug.count);
+    printf("loop CPU:         %.0f ns/key event (%.1f ms total)\n",
+           key_events > 0 ? loop_cpu / (double)key_events : 0.0, loop_cpu / 1e6);
+    printf("loop faults:      %ld minor, %ld major\n", stop->ru_minflt - start->ru_minflt,
+           stop->ru_majflt - start->ru_majflt);
+    printf("loop wakeups:     %lu (%.1f key events each)\n", event_loop_get_wakeups(),
+           event_loop_get_wakeups() > 0 ? (double)key_events / (double)event_loop_get_wakeups() : 0.0);
+    if (config.idle_s > 0) {
+        printf("idle wakeups:     %lu in %d s with %d devices (%s)\n", idle_wakeups, config.idle_s,
+               config.devices, idle_wakeups == 0 ? "ok" : "FAILED");
+    }
+    if (uring_reader_enabled()) {
+        uring_reader_stats_t ring;
+
+        uring_reader_get_stats(&ring);
+        printf("io_uring:         %lu completions, %lu submits, %lu stalls\n",
+               ring.completions, ring.submits, ring.stalls);
+    }
+    button_bus_foreach(print_subscriber, NULL);
+    printf("\n");
+    latency_dump(stdout);
+}
+
+static void show_usage(const char *prog_name) {
+    printf("Usage: %s [options]\n", prog_name);
+    printf("Options:\n");
+    printf("  -d, --devices <n>    Devices plugged per cycle (default %d)\n", DEFAULT_DEVICES);
+    printf("  -p, --presses <n>    Presses per device and cycle (default %d)\n", DEFAULT_PRESSES);
+    printf("  -r, --rate <n>       Presses per second over all devices (default unpaced)\n");
+    printf("  -c, --cycles <n>     Hotplug cycles (default %d)\n", DEFAULT_CYCLES);
+    printf("  -R, --realtime <prio>[:<cpu>] Run the loop SCHED_FIFO with memory locked\n");
+    printf("  -b, --bus <n>        Publish key events to n bus subscribers on their own threads\n");
+    printf("  -i, --idle <s>       Fail if the loop wakes up while the devices are idle for s seconds\n");
+    printf("  -u, --io-uring       Read devices through io_uring instead of read()\n");
+    printf("  -v, --verbose        Log daemon messages to stderr\n");
+    printf("  -h, --help           Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+    struct rusage ru_start, ru_stop;
+    pthread_t generator;
+    uint64_t started;
+    int ret = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--devices") == 0) && i + 1 < argc) {
+            config.devices = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--presses") == 0) && i + 1 < argc) {
+            config.presses = atol(argv[++i]);
+        } else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--rate") == 0) && i + 1 < argc) {
+            config.rate = atol(argv[++i]);
+        } else if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cycles") == 0) && i + 1 < argc) {
+            config.cycles = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-R") == 0 || strcmp(argv[i], "--realtime") == 0) && i + 1 < argc) {
+            if (realtime_parse(argv[++i], &config.rt) < 0) {
+                show_usage(argv[0]);
+                return 1;
+            }
+            config.realtime = 1;
+        } else if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--bus") == 0) && i + 1 < argc) {
+            config.subscribers = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--idle") == 0) && i + 1 < argc) {
+            config.idle_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--io-uring") == 0) {
+            config.io_uring = 1;
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            log_init(false, false);
+        } else {
+            show_usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (config.devices <= 0 || config.presses < 0 || config.rate < 0 || config.cycles <= 0 ||
+        config.subscribers < 0 || config.subscribers > BUTTON_BUS_MAX_SUBSCRIBERS || config.idle_s < 0) {
+        show_usage(argv[0]);
+        return 1;
+    }
+
+    max_samples = config.presses * config.devices * config.cycles;
+    samples = calloc((size_t)max_samples + 1, sizeof(samples[0]));
+    snprintf(dir, sizeof(dir), "/tmp/wps-replay.XXXXXX");
+    if (!samples || !mkdtemp(dir)) {
+        fprintf(stderr, "Cannot set up replay directory: %s\n", strerror(errno));
+        free(samples);
+        return 1;
+    }
+    snprintf(stream_path, sizeof(stream_path), "%s/uevents", dir);
+
+    log_start_writer();
+    device_monitor_set_input_dir(dir);
+
+    // Generated presses never chatter, and every device presses the same
+    // key at once; the filter would only drop what is being measured
+    event_filter_set_config(&(event_filter_config_t){ 0, 0 });
+    hotplug_monitor_set_stream(stream_path);
+
+    if (mkfifo(stream_path, 0600) < 0 || event_loop_init() < 0 ||
+        (config.io_uring && uring_reader_init() < 0) || device_monitor_init() < 0 ||
+        hotplug_monitor_init(HOTPLUG_BACKEND_STREAM) < 0 || hotplug_monitor_start() < 0) {
+        fprintf(stderr, "Cannot start the event loop on %s\n", dir);
+        goto out;
+    }
+
+    for (int i = 0; i < config.subscribers; i++) {
+        char name[16];
+
+        snprintf(name, sizeof(name), "subscriber%d", i);
+        subscribers[i] = button_bus_subscribe(name, BUTTON_BUS_THREAD, 0, subscriber_event, NULL);
+    }
+
+    // The generator is started from the loop thread but runs normally
+    if (config.realtime && realtime_enter(&config.rt) < 0) {
+        fprintf(stderr, "Real-time mode only partly applied\n");
+    }
+
+    started = now_ns();
+
+    if (pthread_create(&generator, NULL, generator_thread, NULL) != 0) {
+        fprintf(stderr, "Cannot start generator thread\n");
+        goto out;
+    }
+
+    // Counted from here; with memory locked the generator's stack is
+    // populated by pthread_create() on this thread
+    getrusage(RUSAGE_THREAD, &ru_start);
+
+    event_loop_run();
+    pthread_join(generator, NULL);
+
+    getrusage(RUSAGE_THREAD, &ru_stop);
+    report(now_ns() - started, &ru_start, &ru_stop);
+    ret = idle_wakeups == 0 ? 0 : 1;
+
+out:
+    for (int i = 0; i < config.subscribers; i++) {
+        button_bus_unsubscribe(subscribers[i]);
+    }
+    hotplug_monitor_stop();
+    device_monitor_cleanup();
+    uring_reader_cleanup();
+    event_loop_cleanup();
+    log_stop_writer();
+    unlink(stream_path);
+    rmdir(dir);
+    free(samples);
+    return ret;
+}